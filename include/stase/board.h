@@ -6,6 +6,8 @@
 
 #include "../../src/board/base_types.h"
 #include "../../src/board/square.h"
+#include "../../src/board/bitboard.h"
+#include "../../src/board/zobrist.h"
 #include "../../src/board/move.h"
 #include "../../src/utils/ptr_vec.h"
 
@@ -52,6 +54,17 @@ inline std::string starting_fen() {
     return "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
 }
 
+/**
+ * No position has more legal moves than this (the record is 218), so a buffer of this size can
+ * always hold them all.
+ */
+const int MAX_LEGAL_MOVES = 256;
+
+/**
+ * The longest FEN board_utils::write_fen can produce, including the terminating null.
+ */
+const int MAX_FEN_LENGTH = 128;
+
 /**
  * Legal moves. These functions provide all legal moves, those only for a certain piece
  * as well as checking whether you're in check or not.
@@ -64,12 +77,28 @@ namespace game_rules {
     /** @return true if the player of the given colour is in check */
     bool in_check(const Board &, Colour);
 
+    /** @return true if the king of the given colour, known to be on the given square, is in check */
+    bool in_check(const Board &, Colour, Square king);
+
+    /**
+     * @return the pieces of the given colour which attack the given square. The occupancy used
+     * to block sliding pieces may be given, for example to look through a piece about to move.
+     */
+    Bitboard attackers(const Board &, Square, Colour by);
+    Bitboard attackers(const Board &, Square, Colour by, Bitboard occ);
+
     /**
      * Fill the given ptr_vec with the moves which could be made by the piece on the given square,
      * disregarding whether or not they would be moving into check.
      */
     void piecemoves_ignore_check(const Board &, Square, ptr_vec<Move> &);
 
+    /**
+     * Fill the given ptr_vec with all legal moves available in the given position. It must have
+     * room for MAX_LEGAL_MOVES. Nothing is allocated, so this is the one to use in hot code.
+     */
+    void legal_moves(const Board &, ptr_vec<Move> &);
+
     /**
      * Fill the given vector with all legal moves available in the given position.
      */
@@ -80,6 +109,12 @@ namespace game_rules {
      */
     std::vector<Move> legal_moves(const Board &);
 
+    /**
+     * @return true if the player to move has at least one legal move. This stops at the first
+     * one it finds, so is much cheaper than generating them all just to check for mate.
+     */
+    bool has_any_legal_move(const Board &);
+
     /**
      * @return the GameStatus implied by the current position. This is not able to account for
      * threefold repetition.
@@ -94,12 +129,58 @@ namespace game_rules {
     GameStatus check_status(const std::vector<std::string> & fens);
 }
 
+/**
+ * The history of a game, kept as the Zobrist key and halfmove clock of each position reached, so
+ * that it can be extended move by move. A position can only repeat one reached since the last
+ * capture or pawn move, so repetitions are only looked for that far back.
+ */
+class GameRecord {
+
+public:
+    explicit GameRecord(const Board & start);
+
+    /**
+     * Records the position reached by the latest move.
+     */
+    void push(const Board &);
+
+    /**
+     * Forgets the latest position. The starting position is never forgotten.
+     */
+    void pop();
+
+    /**
+     * @return the number of times the latest position has been reached, including this one.
+     */
+    int repetitions() const;
+
+    /**
+     * @return the GameStatus of the latest position, which must be the given board.
+     */
+    GameStatus status(const Board &) const;
+
+    inline int size() const { return (int) entries.size(); }
+
+private:
+    struct Entry {
+        ZobristKey key;
+        unsigned halfmoves;
+    };
+    std::vector<Entry> entries;
+};
+
 /**
  * Reading and writing helpers: into and out of FEN and displaying usefully.
  */
 namespace board_utils {
     Board fen_to_board(const std::string_view & fen);
     std::string board_to_fen(const Board &);
+
+    /**
+     * Writes the board's FEN, null-terminated, into the given buffer, which must have room for
+     * MAX_FEN_LENGTH chars. Nothing is allocated. @return the length of the FEN
+     */
+    size_t write_fen(const Board &, char * buf);
     void write_conf(const Board &, std::ostream &);
     void print(const Board &);
     void print_conf(const Board &);
@@ -1,6 +1,7 @@
 #ifndef STASE_GAME_H
 #define STASE_GAME_H
 
+#include <memory_resource>
 #include <string>
 #include "board.h"
 #include "../../src/game/eval.hpp"
@@ -37,17 +38,21 @@ inline std::string name(CandList cand_list) {
     }
 }
 
+/**
+ * The candidate moves for a position, by list. The lists take their memory from the given
+ * resource, so that a search can keep them in its arena along with the rest of the tree.
+ */
 struct CandSet {
-    std::vector<Move> critical;
-    std::vector<Move> medial;
-    std::vector<Move> final;
-    std::vector<Move> legal;
+    std::pmr::vector<Move> critical;
+    std::pmr::vector<Move> medial;
+    std::pmr::vector<Move> final;
+    std::pmr::vector<Move> legal;
 
-    CandSet() :
-            critical(std::vector<Move>()),
-            medial(std::vector<Move>()),
-            final(std::vector<Move>()),
-            legal(std::vector<Move>())
+    explicit CandSet(std::pmr::memory_resource * mem = std::pmr::get_default_resource()) :
+            critical(mem),
+            medial(mem),
+            final(mem),
+            legal(mem)
     {}
 
     inline bool empty() const { return critical.empty() && medial.empty() && final.empty() && legal.empty(); }
@@ -58,7 +63,7 @@ struct CandSet {
         return (int) (critical.size() + medial.size() + final.size());
     }
 
-    inline std::vector<Move> & get_list(CandList cand_list) {
+    inline std::pmr::vector<Move> & get_list(CandList cand_list) {
         switch (cand_list) {
             case CRITICAL: return critical;
             case MEDIAL: return medial;
@@ -81,7 +86,7 @@ struct CandSet {
      * Sorts the specified list by order of decreasing score.
      */
     inline void order_list(CandList cand_list) {
-        std::vector<Move> & list = get_list(cand_list);
+        std::pmr::vector<Move> & list = get_list(cand_list);
         for (int i = 0; i < list.size(); ++i) {
             for (int j = 0; j < i; ++j) {
                 if (list[i].get_score() > list[j].get_score()) {
@@ -419,6 +424,7 @@ const MetricWeights DEFAULT_METRIC_WEIGHTS(
 
 CandSet * cands(Gamestate &, CandSet *);
 Eval heur(const Gamestate &, const MetricWeights * = &DEFAULT_METRIC_WEIGHTS);
+Eval static_estimate(const Board &, Move);
 float quiess(Gamestate &);
 
 void print_cand_set(const Gamestate &, const CandSet &, std::ostream &);
@@ -4,63 +4,151 @@
 #include "board.h"
 #include "game.h"
 
+#include <atomic>
+#include <memory_resource>
+
+struct SearchNode;
+struct SearchContext;
+
+/**
+ * One of the further parents of a node reached by transposition, with the move from it to the node. They
+ * form a list, allocated from the same memory as the node.
+ */
+struct ParentLink {
+    SearchNode * parent;
+    Move move;
+    ParentLink * next;
+};
+
+/**
+ * A field which one thread may write, under a lock, while other threads read it without one. Loads
+ * and stores are atomic but relaxed: a reader sees the value as it was at some recent moment, with no
+ * ordering against any other field.
+ */
+template <typename T>
+class Relaxed {
+    std::atomic<T> value;
+
+public:
+    Relaxed(const T v) : value(v) {}
+
+    Relaxed & operator=(const T v) {
+        value.store(v, std::memory_order_relaxed);
+        return *this;
+    }
+
+    Relaxed & operator=(const Relaxed & o) { return *this = (T) o; }
+
+    Relaxed & operator++() {
+        value.fetch_add(1, std::memory_order_relaxed);
+        return *this;
+    }
+
+    operator T() const { return value.load(std::memory_order_relaxed); }
+};
+
+/**
+ * A node in the search tree. Its list of children takes its memory from the given resource,
+ * which new children are allocated from too: see new_children. The children created together
+ * sit side by side in one block, with their gamestates and candidates held out of line.
+ *
+ * A node may be lazy: just a move and an estimated score, with no gamestate or candidates until
+ * the search first goes into it (see materialise).
+ *
+ * A node may also have more than one parent, when its position is reached by transposition (see
+ * TranspositionTable). Its parent and move are those of the path it was created on; the others
+ * are kept in other_parents, and edge_move gives the move from any of them.
+ *
+ * Several threads may search one tree (see greedy_search). A thread holds a node's lock while it
+ * changes the node's children, candidates or scores, and counts itself in in_flight while it is
+ * on a line through the node. The hot fields of a node's children are read without their locks,
+ * so they are Relaxed, and a scan over them may see a score or visit count a moment out of date.
+ */
 struct SearchNode {
 
+    // read for every child whenever a node's children are scanned, so they come first
+    Relaxed<Eval> score;
+    Move move;
+    Relaxed<unsigned short> visit_count;
+    Relaxed<bool> terminal;
+    std::atomic_flag busy;
+    std::atomic<unsigned short> in_flight;
+    unsigned visit_cycle;
+
     Gamestate * gs;
     CandSet * cand_set;
-    Eval score;
-    Move move;
-    bool terminal;
-    long board_hash;
-    const SearchNode * parent;
-    std::vector<SearchNode*> children;
+    ZobristKey board_hash;
+    SearchNode * parent;
+    ParentLink * other_parents;
+    std::pmr::vector<SearchNode*> children;
     SearchNode * best_child;
     SearchNode * best_trust_child;
-    unsigned short visit_count;
 
-    SearchNode(Gamestate * gs, CandSet * cand_set) :
-        gs(gs),
-        cand_set(cand_set),
+    SearchNode(
+            Gamestate * gs,
+            CandSet * cand_set,
+            std::pmr::memory_resource * mem = std::pmr::get_default_resource()) :
         score(zero()),
         move(MOVE_SENTINEL),
+        visit_count(0),
         terminal(false),
+        in_flight(0),
+        visit_cycle(0),
+        gs(gs),
+        cand_set(cand_set),
         board_hash(hash()),
         parent(nullptr),
-        children(),
+        other_parents(nullptr),
+        children(mem),
         best_child(nullptr),
-        best_trust_child(nullptr),
-        visit_count(0)
+        best_trust_child(nullptr)
     {}
 
-    SearchNode(Gamestate * gs, CandSet * cand_set, Move m) :
-        gs(gs),
-        cand_set(cand_set),
+    SearchNode(
+            Gamestate * gs,
+            CandSet * cand_set,
+            Move m,
+            std::pmr::memory_resource * mem = std::pmr::get_default_resource()) :
         score(zero()),
         move(m),
+        visit_count(0),
         terminal(false),
+        in_flight(0),
+        visit_cycle(0),
+        gs(gs),
+        cand_set(cand_set),
         board_hash(hash()),
         parent(nullptr),
-        children(),
+        other_parents(nullptr),
+        children(mem),
         best_child(nullptr),
-        best_trust_child(nullptr),
-        visit_count(0)
+        best_trust_child(nullptr)
     {}
 
-    SearchNode(Gamestate * gs, CandSet * cand_set, Eval e) :
-        gs(gs),
-        cand_set(cand_set),
+    SearchNode(
+            Gamestate * gs,
+            CandSet * cand_set,
+            Eval e,
+            std::pmr::memory_resource * mem = std::pmr::get_default_resource()) :
         score(e),
         move(MOVE_SENTINEL),
+        visit_count(0),
         terminal(false),
+        in_flight(0),
+        visit_cycle(0),
+        gs(gs),
+        cand_set(cand_set),
         board_hash(hash()),
         parent(nullptr),
-        children(),
+        other_parents(nullptr),
+        children(mem),
         best_child(nullptr),
-        best_trust_child(nullptr),
-        visit_count(0)
+        best_trust_child(nullptr)
     {}
 
-private: long hash();
+    inline bool is_lazy() const { return gs == nullptr; }
+
+private: ZobristKey hash();
 };
 
 enum SearchEvent {
@@ -127,13 +215,13 @@ public:
 extern Observer DEFAULT_OBSERVER;
 
 std::vector<Move> greedy_search(
-        SearchNode *, int,
+        SearchNode *, SearchContext &, int,
         const std::vector<Gamestate> *,
         const MetricWeights * = &DEFAULT_METRIC_WEIGHTS,
-        Observer & = DEFAULT_OBSERVER);
-
-void delete_tree(SearchNode *);
+        Observer & = DEFAULT_OBSERVER,
+        int threads = 1);
 
+Move edge_move(const SearchNode * parent, const SearchNode * child);
 int subtree_size(SearchNode *);
 int subtree_depth(SearchNode *);
 void write_to_file(SearchNode *, std::ostream &);
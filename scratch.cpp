@@ -423,14 +423,19 @@ SearchNode * repl_cycles(const std::string & fen, const GamePhase game_phase) {
     SearchNode * root =
         new SearchNode(root_gs, cands(*root_gs, new CandSet), heur(*root_gs));
 
-    greedy_search(root, cycles, nullptr);
+    SearchContext ctx;
+    greedy_search(root, ctx, cycles, nullptr);
     cout << "done\n";
 
     return root;
 
 }
 
-SearchNode * repl_seconds(const std::string & fen, const GamePhase game_phase) {
+/**
+ * Analyses for a number of seconds with a new engine, put in the given pointer. The caller must keep the
+ * engine for as long as it uses the tree returned, since the tree lives in the engine's arena.
+ */
+SearchNode * repl_seconds(const std::string & fen, const GamePhase game_phase, std::unique_ptr<Engine> & engine) {
 
     std::string input;
 
@@ -441,20 +446,22 @@ SearchNode * repl_seconds(const std::string & fen, const GamePhase game_phase) {
     cout << "\nAnalysing...";
     cout.flush();
 
-    Engine engine =
+    engine =
         EngineBuilder::for_position(fen)
             .with_timeout(secs)
-            .with_cleanup(false)
             .with_game_phase(game_phase)
-            .build();
-    engine.blocking_run();
+            .build_unique();
+    engine->blocking_run();
 
     cout << "done\n";
 
-    return engine.get_root();
+    return engine->get_root();
 }
 
-SearchNode * repl_nodes(const std::string & fen, const GamePhase game_phase) {
+/**
+ * As repl_seconds, but for a number of nodes.
+ */
+SearchNode * repl_nodes(const std::string & fen, const GamePhase game_phase, std::unique_ptr<Engine> & engine) {
     std::string input;
 
     cout << "Enter number of nodes to analyse for: ";
@@ -464,16 +471,15 @@ SearchNode * repl_nodes(const std::string & fen, const GamePhase game_phase) {
     cout << "\nAnalysing...";
     cout.flush();
 
-    Engine engine =
+    engine =
         EngineBuilder::for_position(fen)
             .with_node_limit(n)
-            .with_cleanup(false)
             .with_game_phase(game_phase)
-            .build();
-    engine.blocking_run();
+            .build_unique();
+    engine->blocking_run();
     cout << "done\n";
 
-    return engine.get_root();
+    return engine->get_root();
 }
 
 void repl(const std::string & fen, const GamePhase game_phase) {
@@ -483,14 +489,15 @@ void repl(const std::string & fen, const GamePhase game_phase) {
     cout << "Run engine for cycles/seconds/nodes (c/s/n)? ";
     std::cin >> input;
 
+    std::unique_ptr<Engine> engine;
     SearchNode * root = nullptr;
     while (root == nullptr) {
         if (input == "s") {
-            root = repl_seconds(fen, game_phase);
+            root = repl_seconds(fen, game_phase, engine);
         } else if (input == "c") {
             root = repl_cycles(fen, game_phase);
         } else if (input == "n") {
-            root = repl_nodes(fen, game_phase);
+            root = repl_nodes(fen, game_phase, engine);
         } else {
             cout << "unknown unit\n";
         }
@@ -610,7 +617,6 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv) {
             .with_game_phase(game_phase)
 //            .with_timeout(5)
             .with_node_limit(25000)
-            .with_cleanup(false)
 //            .with_obs(observer)
             .build();
 
@@ -0,0 +1,22 @@
+#ifndef STASE_BENCH_H
+#define STASE_BENCH_H
+
+#include "../../include/stase/board.h"
+#include "perft.h"
+
+/*
+ * Benchmarks, one entry point per module. These print their timings rather than passing or
+ * failing, but will shout if they notice something has gone wrong along the way.
+ */
+
+void bench_board();
+void bench_game();
+void bench_search();
+
+/**
+ * The boards to time single-position functions on: the puzzle set if it is available, and
+ * otherwise every position within two plies of the perft reference positions.
+ */
+std::vector<Board> bench_boards();
+
+#endif //STASE_BENCH_H
@@ -0,0 +1,36 @@
+#include <iostream>
+using std::cout;
+#include <cstring>
+using std::strcmp;
+
+#include "bench.h"
+
+int main(int argc, char** argv) {
+
+    unsigned modules_benched = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-b") == 0 || strcmp(argv[i], "-board") == 0) {
+            cout << "\nBenchmarking board\n";
+            bench_board();
+            ++modules_benched;
+        } else if (strcmp(argv[i], "-g") == 0 || strcmp(argv[i], "-game") == 0) {
+            cout << "\nBenchmarking game\n";
+            bench_game();
+            ++modules_benched;
+        } else if (strcmp(argv[i], "-s") == 0 || strcmp(argv[i], "-search") == 0) {
+            cout << "\nBenchmarking search\n";
+            bench_search();
+            ++modules_benched;
+        } else {
+            cout << "Unrecognised argument: " + std::string(argv[i]) + "\n";
+        }
+    }
+
+    if (modules_benched == 0) {
+        cout << "No benchmarks requested\n";
+    }
+    cout << "\nGoodbye\n";
+
+    return 0;
+}
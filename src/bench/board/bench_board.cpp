@@ -0,0 +1,192 @@
+#include <chrono>
+#include <iostream>
+
+#include "../bench.h"
+#include "../../board/board.hpp"
+#include "../../../include/stase/puzzle.h"
+#include "../../utils/utils.h"
+
+/**
+ * Move generation throughput: perft on the reference positions, single threaded and without
+ * hashing so that every node is really generated.
+ */
+void bench_movegen() {
+    std::cout << "\nPerft, reference positions up to 5M nodes\n\n";
+    if (!perft::check_reference_positions(5000000)) {
+        std::cout << "\n*****PERFT COUNTS WRONG*****\n";
+    }
+}
+
+std::vector<Board> bench_boards() {
+
+    std::vector<Board> boards;
+    puzzle_boards(boards);
+    if (!boards.empty()) { return boards; }
+
+    for (const perft::ReferencePosition & pos : perft::REFERENCE_POSITIONS) {
+        const Board b = board_utils::fen_to_board(pos.fen);
+        boards.push_back(b);
+        for (const Move m : game_rules::legal_moves(b)) {
+            const Board succ = b.successor_hard(m);
+            boards.push_back(succ);
+            for (const Move m2 : game_rules::legal_moves(succ)) {
+                boards.push_back(succ.successor_hard(m2));
+            }
+        }
+    }
+    return boards;
+}
+
+/**
+ * Check detection as it was before the board knew where its kings were: scan the squares for
+ * the king, then look for attackers.
+ */
+bool in_check_by_scan(const Board & b, const Colour c) {
+    const Piece king = mkpiece(c, KING);
+    for (int x = 0; x < 8; ++x) {
+        for (int y = 0; y < 8; ++y) {
+            if (b.get(x, y) == king) {
+                return game_rules::attackers(b, mksq(x, y), opposite_colour(c)) != EMPTY_BB;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * Times check detection for both sides of every board, with the king found by scanning and
+ * with it read straight off the king bitboard.
+ */
+void bench_in_check() {
+
+    const std::vector<Board> boards = bench_boards();
+    const int REPEATS = 20;
+    const double calls = 2.0 * REPEATS * boards.size();
+
+    std::cout << "\nCheck detection, " << boards.size() << " boards\n\n";
+
+    unsigned scan_checks = 0, fast_checks = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < REPEATS; ++i) {
+        for (const Board & b : boards) {
+            scan_checks += in_check_by_scan(b, WHITE) + in_check_by_scan(b, BLACK);
+        }
+    }
+    const double scan_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < REPEATS; ++i) {
+        for (const Board & b : boards) {
+            fast_checks += game_rules::in_check(b, WHITE) + game_rules::in_check(b, BLACK);
+        }
+    }
+    const double fast_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Scanning for the king:   " << dp_2(scan_ns / calls) << " ns per call\n";
+    std::cout << "King square from board:  " << dp_2(fast_ns / calls) << " ns per call\n";
+
+    if (scan_checks != fast_checks) {
+        std::cout << "\n*****CHECK COUNTS DIFFER*****\n";
+    }
+}
+
+/**
+ * FEN throughput, reading and writing: the puzzle FENs if they are available, and otherwise the
+ * FENs of the boards used above.
+ */
+void bench_fens() {
+
+    std::vector<std::string> fens;
+    read_all_fens(fens);
+    if (fens.empty()) {
+        for (const Board & b : bench_boards()) {
+            fens.push_back(board_utils::board_to_fen(b));
+        }
+    }
+
+    size_t bytes = 0;
+    for (const std::string & fen : fens) {
+        bytes += fen.size();
+    }
+
+    std::cout << "\nFEN reading and writing, " << fens.size() << " FENs\n\n";
+
+    std::vector<Board> boards;
+    boards.reserve(fens.size());
+
+    auto start = std::chrono::steady_clock::now();
+    for (const std::string & fen : fens) {
+        boards.push_back(board_utils::fen_to_board(fen));
+    }
+    const double read_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    char buf[MAX_FEN_LENGTH];
+    size_t written = 0;
+
+    start = std::chrono::steady_clock::now();
+    for (const Board & b : boards) {
+        written += board_utils::write_fen(b, buf);
+    }
+    const double write_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Reading:  " << dp_2(1e9 * read_s / fens.size()) << " ns per FEN, "
+              << dp_2(bytes / read_s / 1e6) << " MB/s\n";
+    std::cout << "Writing:  " << dp_2(1e9 * write_s / boards.size()) << " ns per FEN, "
+              << dp_2(written / write_s / 1e6) << " MB/s\n";
+
+    if (written != bytes) {
+        std::cout << "\n*****FENS CHANGED ON THE ROUND TRIP*****\n";
+    }
+}
+
+/**
+ * SAN formatting throughput, for every legal move of the boards used above: one at a time, and
+ * batched per position.
+ */
+void bench_san() {
+
+    const std::vector<Board> boards = bench_boards();
+    std::vector<std::vector<Move>> moves;
+    size_t n = 0;
+    for (const Board & b : boards) {
+        moves.push_back(game_rules::legal_moves(b));
+        n += moves.back().size();
+    }
+
+    std::cout << "\nSAN formatting, " << n << " moves\n\n";
+
+    size_t chars = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < (int) boards.size(); ++i) {
+        for (const Move m : moves[i]) {
+            chars += mtos(boards[i], m).size();
+        }
+    }
+    const double single_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<std::string> sans;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < (int) boards.size(); ++i) {
+        sans.clear();
+        mtos(boards[i], moves[i], sans);
+        for (const std::string & san : sans) {
+            chars -= san.size();
+        }
+    }
+    const double batch_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "One at a time:  " << dp_2(1e9 * single_s / n) << " ns per move\n";
+    std::cout << "Batched:        " << dp_2(1e9 * batch_s / n) << " ns per move\n";
+
+    if (chars != 0) {
+        std::cout << "\n*****BATCHED SAN DIFFERS*****\n";
+    }
+}
+
+void bench_board() {
+    bench_movegen();
+    bench_in_check();
+    bench_fens();
+    bench_san();
+}
@@ -0,0 +1,195 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+#include "../perft.h"
+#include "../../board/board.hpp"
+#include "../../utils/utils.h"
+
+using std::cout;
+
+const std::vector<perft::ReferencePosition> perft::REFERENCE_POSITIONS{
+    {
+        "start",
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        {20, 400, 8902, 197281, 4865609, 119060324}
+    },
+    {
+        "kiwipete",
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        {48, 2039, 97862, 4085603, 193690690}
+    },
+    {
+        "position 3",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        {14, 191, 2812, 43238, 674624, 11030083, 178633661}
+    },
+    {
+        "position 4",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        {6, 264, 9467, 422333, 15833292, 706045033}
+    },
+    {
+        "position 5",
+        "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+        {44, 1486, 62379, 2103487, 89941194}
+    },
+    {
+        "position 6",
+        "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+        {46, 2079, 89890, 3894594, 164075551}
+    },
+};
+
+/*************************************************************************
+ *  Hash table
+ ************************************************************************/
+
+perft::HashTable::HashTable(const size_t megabytes) {
+
+    // round down to a power of two, so the index is just the low bits of the key
+    uint64_t n = 1;
+    while (n * 2 * sizeof(Entry) <= megabytes * 1024 * 1024) {
+        n *= 2;
+    }
+
+    entries = std::unique_ptr<Entry[]>(new Entry[n]());
+    mask = n - 1;
+}
+
+bool perft::HashTable::probe(const ZobristKey key, const int depth, uint64_t & nodes) const {
+
+    const Entry & e = entries[key & mask];
+    const uint64_t data = e.data.load(std::memory_order_relaxed);
+    const uint64_t check = e.check.load(std::memory_order_relaxed);
+
+    // the low byte holds the depth, the rest the count
+    if ((check ^ data) != key || (int) (data & 0xFF) != depth) {
+        return false;
+    }
+    nodes = data >> 8;
+    return true;
+}
+
+void perft::HashTable::store(const ZobristKey key, const int depth, const uint64_t nodes) {
+    Entry & e = entries[key & mask];
+    const uint64_t data = (nodes << 8) | (uint64_t) depth;
+    e.check.store(key ^ data, std::memory_order_relaxed);
+    e.data.store(data, std::memory_order_relaxed);
+}
+
+/*************************************************************************
+ *  Counting
+ ************************************************************************/
+
+/**
+ * Counts in place, making and unmaking each move on the one board.
+ */
+uint64_t count_in_place(Board & b, const int depth, perft::HashTable * tt) {
+
+    if (depth == 0) { return 1; }
+
+    Move moves_arr[MAX_LEGAL_MOVES];
+    ptr_vec<Move> moves(moves_arr, MAX_LEGAL_MOVES);
+    game_rules::legal_moves(b, moves);
+
+    // bulk counting: the moves at the last ply need not be made
+    if (depth == 1) { return moves.size(); }
+
+    uint64_t nodes = 0;
+    if (tt && tt->probe(b.get_key(), depth, nodes)) {
+        return nodes;
+    }
+
+    BoardUndo undo;
+    for (int i = 0; i < moves.size(); ++i) {
+        b.make_move(moves[i], undo);
+        nodes += count_in_place(b, depth - 1, tt);
+        b.unmake_move(moves[i], undo);
+    }
+
+    if (tt) {
+        tt->store(b.get_key(), depth, nodes);
+    }
+    return nodes;
+}
+
+uint64_t perft::count(const Board & b, const int depth, HashTable * tt) {
+    Board local = b;
+    return count_in_place(local, depth, tt);
+}
+
+perft::Result perft::run(const Board & b, const int depth, const int threads, HashTable * tt) {
+
+    const auto start = std::chrono::steady_clock::now();
+    Result result;
+
+    for (const Move m : game_rules::legal_moves(b)) {
+        result.divide.push_back(DivideEntry{m, 0});
+    }
+
+    // each thread takes the next root move which nobody has started yet
+    std::atomic<size_t> next{0};
+    auto work = [&]() {
+        for (size_t i = next++; i < result.divide.size(); i = next++) {
+            DivideEntry & entry = result.divide[i];
+            entry.nodes = (depth <= 1) ? 1 : perft::count(b.successor_hard(entry.move), depth - 1, tt);
+        }
+    };
+
+    if (depth > 0) {
+        std::vector<std::thread> workers;
+        for (int i = 1; i < threads; ++i) {
+            workers.emplace_back(work);
+        }
+        work();
+        for (std::thread & t : workers) {
+            t.join();
+        }
+    }
+
+    result.nodes = (depth == 0) ? 1 : 0;
+    for (const DivideEntry & entry : result.divide) {
+        result.nodes += entry.nodes;
+    }
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+bool perft::check_reference_positions(const uint64_t max_nodes, const int threads, HashTable * tt) {
+
+    bool passed = true;
+    uint64_t total_nodes = 0;
+    double total_seconds = 0;
+
+    for (const ReferencePosition & pos : REFERENCE_POSITIONS) {
+
+        const Board b = board_utils::fen_to_board(pos.fen);
+
+        for (int depth = 1; depth <= (int) pos.counts.size(); ++depth) {
+
+            const uint64_t expected = pos.counts[depth - 1];
+            if (expected > max_nodes) { break; }
+
+            const Result result = perft::run(b, depth, threads, tt);
+            const bool ok = result.nodes == expected;
+            passed = passed && ok;
+            total_nodes += result.nodes;
+            total_seconds += result.seconds;
+
+            cout << std::left << std::setw(12) << pos.name
+                 << " depth " << depth << ": "
+                 << std::right << std::setw(10) << result.nodes
+                 << (ok ? "" : " (expected " + std::to_string(expected) + ")")
+                 << "   " << dp_2(result.nps() / 1e6) << " Mnps\n";
+        }
+    }
+
+    const double nps = total_seconds > 0 ? total_nodes / total_seconds : 0;
+    cout << "\nTotal: " << total_nodes << " nodes in " << dp_2(total_seconds) << "s, "
+         << dp_2(nps / 1e6) << " Mnps\n";
+
+    return passed;
+}
@@ -0,0 +1,46 @@
+#include <chrono>
+#include <iostream>
+
+#include "../bench.h"
+#include "../../game/gamestate.hpp"
+#include "../../utils/utils.h"
+
+/**
+ * Gamestate construction throughput: every child of every board used by the board benchmarks,
+ * built the way the search builds them, on the heap from their parent.
+ */
+void bench_gamestates() {
+
+    const std::vector<Board> boards = bench_boards();
+    std::vector<std::vector<Move>> moves;
+    size_t n = 0;
+    for (const Board & b : boards) {
+        moves.push_back(game_rules::legal_moves(b));
+        n += moves.back().size();
+    }
+
+    std::cout << "\nGamestate construction, " << boards.size() << " parents and " << n << " children\n\n";
+
+    unsigned checks = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < (int) boards.size(); ++i) {
+        const Gamestate parent(boards[i]);
+        for (const Move m : moves[i]) {
+            const Gamestate * child = new Gamestate(parent, m);
+            checks += child->in_check;
+            delete child;
+        }
+    }
+    const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Children:  " << dp_2(1e9 * secs / n) << " ns each, "
+              << dp_2(n / secs / 1e6) << "M per second\n";
+
+    if (checks != 0) {
+        std::cout << "\n*****NEW GAMESTATE THINKS IT IS IN CHECK*****\n";
+    }
+}
+
+void bench_game() {
+    bench_gamestates();
+}
@@ -0,0 +1,88 @@
+#ifndef STASE_PERFT_H
+#define STASE_PERFT_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../../include/stase/board.h"
+
+/*
+ * Perft: count the leaf nodes of the full legal move tree to a given depth. The counts for a
+ * handful of well-known positions are published, and between them they exercise every awkward
+ * rule (castling through check, en-passant pins, promotions with capture), so a generator which
+ * matches them all is almost certainly right. Timing the count gives the raw speed of move
+ * generation, with no search or evaluation getting in the way.
+ *
+ * Moves are made and unmade in place with Board::make_move, and generated with
+ * game_rules::legal_moves.
+ */
+namespace perft {
+
+    /**
+     * A shared cache of subtree counts, indexed by Zobrist key. Each slot holds the count and
+     * depth together with a check word (key ^ data), so that threads can read and write it
+     * without locking: a slot torn by two simultaneous writes fails the check and is ignored.
+     */
+    class HashTable {
+
+    public:
+        explicit HashTable(size_t megabytes);
+
+        bool probe(ZobristKey, int depth, uint64_t & nodes) const;
+        void store(ZobristKey, int depth, uint64_t nodes);
+
+    private:
+        struct Entry {
+            std::atomic<uint64_t> check;
+            std::atomic<uint64_t> data;
+        };
+
+        std::unique_ptr<Entry[]> entries;
+        uint64_t mask;
+    };
+
+    struct DivideEntry {
+        Move move;
+        uint64_t nodes;
+    };
+
+    struct Result {
+        uint64_t nodes = 0;
+        double seconds = 0;
+        std::vector<DivideEntry> divide;
+
+        inline double nps() const { return seconds > 0 ? nodes / seconds : 0; }
+    };
+
+    /**
+     * @return the number of leaf nodes at the given depth below the position
+     */
+    uint64_t count(const Board &, int depth, HashTable * = nullptr);
+
+    /**
+     * Counts the nodes below each root move separately, sharing the root moves out between the
+     * given number of threads. The divide is given in the order the moves were generated.
+     */
+    Result run(const Board &, int depth, int threads = 1, HashTable * = nullptr);
+
+    struct ReferencePosition {
+        const std::string name;
+        const std::string fen;
+        // the expected count at depth 1, 2, ...
+        const std::vector<uint64_t> counts;
+    };
+
+    extern const std::vector<ReferencePosition> REFERENCE_POSITIONS;
+
+    /**
+     * Runs each reference position at every depth whose expected count is no more than the
+     * given limit, printing the counts and speeds as it goes.
+     * @return true if every count was as expected
+     */
+    bool check_reference_positions(uint64_t max_nodes, int threads = 1, HashTable * = nullptr);
+}
+
+#endif //STASE_PERFT_H
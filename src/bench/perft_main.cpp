@@ -0,0 +1,76 @@
+#include <iostream>
+using std::cout;
+#include <cstring>
+using std::strcmp;
+#include <string>
+
+#include "perft.h"
+#include "../board/board.hpp"
+#include "../utils/utils.h"
+
+const std::string usage =
+        "Usage: perft [options]\n"
+        "  -fen <fen>       position to count from (default: the starting position)\n"
+        "  -depth <n>       depth to count to (default: 5)\n"
+        "  -divide          print the count below each root move\n"
+        "  -threads <n>     share the root moves between n threads (default: 1)\n"
+        "  -hash <mb>       cache subtree counts in a table of this size (default: none)\n"
+        "  -check [nodes]   check the reference positions, up to the given count (default: 10000000)\n";
+
+int main(int argc, char** argv) {
+
+    std::string fen = starting_fen();
+    int depth = 5;
+    bool divide = false;
+    int threads = 1;
+    size_t hash_mb = 0;
+    bool check = false;
+    uint64_t check_nodes = 10000000;
+
+    for (int i = 1; i < argc; ++i) {
+        bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "-fen") == 0 && has_value) {
+            fen = argv[++i];
+        } else if (strcmp(argv[i], "-depth") == 0 && has_value) {
+            depth = std::stoi(argv[++i]);
+        } else if (strcmp(argv[i], "-divide") == 0) {
+            divide = true;
+        } else if (strcmp(argv[i], "-threads") == 0 && has_value) {
+            threads = std::stoi(argv[++i]);
+        } else if (strcmp(argv[i], "-hash") == 0 && has_value) {
+            hash_mb = std::stoul(argv[++i]);
+        } else if (strcmp(argv[i], "-check") == 0) {
+            check = true;
+            if (has_value && argv[i + 1][0] != '-') {
+                check_nodes = std::stoull(argv[++i]);
+            }
+        } else {
+            cout << "Unrecognised argument: " + std::string(argv[i]) + "\n" << usage;
+            return 1;
+        }
+    }
+
+    std::unique_ptr<perft::HashTable> tt = hash_mb ? std::make_unique<perft::HashTable>(hash_mb) : nullptr;
+
+    if (check) {
+        bool passed = perft::check_reference_positions(check_nodes, threads, tt.get());
+        cout << (passed ? "\nAll counts correct\n" : "\n*****SOME COUNTS WRONG*****\n");
+        return passed ? 0 : 1;
+    }
+
+    const Board b = board_utils::fen_to_board(fen);
+    const perft::Result result = perft::run(b, depth, threads, tt.get());
+
+    if (divide) {
+        for (const perft::DivideEntry & entry : result.divide) {
+            cout << move2uci(entry.move) << ": " << entry.nodes << "\n";
+        }
+        cout << "\n";
+    }
+
+    cout << "Nodes: " << result.nodes << "\n"
+         << "Time:  " << dp_2(result.seconds) << "s\n"
+         << "NPS:   " << (uint64_t) result.nps() << "\n";
+
+    return 0;
+}
@@ -0,0 +1,197 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+#include "../bench.h"
+#include "../perft.h"
+#include "../../search/engine.h"
+#include "../../search/search_tools.h"
+#include "../../utils/utils.h"
+
+/**
+ * Search throughput: the engine on each of the perft reference positions up to a fixed number of
+ * nodes, reporting nodes (gamestates created and evaluated) per second. The tree is kept until the
+ * search has been timed, so that it can be counted, and the time taken to free it is reported
+ * separately.
+ */
+void bench_nps() {
+
+    const int NODES = 100000;
+    std::cout << "\nSearch, reference positions up to " << NODES << " nodes\n\n";
+
+    long total_nodes = 0;
+    double total_secs = 0;
+    double total_free_secs = 0;
+
+    for (const perft::ReferencePosition & pos : perft::REFERENCE_POSITIONS) {
+        Engine engine =
+            EngineBuilder::for_position(pos.fen)
+                .with_node_limit(NODES)
+                .build();
+
+        auto start = std::chrono::steady_clock::now();
+        engine.blocking_run();
+        const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        const int nodes = subtree_size(engine.get_root());
+
+        start = std::chrono::steady_clock::now();
+        engine.cleanup();
+        const double free_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        total_nodes += nodes;
+        total_secs += secs;
+        total_free_secs += free_secs;
+        std::cout << std::left << std::setw(12) << pos.name << nodes << " nodes in " << dp_2(secs) << "s, freed in "
+                  << dp_2(1000 * free_secs) << "ms\n";
+    }
+
+    std::cout << "\nTotal: " << total_nodes << " nodes in " << dp_2(total_secs) << "s, "
+              << dp_2(total_nodes / total_secs / 1000) << "k nps, freed in " << dp_2(1000 * total_free_secs) << "ms\n";
+}
+
+/**
+ * Rescores every node of the given tree from its children, as each visit does along a line.
+ */
+void rescore_tree(SearchNode * node) {
+    for (SearchNode * child : node->children) {
+        rescore_tree(child);
+    }
+    update_score(node);
+}
+
+/**
+ * Child scanning throughput: builds one tree, then rescores every node in it repeatedly, which
+ * reads the score and visit count of every child and nothing else.
+ */
+void bench_child_scans() {
+
+    const int NODES = 100000;
+    const int REPEATS = 20;
+    const perft::ReferencePosition & pos = perft::REFERENCE_POSITIONS[1];
+
+    Engine engine =
+        EngineBuilder::for_position(pos.fen)
+            .with_node_limit(NODES)
+            .build();
+    engine.blocking_run();
+    const int nodes = subtree_size(engine.get_root());
+
+    std::cout << "\nChild scans, " << pos.name << " tree of " << nodes << " nodes\n\n";
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < REPEATS; ++i) {
+        rescore_tree(engine.get_root());
+    }
+    const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Rescoring:  " << dp_2(1e9 * secs / REPEATS / nodes) << " ns per node\n";
+    engine.cleanup();
+}
+
+/**
+ * Counts the built nodes in the tree which the search has visited since creating them, and the
+ * children which were left lazy.
+ */
+void count_visited(const SearchNode * node, int & visited, int & lazy) {
+    if (node->is_lazy()) {
+        ++lazy;
+        return;
+    }
+    if (node->visit_count > 0) { ++visited; }
+    for (const SearchNode * child : node->children) {
+        count_visited(child, visited, lazy);
+    }
+}
+
+/**
+ * Lazy children against eager ones, on endgames where the search soon reaches the legal list.
+ * Both build the same number of nodes, so the comparison is of how many of those nodes the search
+ * went on to visit, and how long it took to build them.
+ */
+void bench_lazy_children() {
+
+    const int NODES = 25000;
+    const std::vector<std::string> ENDGAMES{
+        "8/8/4k3/8/8/3K4/4P3/8 w - - 0 1",
+        "8/5pk1/6p1/8/8/6P1/5PK1/8 w - - 0 1",
+        "4k3/8/8/8/8/8/4P3/4K3 w - - 0 1",
+        "8/2k5/8/2p5/2P5/8/5K2/8 w - - 0 1",
+    };
+
+    std::cout << "\nLazy children, " << ENDGAMES.size() << " endgames up to " << NODES << " nodes\n\n";
+
+    for (const bool lazy : {false, true}) {
+
+        long nodes = 0, visited = 0, edges = 0;
+        double secs = 0;
+
+        for (const std::string & fen : ENDGAMES) {
+            Engine engine =
+                EngineBuilder::for_position(fen)
+                    .with_node_limit(NODES)
+                    .with_lazy_children(lazy)
+                    .build();
+
+            auto start = std::chrono::steady_clock::now();
+            engine.blocking_run();
+            secs += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            int v = 0, l = 0;
+            count_visited(engine.get_root(), v, l);
+            nodes += subtree_size(engine.get_root());
+            visited += v;
+            edges += l;
+            engine.cleanup();
+        }
+
+        std::cout << (lazy ? "Lazy:   " : "Eager:  ") << nodes << " nodes in " << dp_2(secs) << "s, "
+                  << visited << " visited (" << dp_2(100.0 * visited / nodes) << "%), "
+                  << edges << " left lazy\n";
+    }
+}
+
+/**
+ * Search throughput against the number of threads searching one tree, on the reference positions up
+ * to a fixed number of nodes. The speedup is the nps over that of a single thread.
+ */
+void bench_threads() {
+
+    const int NODES = 100000;
+    std::cout << "\nThreads, reference positions up to " << NODES << " nodes\n\n";
+
+    double single_nps = 0;
+
+    for (const int threads : {1, 2, 4, 8}) {
+
+        long nodes = 0;
+        double secs = 0;
+
+        for (const perft::ReferencePosition & pos : perft::REFERENCE_POSITIONS) {
+            Engine engine =
+                EngineBuilder::for_position(pos.fen)
+                    .with_node_limit(NODES)
+                    .with_threads(threads)
+                    .build();
+
+            auto start = std::chrono::steady_clock::now();
+            engine.blocking_run();
+            secs += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            nodes += subtree_size(engine.get_root());
+            engine.cleanup();
+        }
+
+        const double nps = nodes / secs;
+        if (threads == 1) { single_nps = nps; }
+        std::cout << std::left << std::setw(12) << (std::to_string(threads) + " threads") << nodes << " nodes in "
+                  << dp_2(secs) << "s, " << dp_2(nps / 1000) << "k nps, x" << dp_2(nps / single_nps) << "\n";
+    }
+}
+
+void bench_search() {
+    bench_nps();
+    bench_threads();
+    bench_lazy_children();
+    bench_child_scans();
+}
@@ -0,0 +1,167 @@
+#include "board.h"
+#include "attacks.h"
+
+/*
+ * Generates the attack tables declared in attacks.h.
+ *
+ * The magic numbers are found by trial: for each square we draw sparse random numbers until
+ * one maps every blocker configuration to a slot which is either free or already holds the
+ * same attack set. The generator is seeded per rank, with seeds known to find magics quickly,
+ * so the tables are identical on every run and take a few milliseconds to build.
+ */
+
+namespace __attack_data {
+    Magic rook_magics[64];
+    Magic bishop_magics[64];
+    Bitboard knight_attacks[64];
+    Bitboard king_attacks[64];
+    Bitboard pawn_attacks[2][64];
+    Bitboard rays[9][64];
+
+    // the sizes needed are the sums over all squares of 2^(relevant blocker squares)
+    Bitboard rook_table[0x19000];
+    Bitboard bishop_table[0x1480];
+}
+
+namespace {
+
+    const Delta ROOK_DELTAS[4] = { {1, 0}, {-1, 0}, {0, 1}, {0, -1} };
+    const Delta BISHOP_DELTAS[4] = { {1, 1}, {-1, 1}, {1, -1}, {-1, -1} };
+
+    /**
+     * A small xorshift* generator. We don't want std::rand here: the tables should not depend on
+     * anything else in the program having seeded it.
+     */
+    struct PRNG {
+        uint64_t s;
+
+        explicit PRNG(uint64_t seed) : s(seed) {}
+
+        inline uint64_t rand64() {
+            s ^= s >> 12;
+            s ^= s << 25;
+            s ^= s >> 27;
+            return s * 2685821657736338717ull;
+        }
+
+        // magics work best with few bits set
+        inline uint64_t sparse_rand() {
+            return rand64() & rand64() & rand64();
+        }
+    };
+
+    inline Bitboard step_bb(const int x, const int y) {
+        return val(x, y) ? sq_bb(x, y) : EMPTY_BB;
+    }
+
+    void init_step_attacks() {
+        for (int i = 0; i < 64; ++i) {
+            const Square s = index_sq(i);
+            const int x = s.x, y = s.y;
+
+            Bitboard knight = EMPTY_BB, king = EMPTY_BB;
+            for (int j = 0; j < 8; ++j) {
+                knight |= step_bb(x + XKN[j], y + YKN[j]);
+                king |= step_bb(x + XD[j], y + YD[j]);
+            }
+            __attack_data::knight_attacks[i] = knight;
+            __attack_data::king_attacks[i] = king;
+
+            __attack_data::pawn_attacks[bb_index(WHITE)][i] = step_bb(x - 1, y + 1) | step_bb(x + 1, y + 1);
+            __attack_data::pawn_attacks[bb_index(BLACK)][i] = step_bb(x - 1, y - 1) | step_bb(x + 1, y - 1);
+
+            for (int j = 0; j < 8; ++j) {
+                const Delta d = delta(XD[j], YD[j]);
+                __attack_data::rays[ray_index(d)][i] = sliding_attacks_slow(s, EMPTY_BB, &d, 1);
+            }
+        }
+    }
+
+    void init_magics(Bitboard * table, Magic * magics, const Delta * deltas) {
+
+        const uint64_t seeds[8] = { 728, 10316, 55013, 32803, 12281, 15100, 16645, 255 };
+
+        Bitboard occupancy[4096], reference[4096];
+        int epoch[4096] = {}, count = 0;
+        int size = 0;
+
+        for (int i = 0; i < 64; ++i) {
+
+            const Square s = index_sq(i);
+            Magic & m = magics[i];
+
+            // the edges are irrelevant unless the piece is standing on them
+            const Bitboard edges = ((RANK_1_BB | RANK_8_BB) & ~rank_bb(s.y))
+                                   | ((FILE_A_BB | FILE_H_BB) & ~file_bb(s.x));
+
+            m.mask = sliding_attacks_slow(s, EMPTY_BB, deltas, 4) & ~edges;
+            m.shift = 64 - popcount(m.mask);
+            m.attacks = (i == 0) ? table : magics[i - 1].attacks + size;
+
+            // enumerate every subset of the mask (carry-rippler) with its true attack set
+            Bitboard b = EMPTY_BB;
+            size = 0;
+            do {
+                occupancy[size] = b;
+                reference[size] = sliding_attacks_slow(s, b, deltas, 4);
+#if defined(USE_PEXT) && defined(__BMI2__)
+                m.attacks[_pext_u64(b, m.mask)] = reference[size];
+#endif
+                ++size;
+                b = (b - m.mask) & m.mask;
+            } while (b);
+
+#if defined(USE_PEXT) && defined(__BMI2__)
+            continue;
+#endif
+
+            PRNG rng(seeds[s.y]);
+
+            for (int j = 0; j < size; ) {
+
+                for (m.magic = 0; popcount((m.magic * m.mask) >> 56) < 6; ) {
+                    m.magic = rng.sparse_rand();
+                }
+
+                // epochs save us clearing the table between attempts
+                for (++count, j = 0; j < size; ++j) {
+                    unsigned idx = m.index(occupancy[j]);
+                    if (epoch[idx] < count) {
+                        epoch[idx] = count;
+                        m.attacks[idx] = reference[j];
+                    } else if (m.attacks[idx] != reference[j]) {
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    struct AttackTableInitialiser {
+        AttackTableInitialiser() {
+            init_step_attacks();
+            init_magics(__attack_data::rook_table, __attack_data::rook_magics, ROOK_DELTAS);
+            init_magics(__attack_data::bishop_table, __attack_data::bishop_magics, BISHOP_DELTAS);
+        }
+    };
+
+    // builds the tables during static initialisation
+    const AttackTableInitialiser initialiser;
+}
+
+Bitboard sliding_attacks_slow(const Square s, const Bitboard occ, const Delta * deltas, const int num_deltas) {
+
+    Bitboard attacks = EMPTY_BB;
+
+    for (int i = 0; i < num_deltas; ++i) {
+        int x = s.x + deltas[i].dx, y = s.y + deltas[i].dy;
+        while (val(x, y)) {
+            attacks |= sq_bb(x, y);
+            if (occ & sq_bb(x, y)) { break; }
+            x += deltas[i].dx;
+            y += deltas[i].dy;
+        }
+    }
+
+    return attacks;
+}
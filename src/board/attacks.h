@@ -0,0 +1,106 @@
+#ifndef STASE_ATTACKS_H
+#define STASE_ATTACKS_H
+
+#include <bit>
+
+#include "../../include/stase/board.h"
+#include "bitboard.h"
+
+#if defined(USE_PEXT) && defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+/*
+ * Attack tables. These answer "which squares does a piece on this square attack?" in a single
+ * lookup, rather than by walking the board one square at a time.
+ *
+ * Sliding pieces use magic bitboards: the relevant blockers on a rook's or bishop's lines are
+ * multiplied by a magic number, and the top bits of the product index into a table of
+ * precomputed attack sets. If the engine is built with -DUSE_PEXT on a BMI2 machine, the index
+ * is instead computed directly with the pext instruction and no magics are needed.
+ *
+ * Everything is generated once at startup (see attacks.cpp), before main runs.
+ */
+
+struct Magic {
+    Bitboard mask;
+    Bitboard magic;
+    Bitboard * attacks;
+    unsigned shift;
+
+    inline unsigned index(const Bitboard occ) const {
+#if defined(USE_PEXT) && defined(__BMI2__)
+        return (unsigned) _pext_u64(occ, mask);
+#else
+        return (unsigned) (((occ & mask) * magic) >> shift);
+#endif
+    }
+};
+
+namespace __attack_data {
+    extern Magic rook_magics[64];
+    extern Magic bishop_magics[64];
+    extern Bitboard knight_attacks[64];
+    extern Bitboard king_attacks[64];
+    extern Bitboard pawn_attacks[2][64];
+
+    /**
+     * The squares leading away from a square in a given direction, up to the edge of the board
+     * (not including the square itself). Index by (dx + 1) * 3 + (dy + 1).
+     */
+    extern Bitboard rays[9][64];
+}
+
+constexpr int ray_index(const Delta d) { return (d.dx + 1) * 3 + (d.dy + 1); }
+
+/**
+ * Sliding piece attacks, given the occupancy of the board. The squares returned include the
+ * first blocker in each direction, whatever its colour.
+ */
+inline Bitboard rook_attacks(const Square s, const Bitboard occ) {
+    const Magic & m = __attack_data::rook_magics[sq_index(s)];
+    return m.attacks[m.index(occ)];
+}
+inline Bitboard bishop_attacks(const Square s, const Bitboard occ) {
+    const Magic & m = __attack_data::bishop_magics[sq_index(s)];
+    return m.attacks[m.index(occ)];
+}
+inline Bitboard queen_attacks(const Square s, const Bitboard occ) {
+    return rook_attacks(s, occ) | bishop_attacks(s, occ);
+}
+
+/**
+ * Non-sliding attacks. Pawn attacks are the two squares a pawn of the given colour captures on.
+ */
+inline Bitboard knight_attacks(const Square s) { return __attack_data::knight_attacks[sq_index(s)]; }
+inline Bitboard king_attacks(const Square s) { return __attack_data::king_attacks[sq_index(s)]; }
+inline Bitboard pawn_attacks(const Colour c, const Square s) {
+    return __attack_data::pawn_attacks[bb_index(c)][sq_index(s)];
+}
+
+inline Bitboard ray_bb(const Square s, const Delta d) {
+    return __attack_data::rays[ray_index(d)][sq_index(s)];
+}
+
+/**
+ * Returns the square of the first piece found walking out from the given square along the
+ * delta, or SQUARE_SENTINEL if the edge of the board is reached first. This works on any
+ * occupancy, so it is safe to use while sneaked.
+ */
+inline Square first_piece_in_direction(const Square s, const Delta d, const Bitboard occ) {
+    const Bitboard blockers = ray_bb(s, d) & occ;
+    if (!blockers) { return SQUARE_SENTINEL; }
+
+    // rays which increase the bit index find their nearest blocker at the bottom, others at the top
+    return (d.dx + 8 * d.dy > 0)
+        ? lsb_sq(blockers)
+        : index_sq(63 - std::countl_zero(blockers));
+}
+
+/**
+ * The slow reference implementation of slider attacks, walking one square at a time. This is
+ * used to build the tables and to test them, and should not be used anywhere else.
+ */
+Bitboard sliding_attacks_slow(Square, Bitboard occ, const Delta * deltas, int num_deltas);
+
+#endif //STASE_ATTACKS_H
@@ -85,6 +85,14 @@ constexpr Colour opposite_colour(const Piece p) {
     return (p & COLOUR_MASK) ? BLACK : WHITE;
 }
 
+constexpr Colour opposite_colour(const Colour c) {
+    return (c == WHITE) ? BLACK : WHITE;
+}
+
+constexpr Piece mkpiece(const Colour c, const Ptype t) {
+    return (Piece) ((int) c | (int) t);
+}
+
 constexpr bool is_major_piece(Piece p) {
     switch (type(p)) {
         case QUEEN:
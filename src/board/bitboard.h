@@ -0,0 +1,62 @@
+#ifndef STASE_BITBOARD_H
+#define STASE_BITBOARD_H
+
+#include <bit>
+#include <cstdint>
+
+#include "../../include/stase/board.h"
+
+/**
+ * A Bitboard is a set of squares packed into a single 64-bit word. Bit i corresponds to the
+ * square (i % 8, i / 8), so a1 is bit 0, h1 is bit 7 and h8 is bit 63. This is the same
+ * indexing already used by the ControlCache.
+ */
+typedef uint64_t Bitboard;
+
+const Bitboard EMPTY_BB = 0ull;
+const Bitboard FULL_BB = ~0ull;
+
+const Bitboard FILE_A_BB = 0x0101010101010101ull;
+const Bitboard FILE_H_BB = FILE_A_BB << 7;
+const Bitboard RANK_1_BB = 0xFFull;
+const Bitboard RANK_8_BB = RANK_1_BB << 56;
+
+/**
+ * Conversion between squares, indices and single-bit boards.
+ */
+constexpr int sq_index(const Square s) { return s.x + 8 * s.y; }
+constexpr Square index_sq(const int i) { return Square{(Byte) (i & 7), (Byte) (i >> 3)}; }
+constexpr Bitboard sq_bb(const Square s) { return 1ull << sq_index(s); }
+constexpr Bitboard sq_bb(const int x, const int y) { return 1ull << (x + 8 * y); }
+
+constexpr Bitboard file_bb(const int x) { return FILE_A_BB << x; }
+constexpr Bitboard rank_bb(const int y) { return RANK_1_BB << (8 * y); }
+
+/**
+ * Basic queries on bitboards.
+ */
+constexpr int popcount(const Bitboard bb) { return std::popcount(bb); }
+constexpr bool contains(const Bitboard bb, const Square s) { return bb & sq_bb(s); }
+constexpr bool more_than_one(const Bitboard bb) { return bb & (bb - 1); }
+
+/** @return the lowest set square. The board must not be empty. */
+constexpr Square lsb_sq(const Bitboard bb) { return index_sq(std::countr_zero(bb)); }
+
+/** Removes and returns the lowest set square. The board must not be empty. */
+constexpr Square pop_lsb(Bitboard & bb) {
+    Square s = lsb_sq(bb);
+    bb &= bb - 1;
+    return s;
+}
+
+/**
+ * Indexes into the per-piece and per-colour bitboard arrays held by the Board. Pieces use
+ * their own value (0-5 for black, 8-13 for white), colours use their fourth bit.
+ */
+constexpr int bb_index(const Piece p) { return (int) p; }
+constexpr int bb_index(const Colour c) { return ((int) c) >> 3; }
+
+const int NUM_PIECE_BBS = 14;
+const int NUM_COLOUR_BBS = 2;
+
+#endif //STASE_BITBOARD_H
@@ -18,8 +18,12 @@ using std::string;
  *
  *      -Board::get():       return the current piece on a square
  *      -Board::set():       set the piece of a square
+ *      -Board::pieces():    return a bitboard of the squares holding a given piece
+ *      -Board::occupied():  return a bitboard of the occupied squares
  *
  *      -> the board struct stores a 2d array of bytes
+ *      -> alongside it, one bitboard per piece and one per colour, kept in sync by set()
+ *      -> and a Zobrist key for the position, kept in sync by set() and the config setters
  *      -> the config word is 32 bits
  *      -> Config bits:
  *          Bit 0:          Turn colour
@@ -46,22 +50,78 @@ namespace __bit_masks {
     const unsigned WHOLE_M_MASK = (unsigned) (~0) << 16;
 }
 
+/**
+ * Everything needed to take back a move made with Board::make_move. Only the pieces which moved
+ * or were captured need remembering: the config word and key are restored wholesale.
+ */
+struct BoardUndo {
+    Int conf;
+    ZobristKey key;
+    Piece moved;
+    Piece captured;
+    Square captured_sq;
+};
+
 struct Board {
 
     mutable Piece squares[8][8];
+    mutable Bitboard piece_bbs[NUM_PIECE_BBS];
+    mutable Bitboard colour_bbs[NUM_COLOUR_BBS];
+    mutable ZobristKey key;
     Int conf;
 
     inline Piece get(const int x, const int y) const {
         return squares[x][y];
     };
     inline void set(const int x, const int y, const Piece p) {
-        squares[x][y] = p;
+        place(x, y, p);
     }
     inline Piece get(const Square & s) const {
         return squares[s.x][s.y];
     };
     inline void set(const Square & s, const Piece p) {
-        squares[s.x][s.y] = p;
+        place(s.x, s.y, p);
+    }
+
+    /**
+     * Bitboard accessors. These always agree with the squares array: every write to the
+     * board goes through set(), sneak() or unsneak(), which keep both in step.
+     */
+    inline Bitboard pieces(const Piece p) const { return piece_bbs[bb_index(p)]; }
+    inline Bitboard pieces(const Colour c, const Ptype t) const {
+        return piece_bbs[bb_index(mkpiece(c, t))];
+    }
+    inline Bitboard occupied(const Colour c) const { return colour_bbs[bb_index(c)]; }
+    inline Bitboard occupied() const { return colour_bbs[0] | colour_bbs[1]; }
+    inline Bitboard empty_squares() const { return ~occupied(); }
+
+    /** @return the number of the given piece on the board */
+    inline int count(const Piece p) const { return popcount(pieces(p)); }
+
+    /**
+     * @return the square of the king of the given colour, or SQUARE_SENTINEL if it has none. The
+     * king bitboard is always up to date, so this needs no search and no extra state.
+     */
+    inline Square king_square(const Colour c) const {
+        const Bitboard kings = pieces(c, KING);
+        return kings ? lsb_sq(kings) : SQUARE_SENTINEL;
+    }
+
+    /**
+     * The Zobrist key of the position: pieces, side to move, castling rights and en-passant
+     * file. Move counters are not included, so positions which are equivalent() share a key.
+     */
+    inline ZobristKey get_key() const { return key; }
+
+    /** Computes the key from scratch. This should always agree with get_key(). */
+    ZobristKey compute_key() const {
+        ZobristKey k = conf_key(conf);
+        for (int x = 0; x < 8; ++x) {
+            for (int y = 0; y < 8; ++y) {
+                if (squares[x][y] != EMPTY) { k ^= piece_key(squares[x][y], x, y); }
+            }
+        }
+        return k;
     }
 
     /**
@@ -71,16 +131,16 @@ struct Board {
      * You can only SNEAK if you promise to immediately UNSNEAK!
      */
     inline Piece sneak(const Move m) const {
-        Piece p = this->get(m.from);
-        Piece captured = this->get(m.to);
+        Piece p = this->get(m.from());
+        Piece captured = this->get(m.to());
 
         // set the from square to empty
-        squares[m.from.x][m.from.y] = EMPTY;
+        place(m.from().x, m.from().y, EMPTY);
 
         /*
          * Set the to square to the piece
          */
-        squares[m.to.x][m.to.y] = p;
+        place(m.to().x, m.to().y, p);
 
         return captured;
     }
@@ -95,16 +155,16 @@ struct Board {
      */
     inline void unsneak(const Move m, const Piece captured) const {
 
-        Piece p = this->get(m.to);
+        Piece p = this->get(m.to());
 
         // set the to square to the captured piece
-        squares[m.to.x][m.to.y] = captured;
+        place(m.to().x, m.to().y, captured);
 
         // set the from square to the piece
-        squares[m.from.x][m.from.y] = p;
+        place(m.from().x, m.from().y, p);
     }
 
-    inline void set_conf_word(Int c) { conf = c; }
+    inline void set_conf_word(Int c) { write_conf(c); }
     inline Int get_conf_word() const { return conf; }
 
     /**
@@ -113,11 +173,14 @@ struct Board {
     inline bool get_white() const { return conf & __bit_masks::WHITE_MASK; }
     inline void set_white(bool b) {
         if (b)
-            conf |= __bit_masks::WHITE_MASK;
+            write_conf(conf | __bit_masks::WHITE_MASK);
         else
-            conf &= ~__bit_masks::WHITE_MASK;
+            write_conf(conf & ~__bit_masks::WHITE_MASK);
+    }
+    inline void flip_white() {
+        conf ^= __bit_masks::WHITE_MASK;
+        key ^= __zobrist::KEYS.white_to_move;
     }
-    inline void flip_white() { conf ^= __bit_masks::WHITE_MASK; }
     inline Colour colour_to_move() const {
         return (conf & __bit_masks::WHITE_MASK) ? WHITE : BLACK;
     }
@@ -128,30 +191,30 @@ struct Board {
     inline bool get_cas_ws() const { return conf & __bit_masks::CAS_WS_MASK; }
     inline void set_cas_ws(bool b) {
         if (b)
-            conf |= __bit_masks::CAS_WS_MASK;
+            write_conf(conf | __bit_masks::CAS_WS_MASK);
         else
-            conf &= ~__bit_masks::CAS_WS_MASK;
+            write_conf(conf & ~__bit_masks::CAS_WS_MASK);
     }
     inline bool get_cas_wl() const { return conf & __bit_masks::CAS_WL_MASK; }
     inline void set_cas_wl(bool b) {
         if (b)
-            conf |= __bit_masks::CAS_WL_MASK;
+            write_conf(conf | __bit_masks::CAS_WL_MASK);
         else
-            conf &= ~__bit_masks::CAS_WL_MASK;
+            write_conf(conf & ~__bit_masks::CAS_WL_MASK);
     }
     inline bool get_cas_bs() const { return conf & __bit_masks::CAS_BS_MASK; }
     inline void set_cas_bs(bool b) {
         if (b)
-            conf |= __bit_masks::CAS_BS_MASK;
+            write_conf(conf | __bit_masks::CAS_BS_MASK);
         else
-            conf &= ~__bit_masks::CAS_BS_MASK;
+            write_conf(conf & ~__bit_masks::CAS_BS_MASK);
     }
     inline bool get_cas_bl() const { return conf & __bit_masks::CAS_BL_MASK; }
     inline void set_cas_bl(bool b) {
         if (b)
-            conf |= __bit_masks::CAS_BL_MASK;
+            write_conf(conf | __bit_masks::CAS_BL_MASK);
         else
-            conf &= ~__bit_masks::CAS_BL_MASK;
+            write_conf(conf & ~__bit_masks::CAS_BL_MASK);
     }
 
     /**
@@ -160,9 +223,9 @@ struct Board {
     inline bool get_ep_exists() const { return conf & __bit_masks::EP_EX_MASK; }
     inline void set_ep_exists(bool b) {
         if (b)
-            conf |= __bit_masks::EP_EX_MASK;
+            write_conf(conf | __bit_masks::EP_EX_MASK);
         else
-            conf &= ~__bit_masks::EP_EX_MASK;
+            write_conf(conf & ~__bit_masks::EP_EX_MASK);
     }
 
     /**
@@ -172,7 +235,7 @@ struct Board {
         return (conf & __bit_masks::EP_FILE_MASK) >> 6;
     }
     inline void set_ep_file(Byte u) {
-        conf = (conf & ~__bit_masks::EP_FILE_MASK) | (u << 6);
+        write_conf((conf & ~__bit_masks::EP_FILE_MASK) | (u << 6));
     }
     /** Returns the square on which an en-passant capture could take place */
     inline Square get_ep_sq() const {
@@ -214,6 +277,9 @@ struct Board {
     /* change the position of the pieces, without affecting config */
     void mutate(const Move m) {
 
+        // played moves are never the sentinel, so their squares are read without checking for it
+        const Square from = index_sq(m.from_index()), to = index_sq(m.to_index());
+
         Colour col = colour_to_move();
 
         // castling
@@ -251,38 +317,40 @@ struct Board {
         }
 
         // move piece
-        Piece p = get(m.from);
-        set(m.to, p);
-        set(m.from, EMPTY);
+        Piece p = get(from);
+        set(to, p);
+        set(from, EMPTY);
 
         // promotion
         if (m.is_prom()) {
             p = m.get_prom_piece(col);
-            set(m.to, p);
+            set(to, p);
         }
     }
 
     void mutate_hard(const Move m) {
 
+        const Square from = index_sq(m.from_index()), to = index_sq(m.to_index());
+
         // castling
-        if (type(get(m.from)) == KING) {
-            int delta = get_x(m.from) - get_x(m.to);
+        if (type(get(from)) == KING) {
+            int delta = get_x(from) - get_x(to);
             if (delta == 2 || delta == -2) {
 
                 // white short
-                if (equal(m.to, Square{6, 0})) {
+                if (equal(to, Square{6, 0})) {
                     set(mksq(7, 0), EMPTY);
                     set(mksq(5, 0), W_ROOK);
                 }
 
                 // white long
-                else if (equal(m.to, Square{2, 0})) {
+                else if (equal(to, Square{2, 0})) {
                     set(mksq(0, 0), EMPTY);
                     set(mksq(3, 0), W_ROOK);
                 }
 
                 // black short
-                else if (equal(m.to, Square{6, 7})) {
+                else if (equal(to, Square{6, 7})) {
                     set(mksq(7, 7), EMPTY);
                     set(mksq(5, 7), B_ROOK);
                 }
@@ -296,31 +364,81 @@ struct Board {
         }
 
         // en-passant
-        if (type(get(m.from)) == PAWN && get_x(m.from) != get_x(m.to)) {
-            if (get(m.to) == EMPTY) {
+        if (type(get(from)) == PAWN && get_x(from) != get_x(to)) {
+            if (get(to) == EMPTY) {
 
                 // white
-                if (get_y(m.to) == 5) {
-                    set(mksq(get_x(m.to), 4), EMPTY);
+                if (get_y(to) == 5) {
+                    set(mksq(get_x(to), 4), EMPTY);
                 }
 
                 // black
                 else {
-                    set(mksq(get_x(m.to), 3), EMPTY);
+                    set(mksq(get_x(to), 3), EMPTY);
                 }
             }
         }
 
         // move piece
-        Piece p = get(m.from);
-        set(m.to, p);
-        set(m.from, EMPTY);
+        Piece p = get(from);
+        set(to, p);
+        set(from, EMPTY);
 
         // promotion
-        if (type(get(m.to)) == PAWN && (get_y(m.to) == 7 || get_y(m.to) == 0)) {
-            Piece prom_piece = m.get_prom_piece(colour(get(m.to)));
-            set(m.to, prom_piece);
+        if (type(get(to)) == PAWN && (get_y(to) == 7 || get_y(to) == 0)) {
+            Piece prom_piece = m.get_prom_piece(colour(get(to)));
+            set(to, prom_piece);
+        }
+    }
+
+    /**
+     * Plays the move on this board, in the same way as successor_hard (so the move's flags need
+     * not be set), and records what is needed to take it back in the given undo record. This
+     * avoids copying the board, so depth-first walks of the tree should make and unmake moves
+     * rather than create successors.
+     */
+    void make_move(const Move m, BoardUndo & undo) {
+
+        const Square from = index_sq(m.from_index()), to = index_sq(m.to_index());
+
+        undo.conf = conf;
+        undo.key = key;
+        undo.moved = get(from);
+        undo.captured = get(to);
+        undo.captured_sq = to;
+
+        // an en-passant capture takes a pawn which is not on the destination square
+        if (type(undo.moved) == PAWN && from.x != to.x && undo.captured == EMPTY) {
+            undo.captured_sq = mksq(to.x, from.y);
+            undo.captured = get(undo.captured_sq);
+        }
+
+        mutate_hard(m);
+        update_config_after_move(*this, m);
+    }
+
+    /**
+     * Takes back the move, which must be the last one made with make_move, using the undo
+     * record it filled in.
+     */
+    void unmake_move(const Move m, const BoardUndo & undo) {
+
+        const Square from = index_sq(m.from_index()), to = index_sq(m.to_index());
+
+        // castling: put the rook back in the corner
+        if (type(undo.moved) == KING && (to.x - from.x == 2 || from.x - to.x == 2)) {
+            const int y = from.y;
+            const Piece rook = get(to.x == 6 ? 5 : 3, y);
+            set(to.x == 6 ? 5 : 3, y, EMPTY);
+            set(to.x == 6 ? 7 : 0, y, rook);
         }
+
+        set(to, EMPTY);
+        set(undo.captured_sq, undo.captured);
+        set(from, undo.moved);
+
+        conf = undo.conf;
+        key = undo.key;
     }
 
     /**
@@ -357,14 +475,12 @@ struct Board {
      * threefold repetition.
      */
     bool equivalent(const Board & o) const {
-        if (non_move_conf() != o.non_move_conf()) {
+        if (key != o.key || non_move_conf() != o.non_move_conf()) {
             return false;
         }
-        for (int x = 0; x < 8; ++x) {
-            for (int y = 0; y < 8; ++y) {
-                if (squares[x][y] != o.squares[x][y]) {
-                    return false;
-                }
+        for (int i = 0; i < NUM_PIECE_BBS; ++i) {
+            if (piece_bbs[i] != o.piece_bbs[i]) {
+                return false;
             }
         }
         return true;
@@ -375,11 +491,12 @@ struct Board {
 
         for (int x = 0; x < 8; ++x) {
             for (int y = 0; y < 8; ++y) {
-                b.set(x, y, EMPTY);
+                b.squares[x][y] = EMPTY;
             }
         }
 
         b.conf = 0;
+        b.key = 0;
         return b;
     }
 
@@ -389,6 +506,45 @@ struct Board {
 
 private:
 
+    /**
+     * Writes the piece to the square, removing whatever was there before from the bitboards.
+     * This is const only because sneak and unsneak are: see the note on sneak.
+     */
+    inline void place(const int x, const int y, const Piece p) const {
+        const Piece old = squares[x][y];
+        const Bitboard bit = sq_bb(x, y);
+        if (old != EMPTY) {
+            piece_bbs[bb_index(old)] &= ~bit;
+            colour_bbs[bb_index(colour(old))] &= ~bit;
+            key ^= piece_key(old, x, y);
+        }
+        if (p != EMPTY) {
+            piece_bbs[bb_index(p)] |= bit;
+            colour_bbs[bb_index(colour(p))] |= bit;
+            key ^= piece_key(p, x, y);
+        }
+        squares[x][y] = p;
+    }
+
+    /**
+     * The part of the key which comes from the config word. An empty config word (black to
+     * move, no castling, no en-passant) contributes nothing.
+     */
+    static ZobristKey conf_key(const Int c) {
+        ZobristKey k = __zobrist::KEYS.castling[(c >> 1) & 15];
+        if (c & __bit_masks::WHITE_MASK) { k ^= __zobrist::KEYS.white_to_move; }
+        if (c & __bit_masks::EP_EX_MASK) {
+            k ^= __zobrist::KEYS.ep_file[(c & __bit_masks::EP_FILE_MASK) >> 6];
+        }
+        return k;
+    }
+
+    /** Replaces the config word, updating the key to match. */
+    inline void write_conf(const Int c) {
+        key ^= conf_key(conf) ^ conf_key(c);
+        conf = c;
+    }
+
     /**
    * Updates the config information for the given board, assuming the move m has just been moved.
    * This updates castling rights, en-passant, turn etc.
@@ -401,16 +557,16 @@ private:
         if (b.get_white() && (b.get_cas_ws() || b.get_cas_wl())) {
 
             // castling rights (from king move)
-            if (b.get(m.to) == W_KING) {
+            if (b.get(m.to()) == W_KING) {
                 b.set_cas_ws(false);
                 b.set_cas_wl(false);
             }
 
             // castling rights from rook move
-            if (b.get(m.to) == W_ROOK) {
-                if (equal(m.from, Square{7, 0})) {
+            if (b.get(m.to()) == W_ROOK) {
+                if (equal(m.from(), Square{7, 0})) {
                     b.set_cas_ws(false);
-                } else if (equal(m.from, Square{0, 0})) {
+                } else if (equal(m.from(), Square{0, 0})) {
                     b.set_cas_wl(false);
                 }
             }
@@ -421,16 +577,16 @@ private:
         if (!b.get_white() && (b.get_cas_bs() || b.get_cas_bl())) {
 
             // castling rights (from king move)
-            if (b.get(m.to) == B_KING) {
+            if (b.get(m.to()) == B_KING) {
                 b.set_cas_bs(false);
                 b.set_cas_bl(false);
             }
 
             // castling rights from rook move
-            if (b.get(m.to) == B_ROOK) {
-                if (equal(m.from, Square{7, 7})) {
+            if (b.get(m.to()) == B_ROOK) {
+                if (equal(m.from(), Square{7, 7})) {
                     b.set_cas_bs(false);
-                } else if (equal(m.from, Square{0, 7})) {
+                } else if (equal(m.from(), Square{0, 7})) {
                     b.set_cas_bl(false);
                 }
             }
@@ -438,11 +594,11 @@ private:
         }
 
         // en-passant
-        if (type(b.get(m.to)) == PAWN) {
-            if ((b.get_white() && get_y(m.to) - get_y(m.from) == 2)
-                || (!b.get_white() && get_y(m.to) - get_y(m.from) == -2)) {
+        if (type(b.get(m.to())) == PAWN) {
+            if ((b.get_white() && get_y(m.to()) - get_y(m.from()) == 2)
+                || (!b.get_white() && get_y(m.to()) - get_y(m.from()) == -2)) {
                 b.set_ep_exists(true);
-                b.set_ep_file(get_x(m.from));
+                b.set_ep_file(get_x(m.from()));
             } else {
                 b.set_ep_exists(false);
             }
@@ -451,7 +607,7 @@ private:
         }
 
         // half moves
-        if (m.is_cap() || type(b.get(m.to)) == PAWN) {
+        if (m.is_cap() || type(b.get(m.to())) == PAWN) {
             b.set_halfmoves(0);
         } else {
             b.inc_halfmoves();
@@ -467,10 +623,12 @@ private:
 
     /**
      * Returns a version of the conf word which does not include the whole or half move count (ie, the bits
-     * are set to zero).
+     * are set to zero). The en-passant file is left over from the last double push, so it is also cleared
+     * unless en-passant is actually available, as the key does.
      */
     uint32_t non_move_conf() const {
-        return (conf & ~__bit_masks::WHOLE_M_MASK) & ~__bit_masks::HALF_M_MASK;
+        Int c = (conf & ~__bit_masks::WHOLE_M_MASK) & ~__bit_masks::HALF_M_MASK;
+        return (c & __bit_masks::EP_EX_MASK) ? c : (c & ~__bit_masks::EP_FILE_MASK);
     }
 };
 
@@ -1,19 +1,18 @@
+#include <algorithm>
+
 #include "board.h"
 #include "board.hpp"
 
 GameStatus game_rules::check_status(const Board & b) {
 
-    bool in_check = game_rules::in_check(b);
-    std::vector<Move> legal_moves = game_rules::legal_moves(b);
-
-    if (legal_moves.empty()) {
-        if (!in_check) {
+    if (!game_rules::has_any_legal_move(b)) {
+        if (!game_rules::in_check(b)) {
             return DRAW_BY_STALEMATE;
         }
         return b.get_white() ? BLACK_WON : WHITE_WON;
     }
 
-    if (b.get_halfmoves() >= 50) {
+    if (b.get_halfmoves() >= 100) {
         return DRAW_BY_FIFTY_MOVES;
     }
 
@@ -26,31 +25,60 @@ GameStatus game_rules::check_status(const std::string & fen) {
 
 GameStatus game_rules::check_status(const std::vector<Board> & boards) {
 
-    const Board & current_pos =boards.back();
-    GameStatus status = game_rules::check_status(current_pos);
+    GameRecord record(boards.front());
+    for (int i = 1; i < (int) boards.size(); ++i) {
+        record.push(boards[i]);
+    }
+    return record.status(boards.back());
+}
 
-    if (status != ONGOING) {
-        return status;
+GameStatus game_rules::check_status(const std::vector<std::string> & fens) {
+    std::vector<Board> boards;
+    boards.reserve(fens.size());
+    for (const std::string & fen : fens) {
+        boards.push_back(board_utils::fen_to_board(fen));
     }
+    return game_rules::check_status(boards);
+}
+
+GameRecord::GameRecord(const Board & start) {
+    push(start);
+}
 
-    int count = 0;
+void GameRecord::push(const Board & b) {
+    entries.push_back(Entry{b.get_key(), b.get_halfmoves()});
+}
 
-    // we now search the board history
-    for (int i = (int)boards.size() - 1; i >= 0; --i) {
-        const Board & b = boards[i];
-        if (b.equivalent(current_pos)) {
-            if (++count == 3) {
-                return DRAW_BY_THREEFOLD;
-            }
+void GameRecord::pop() {
+    if (entries.size() > 1) {
+        entries.pop_back();
+    }
+}
+
+int GameRecord::repetitions() const {
+
+    const Entry & latest = entries.back();
+    const int last = (int) entries.size() - 1;
+
+    // positions before the last irreversible move can't come round again, and only every other
+    // position has the same player to move
+    const int earliest = std::max(0, last - (int) latest.halfmoves);
+    int count = 1;
+
+    for (int i = last - 2; i >= earliest; i -= 2) {
+        if (entries[i].key == latest.key) {
+            ++count;
         }
     }
-    return ONGOING;
+    return count;
 }
 
-GameStatus game_rules::check_status(const std::vector<std::string> & fens) {
-    std::vector<Board> boards(fens.size());
-    for (const std::string & fen : fens) {
-        boards.push_back(board_utils::fen_to_board(fen));
+GameStatus GameRecord::status(const Board & b) const {
+
+    GameStatus status = game_rules::check_status(b);
+
+    if (status == ONGOING && repetitions() >= 3) {
+        return DRAW_BY_THREEFOLD;
     }
-    return game_rules::check_status(boards);
+    return status;
 }
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <optional>
 #include <ostream>
 #include <string>
 #include <vector>
@@ -9,6 +10,7 @@ using std::cout;
 
 #include "board.h"
 #include "board.hpp"
+#include "move_gen.h"
 
 
 /**
@@ -16,11 +18,18 @@ using std::cout;
  * Requires disambiguations and checks to be used. If the move does not appear to describe
  * any legal move, then MOVE_SENTINEL is returned.
  */
+string mtos(const Board &, Move, std::optional<CheckInfo> &);
+
 Move stom(const Board & b, const string & san) {
 
-    for (const Move m : game_rules::legal_moves(b)) {
-        if (mtos(b, m) == san) {
-            return m;
+    Move legal_moves_arr[MAX_LEGAL_MOVES];
+    ptr_vec<Move> legal_moves(legal_moves_arr, MAX_LEGAL_MOVES);
+    game_rules::legal_moves(b, legal_moves);
+
+    std::optional<CheckInfo> info;
+    for (int i = 0; i < legal_moves.size(); ++i) {
+        if (mtos(b, legal_moves[i], info) == san) {
+            return legal_moves[i];
         }
     }
 
@@ -47,37 +56,65 @@ enum DisambigType {
     TOTAL
 };
 
+/**
+ * @return the other pieces of the same type and colour as the one moving which attack the
+ * destination square (for pawns, only when capturing). These are the only pieces which could
+ * make a move needing disambiguation.
+ */
+Bitboard rivals(const Board & b, const Move m) {
+
+    const Piece p = b.get(m.from());
+    const Colour c = colour(p);
+    const Bitboard same = b.pieces(p) & ~sq_bb(m.from());
+    if (!same) { return EMPTY_BB; }
+
+    switch (type(p)) {
+        case PAWN:
+            return (m.from().x != m.to().x) ? pawn_attacks(opposite_colour(c), m.to()) & same : EMPTY_BB;
+        case KNIGHT: return knight_attacks(m.to()) & same;
+        case BISHOP: return bishop_attacks(m.to(), b.occupied()) & same;
+        case ROOK: return rook_attacks(m.to(), b.occupied()) & same;
+        case QUEEN: return queen_attacks(m.to(), b.occupied()) & same;
+        default: return EMPTY_BB;
+    }
+}
+
 /**
  * Checks whether disambiguation is needed for the given move on the given board. An appropriate
  * type (e.g. rank or file) is returned. If disambiguation is required, and either rank or file
  * would be effective, then file is returned as the default option.
+ * Only the rival pieces' moves to the same square are tested for legality, and the check and pin
+ * information needed to do so is only worked out (into the given optional) if there are any.
  */
-DisambigType compute_disambig(const Board & b, const Move m) {
+DisambigType compute_disambig(const Board & b, const Move m, std::optional<CheckInfo> & info) {
 
-    std::vector<Move> legals = game_rules::legal_moves(b);
+    Bitboard others = rivals(b, m);
     bool required = false;
     bool rank_not_usable = false;
     bool file_not_usable = false;
 
-    for (const Move & other_m : legals) {
+    if (others && !info) {
+        info.emplace(b);
+    }
 
-        if (equal(other_m.from, m.from)) { continue; }
+    while (others) {
 
-        // moves of same type piece to the same destination
-        if (equal(other_m.to, m.to)
-                && type(b.get(other_m.from)) == type(b.get(m.from))) {
+        const Square s = pop_lsb(others);
+        Move other_m{s, m.to(), 0};
+        if (type(b.get(s)) == PAWN && b.get(m.to()) == EMPTY) {
+            other_m.set_ep();
+        }
+        if (!info->is_legal(b, other_m, info->allowed(s))) { continue; }
 
-            required = true;
-
-            // sharing start rank
-            if (get_y(other_m.from) == get_y(m.from)) {
-                rank_not_usable = true;
-            }
-            // sharing start file
-            else if (get_x(other_m.from) == get_x(m.from)) {
-                file_not_usable = true;
-            }
+        required = true;
 
+        // sharing start rank
+        if (get_y(s) == get_y(m.from())) {
+            rank_not_usable = true;
+        }
+        // sharing start file
+        else if (get_x(s) == get_x(m.from())) {
+            file_not_usable = true;
         }
     }
 
@@ -96,53 +133,54 @@ DisambigType compute_disambig(const Board & b, const Move m) {
 }
 
 /**
- * Converts a move to SAN. This depends on the board, which you must therefore provide.
- * The board must represent the position before the given move has been played.
+ * Converts a move to SAN, sharing the check and pin information between calls on the same board.
  */
-string mtos(const Board & b, const Move m) {
+string mtos(const Board & b, const Move m, std::optional<CheckInfo> & info) {
 
     if (is_sentinel(m)) {
         return "no move";
     }
-    if (equal(m.from, empty_move().from) && equal(m.to, empty_move().to)) {
+    if (equal(m.from(), empty_move().from()) && equal(m.to(), empty_move().to())) {
         return "empty move";
     }
-    if (equal(m.from, m.to)) {
+    if (equal(m.from(), m.to())) {
         return "invalid move";
     }
 
     string s;
-    Colour piece_colour = colour(b.get(m.from));
+    Colour piece_colour = colour(b.get(m.from()));
 
-    bool castle = (type(b.get(m.from)) == KING && abs(get_x(m.to) - get_x(m.from)) == 2);
-    bool capture = (b.get(m.to) != EMPTY);
-    bool prom = (type(b.get(m.from)) == PAWN && (get_y(m.to) == 7 || get_y(m.to) == 0));
-    DisambigType disambig = compute_disambig(b, m);
+    bool castle = (type(b.get(m.from())) == KING && abs(get_x(m.to()) - get_x(m.from())) == 2);
+    // en-passant captures land on an empty square, but are captures all the same
+    bool capture = (b.get(m.to()) != EMPTY)
+        || (type(b.get(m.from())) == PAWN && get_x(m.to()) != get_x(m.from()));
+    bool prom = (type(b.get(m.from())) == PAWN && (get_y(m.to()) == 7 || get_y(m.to()) == 0));
+    DisambigType disambig = compute_disambig(b, m, info);
 
     if (!castle) {
     
         // add character for piece type
-        s += ptos_alg(b.get(m.from));
+        s += ptos_alg(b.get(m.from()));
 
         switch (disambig) {
             case NONE: break;
-            case BY_RANK: s += (char) ('1' + get_y(m.from)); break;
-            case BY_FILE: s += (char) (get_x(m.from) + 'a'); break;
-            case TOTAL: s += sqtos(m.from); break;
+            case BY_RANK: s += (char) ('1' + get_y(m.from())); break;
+            case BY_FILE: s += (char) (get_x(m.from()) + 'a'); break;
+            case TOTAL: s += sqtos(m.from()); break;
         }
         
         // for captures add x
         if (capture) {
-            if (prom || type(b.get(m.from)) == PAWN) {
+            if (prom || type(b.get(m.from())) == PAWN) {
                 if (disambig == NONE) {
-                    s += (char) (get_x(m.from) + 'a');
+                    s += (char) (get_x(m.from()) + 'a');
                 }
             }
             s += "x";
         }
             
         // add destination
-        s += sqtos(m.to);
+        s += sqtos(m.to());
         
         // for promotions, add =Q/R/N/B
         if (prom) {
@@ -151,7 +189,7 @@ string mtos(const Board & b, const Move m) {
         }
     
     } else {
-        bool is_cas_short = m.is_cas_short() || get_x(m.to) == 6;
+        bool is_cas_short = m.is_cas_short() || get_x(m.to()) == 6;
         s = is_cas_short ? "O-O" : "O-O-O";
     }
     
@@ -164,43 +202,102 @@ string mtos(const Board & b, const Move m) {
     return s;
 }
 
-/***** useful for reading ints and strings from a stringstream *****/
-string get_word(stringstream & ss) {
-    string word;
-    ss >> word;
-    return word; 
+/**
+ * Converts a move to SAN. This depends on the board, which you must therefore provide.
+ * The board must represent the position before the given move has been played.
+ */
+string mtos(const Board & b, const Move m) {
+    std::optional<CheckInfo> info;
+    return mtos(b, m, info);
 }
 
-int get_number(stringstream & ss) {
-    int num;
-    ss >> num;
-    return num; 
+void mtos(const Board & b, const vector<Move> & moves, vector<string> & sans) {
+    std::optional<CheckInfo> info;
+    sans.reserve(sans.size() + moves.size());
+    for (const Move m : moves) {
+        sans.push_back(mtos(b, m, info));
+    }
+}
+
+string mtos_line(const Board & b, const vector<Move> & line) {
+
+    Board local = b;
+    BoardUndo undo;
+    string s;
+
+    for (int i = 0; i < (int) line.size(); ++i) {
+        std::optional<CheckInfo> info;
+        if (i) { s += ' '; }
+        s += mtos(local, line[i], info);
+        local.make_move(line[i], undo);
+    }
+    return s;
 }
 
 /***** FEN to board and board to FEN *****/
 
+namespace {
+
+    inline bool is_space(const char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+    }
+
+    /**
+     * Moves the given position in the string past any whitespace, and returns the field which
+     * starts there (up to the next whitespace). The field is empty once the string runs out.
+     */
+    std::string_view next_field(const std::string_view & s, size_t & i) {
+        while (i < s.size() && is_space(s[i])) { ++i; }
+        const size_t start = i;
+        while (i < s.size() && !is_space(s[i])) { ++i; }
+        return s.substr(start, i - start);
+    }
+
+    /** @return the number at the start of the field, or zero if there is none. */
+    unsigned parse_number(const std::string_view & field) {
+        unsigned n = 0;
+        for (const char c : field) {
+            if (c < '0' || c > '9') { break; }
+            n = 10 * n + (c - '0');
+        }
+        return n;
+    }
+
+    /** Writes the number, returning the position after it. */
+    char * write_number(char * out, unsigned n) {
+        char digits[10];
+        int len = 0;
+        do {
+            digits[len++] = (char) ('0' + n % 10);
+            n /= 10;
+        } while (n);
+        while (len) { *out++ = digits[--len]; }
+        return out;
+    }
+}
+
+/**
+ * Parses the FEN in a single pass over the string, without allocating. Missing move counters
+ * are read as zero, and a malformed piece layout gives an empty board.
+ */
 Board board_utils::fen_to_board(const std::string_view & fen) {
 
-    std::string s(fen);
-    stringstream stream(s);
     Board b = Board::empty();
-    
-    /* take the first token: the pieces on the board */
-    string piece_layout = get_word(stream);
-    unsigned i = 0;  // point in string
+    size_t i = 0;
+
+    /* take the first field: the pieces on the board */
+    const std::string_view piece_layout = next_field(fen, i);
     unsigned y = 7, x = 0; // coordinates on board
-    while (i < piece_layout.size()) {
-        
-        // read the next character
-        char c = piece_layout.at(i++);
+    for (const char c : piece_layout) {
+
         Piece p;
-        
+
         if (c == '/') {
             // forward slash: move on to next row
             x = 0;
             --y;
         } else if ((p = ctop(c)) != EMPTY) {
-            
+
             // valid piece: output it
             if (y < 8 && x < 8) {
                 b.set(mksq(x, y), p);
@@ -208,10 +305,10 @@ Board board_utils::fen_to_board(const std::string_view & fen) {
             } else {
                 return Board::empty();
             }
-            
+
         } else if ('1' <= c && c <= '8') {
-            
-            // legal integer: skip forward in row, printing empty
+
+            // legal integer: skip forward in row
             x += (c - '0');
 
         } else {
@@ -219,83 +316,99 @@ Board board_utils::fen_to_board(const std::string_view & fen) {
             return Board::empty();
         }
     }
-    
-    /* now use the remaining words to get the config info */
-    
+
+    /* now use the remaining fields to get the config info */
+
     // whose turn
-    b.set_white(get_word(stream) == "w");
-    
+    b.set_white(next_field(fen, i) == "w");
+
     // castling rights
-    string castle = get_word(stream);
-    b.set_cas_ws(castle.find('K') != string::npos);
-    b.set_cas_wl(castle.find('Q') != string::npos);
-    b.set_cas_bs(castle.find('k') != string::npos);
-    b.set_cas_bl(castle.find('q') != string::npos);
+    const std::string_view castle = next_field(fen, i);
+    b.set_cas_ws(castle.find('K') != std::string_view::npos);
+    b.set_cas_wl(castle.find('Q') != std::string_view::npos);
+    b.set_cas_bs(castle.find('k') != std::string_view::npos);
+    b.set_cas_bl(castle.find('q') != std::string_view::npos);
 
     // en passant
-    string ep = get_word(stream);
-    if (ep == "-") {
-        b.set_ep_exists(false);
-    } else {
+    const std::string_view ep = next_field(fen, i);
+    if (!ep.empty() && ep[0] >= 'a' && ep[0] <= 'h') {
         b.set_ep_exists(true);
-        b.set_ep_file(get_x(stosq(ep)));
+        b.set_ep_file(ep[0] - 'a');
+    } else {
+        b.set_ep_exists(false);
     }
 
     // half and whole moves
-    b.set_halfmoves(get_number(stream));
-    b.set_wholemoves(get_number(stream));
-    
+    b.set_halfmoves(parse_number(next_field(fen, i)));
+    b.set_wholemoves(parse_number(next_field(fen, i)));
+
     return b;
 }
 
-string board_utils::board_to_fen(const Board & b) {
-    
-    stringstream ss;
+size_t board_utils::write_fen(const Board & b, char * buf) {
+
+    char * out = buf;
 
-    // Build arrangement string
+    // arrangement
     for (int y = 7; y >= 0; --y) {
         int spaces = 0;
         for (int x = 0; x < 8; ++x) {
-            char piece = ptoc(b.get(mksq(x, y)));
-            if (piece == '.') {
+            const Piece p = b.get(x, y);
+            if (p == EMPTY) {
                 ++spaces;
-            } else if (spaces) {
-                ss << spaces << piece;
+                continue;
+            }
+            if (spaces) {
+                *out++ = (char) ('0' + spaces);
                 spaces = 0;
-            } else {
-                ss << piece;
             }
+            *out++ = ptoc(p);
+        }
+        if (spaces) {
+            *out++ = (char) ('0' + spaces);
+        }
+        if (y) {
+            *out++ = '/';
         }
-
-        if (spaces) 
-            ss << spaces;
-
-        if (y)
-            ss << "/";
     }
 
-    // Append turn
-    ss << " " << (b.get_white() ? "w" : "b");
+    // turn
+    *out++ = ' ';
+    *out++ = b.get_white() ? 'w' : 'b';
 
-    // Append castle rights
-    ss << " ";
-    ss << (b.get_cas_ws() ? "K" : "");
-    ss << (b.get_cas_wl() ? "Q" : "");
-    ss << (b.get_cas_bs() ? "k" : "");
-    ss << (b.get_cas_bl() ? "q" : "");
-    
+    // castle rights
+    *out++ = ' ';
+    if (b.get_cas_ws()) { *out++ = 'K'; }
+    if (b.get_cas_wl()) { *out++ = 'Q'; }
+    if (b.get_cas_bs()) { *out++ = 'k'; }
+    if (b.get_cas_bl()) { *out++ = 'q'; }
     if (!(b.get_cas_ws() | b.get_cas_wl() | b.get_cas_bs() | b.get_cas_bl())) {
-        ss << "-";
+        *out++ = '-';
+    }
+
+    // en passant
+    *out++ = ' ';
+    if (b.get_ep_exists()) {
+        const Square ep = b.get_ep_sq();
+        *out++ = (char) ('a' + ep.x);
+        *out++ = (char) ('1' + ep.y);
+    } else {
+        *out++ = '-';
     }
 
-    // Append enpassant
-    string enstr = sqtos(b.get_ep_sq());
-    ss << " " << (!b.get_ep_exists() ? "-" : enstr);
+    // half and full moves
+    *out++ = ' ';
+    out = write_number(out, b.get_halfmoves());
+    *out++ = ' ';
+    out = write_number(out, b.get_wholemoves());
 
-    // Append half and full moves
-    ss << " " << b.get_halfmoves() << " " << b.get_wholemoves();
+    *out = '\0';
+    return out - buf;
+}
 
-    return ss.str();
+string board_utils::board_to_fen(const Board & b) {
+    char buf[MAX_FEN_LENGTH];
+    return string(buf, board_utils::write_fen(b, buf));
 }
 
 /*************************************************************************************
@@ -7,6 +7,8 @@ using std::cout;
 
 #include "board.h"
 #include "board.hpp"
+#include "attacks.h"
+#include "move_gen.h"
 
 /*
  * Defines a move data type and defines functions to make moves
@@ -15,8 +17,10 @@ using std::cout;
 
 /*
  * Layout is this:
- * from (8 bits)
- * to (8 bits)
+ * squares (16 bits):
+ *  - bit 0-6:      from
+ *  - bit 7-13:     to
+ *  - bit 14-15:    unused
  * flags (16 bits):
  *  - bit 0-1:      promotion piece
  *  - bit 2:        is_prom
@@ -101,7 +105,7 @@ void Move::set_cas_short() { flags |= CAS_SHORT_FLAG; }
 void Move::unset_cas_short() { flags &= ~CAS_SHORT_FLAG; }
 
 // convenience: get the ep-file
-int Move::get_ep_file() const { return get_x(to); }
+int Move::get_ep_file() const { return get_x(to()); }
 
 /* get/set promotion piece */
 Byte Move::get_prom_shift() const { 
@@ -145,57 +149,52 @@ void Move::inc_score(int inc) {
  *  VECTOR piece move functions
  ************************************************************************/
 
-void line_search(const Board & b, const Square s,
-                    Delta d,
-                    ptr_vec<Move> & moves) {
+/**
+ * Adds a move to each square of the attack set lying along the given direction, unless it is
+ * occupied by a piece of the mover's own colour. Moves are added working outwards from the
+ * piece, as responders which cap the moves per direction rely on this order.
+ */
+void ray_moves(const Board & b, const Square s, const Bitboard attacks, const Delta d, ptr_vec<Move> & moves) {
 
-    Piece p = b.get(s);
-    Square temp = s;
-    bool cont = true;
+    Bitboard targets = attacks & ray_bb(s, d) & ~b.occupied(colour(b.get(s)));
+    bool increasing = d.dx + 8 * d.dy > 0;
     Move m = empty_move();
-    m.from = s;
-    
-    temp.x += d.dx;
-    temp.y += d.dy;
-
-    while (val(temp) && cont) {
-        //cout << sqtos(temp);
-        Piece otherp = b.get(temp);
-        if (otherp == EMPTY) {
-            //cout << "e ";
-            m.to = temp;
-            moves.push(m);
+    m.set_from(s);
+
+    while (targets) {
+        if (increasing) {
+            m.set_to(pop_lsb(targets));
         } else {
-            cont = false;
-            if (colour(otherp) != colour(p)) {
-                //cout << sqtos(temp) << "x ";
-                m.to = temp;
-                m.set_cap();
-                m.set_cap_piece(otherp);
-                moves.push(m);
-            }
+            m.set_to(index_sq(63 - std::countl_zero(targets)));
+            targets &= ~sq_bb(m.to());
+        }
+        m.flags = 0;
+        Piece otherp = b.get(m.to());
+        if (otherp != EMPTY) {
+            m.set_cap();
+            m.set_cap_piece(otherp);
         }
-        temp.x += d.dx;
-        temp.y += d.dy;
+        moves.push(m);
     }
-
 }
 
 void ortho(const Board & b, const Square start_sq, ptr_vec<Move> & moves) {
 
-    line_search(b, start_sq, Delta{1, 0}, moves);
-    line_search(b, start_sq, Delta{-1, 0},moves);
-    line_search(b, start_sq, Delta{0, 1}, moves);
-    line_search(b, start_sq, Delta{0, -1}, moves);
+    const Bitboard attacks = rook_attacks(start_sq, b.occupied());
+    ray_moves(b, start_sq, attacks, Delta{1, 0}, moves);
+    ray_moves(b, start_sq, attacks, Delta{-1, 0}, moves);
+    ray_moves(b, start_sq, attacks, Delta{0, 1}, moves);
+    ray_moves(b, start_sq, attacks, Delta{0, -1}, moves);
 
 }
 
 void diag(const Board & b, const Square start_sq, ptr_vec<Move> & moves) {
 
-    line_search(b, start_sq, Delta{1, 1}, moves);
-    line_search(b, start_sq, Delta{-1, -1}, moves);
-    line_search(b, start_sq, Delta{1, -1}, moves);
-    line_search(b, start_sq, Delta{-1, 1}, moves);
+    const Bitboard attacks = bishop_attacks(start_sq, b.occupied());
+    ray_moves(b, start_sq, attacks, Delta{1, 1}, moves);
+    ray_moves(b, start_sq, attacks, Delta{-1, -1}, moves);
+    ray_moves(b, start_sq, attacks, Delta{1, -1}, moves);
+    ray_moves(b, start_sq, attacks, Delta{-1, 1}, moves);
 
 }
 
@@ -219,95 +218,26 @@ void knight_moves(const Board & b, const Square s, ptr_vec<Move> & moves) {
 }
 
 // checks the kings castling squares are empty and check-free: nothing more
-bool castle_checks(Board b, const Colour col, const bool kingside) {
-    
-    Square s1{}, s2{}, s3{}, s4{}; // intermediate squares
-    Square k_sq = (col == WHITE) ? stosq("e1") : stosq("e8");
+bool castle_checks(const Board & b, const Colour col, const bool kingside) {
 
-    if (col == WHITE && kingside) {
-        
-        s1 = stosq("f1");
-        s2 = stosq("g1");
-        s3 = stosq("h1");
-        
-        if (b.get(s1) == EMPTY && b.get(s2) == EMPTY && b.get(s3) == W_ROOK) {
-            
-            b.set(k_sq, EMPTY);
-            b.set(s1, W_KING);
-            
-            if (!game_rules::in_check(b, WHITE)) {
-                b.set(s1, EMPTY);
-                b.set(s2, W_KING);
-                
-                return !game_rules::in_check(b, WHITE);
-            }
-            
-        }           
-        
-    } else if (col == WHITE && !kingside) {
+    const int y = (col == WHITE) ? 0 : 7;
+    const Piece rook = mkpiece(col, ROOK);
+    const Colour enemy = opposite_colour(col);
 
-        s1 = stosq("d1");
-        s2 = stosq("c1");
-        s3 = stosq("b1");
-        s4 = stosq("a1");
+    // the squares between king and rook must be empty, the king's path must not be attacked
+    const Bitboard between = kingside
+        ? sq_bb(5, y) | sq_bb(6, y)
+        : sq_bb(1, y) | sq_bb(2, y) | sq_bb(3, y);
+    const Square s1 = kingside ? mksq(5, y) : mksq(3, y);
+    const Square s2 = kingside ? mksq(6, y) : mksq(2, y);
 
-        if (b.get(s1) == EMPTY && b.get(s2) == EMPTY && b.get(s3) == EMPTY && b.get(s4) == W_ROOK) {
-            
-            b.set(k_sq, EMPTY);
-            b.set(s1, W_KING);
-            
-            if (!game_rules::in_check(b, WHITE)) {
-                b.set(s1, EMPTY);
-                b.set(s2, W_KING);
-                
-                return !game_rules::in_check(b, WHITE);
-            }
-            
-        }   
-                
-    } else if (col == BLACK && kingside) {
-
-        s1 = stosq("f8");
-        s2 = stosq("g8");
-        s3 = stosq("h8");
-
-        if (b.get(s1) == EMPTY && b.get(s2) == EMPTY && b.get(s3) == B_ROOK) {
-            
-            b.set(k_sq, EMPTY);
-            b.set(s1, B_KING);
-            
-            if (!game_rules::in_check(b, BLACK)) {
-                b.set(s1, EMPTY);
-                b.set(s2, B_KING);
-                
-                return !game_rules::in_check(b, BLACK);
-            }
-            
-        }
-                  
-    } else { // BLACK and !kingside
-
-        s1 = stosq("d8");
-        s2 = stosq("c8");
-        s3 = stosq("b8");
-        s4 = stosq("a8");
-
-        if (b.get(s1) == EMPTY && b.get(s2) == EMPTY && b.get(s3) == EMPTY && b.get(s4) == B_ROOK) {
-
-            b.set(k_sq, EMPTY);
-            b.set(s1, B_KING);
-
-            if (!game_rules::in_check(b, BLACK)) {
-                b.set(s1, EMPTY);
-                b.set(s2, B_KING);
-
-                return !game_rules::in_check(b, BLACK);
-            }
-            
-        }
+    if ((b.occupied() & between) || b.get(kingside ? 7 : 0, y) != rook) {
+        return false;
     }
 
-    return false;
+    // look through the king, as the original square will be empty once it moves
+    const Bitboard occ = b.occupied() & ~sq_bb(4, y);
+    return !game_rules::attackers(b, s1, enemy, occ) && !game_rules::attackers(b, s2, enemy, occ);
 }
 
 void king_moves(const Board & b, const Square s, ptr_vec<Move> & moves) {
@@ -316,7 +246,7 @@ void king_moves(const Board & b, const Square s, ptr_vec<Move> & moves) {
     Square temp{};
 
     // check castle for white
-    if (kingcol == WHITE && !game_rules::in_check(b, WHITE)) {
+    if (kingcol == WHITE && !game_rules::in_check(b, WHITE, s)) {
         
         if (b.get_cas_ws() && castle_checks(b, WHITE, true)) {
             Move m{s, stosq("g1"), 0};
@@ -333,7 +263,7 @@ void king_moves(const Board & b, const Square s, ptr_vec<Move> & moves) {
         }
     
     // and for black
-    } else if (kingcol == BLACK && !game_rules::in_check(b, BLACK)) {
+    } else if (kingcol == BLACK && !game_rules::in_check(b, BLACK, s)) {
 
         if (b.get_cas_bs() && castle_checks(b, BLACK, true)) {
             Move m{s, stosq("g8"), 0};
@@ -373,7 +303,7 @@ void pawn_moves(const Board & b, const Square s, ptr_vec<Move> & moves) {
     Square sq{};
     
     Move m = empty_move();
-    m.from = s;
+    m.set_from(s);
     
     int FORWARD;
     int START_RANK;
@@ -392,7 +322,7 @@ void pawn_moves(const Board & b, const Square s, ptr_vec<Move> & moves) {
     // forward moves
     if (val(sq = mksq(x, y + FORWARD)) && b.get(sq) == EMPTY) {
         
-        m.to = sq;
+        m.set_to(sq);
         
         // final rank: promotion
         if (get_y(sq) == 0 || get_y(sq) == 7) {
@@ -411,7 +341,7 @@ void pawn_moves(const Board & b, const Square s, ptr_vec<Move> & moves) {
         
         // starting rank: double move
         if (y == START_RANK && b.get(sq = mksq(x, y + FORWARD + FORWARD)) == EMPTY) {
-            m.to = sq;
+            m.set_to(sq);
             moves.push(m);
         } 
         
@@ -419,7 +349,7 @@ void pawn_moves(const Board & b, const Square s, ptr_vec<Move> & moves) {
     
     // regular captures
     if (val(sq = mksq(x - 1, y + FORWARD)) && colour(b.get(sq)) == capture_colour) {
-        m.to = sq;
+        m.set_to(sq);
         m.set_cap();
         m.set_cap_piece(b.get(sq));
         // final rank: promotion
@@ -437,7 +367,7 @@ void pawn_moves(const Board & b, const Square s, ptr_vec<Move> & moves) {
         moves.push(m);
     }
     if (val(sq = mksq(x + 1, y + FORWARD)) && colour(b.get(sq)) == capture_colour) {
-        m.to = sq;
+        m.set_to(sq);
         m.set_cap();
         m.set_cap_piece(b.get(sq));
         // final rank: promotion
@@ -459,7 +389,7 @@ void pawn_moves(const Board & b, const Square s, ptr_vec<Move> & moves) {
     if (b.get_ep_exists() && y == START_RANK + 3*FORWARD) {
         int epfile = b.get_ep_file();
         if (epfile == x + 1 || epfile == x - 1) {
-            m.to = mksq(epfile, y + FORWARD);
+            m.set_to(mksq(epfile, y + FORWARD));
             m.set_cap();
             m.set_cap_piece((pawn_colour == WHITE) ? B_PAWN : W_PAWN);
             m.set_ep();
@@ -510,20 +440,20 @@ void game_rules::piecemoves_ignore_check(const Board & b, const Square s, ptr_ve
  *  In check functions
  ************************************************************************/
 
-bool line_search_check(const Board & b, Square sq, const Piece p1, const Piece p2, Delta d) {
-                                
-    sq.x += d.dx;
-    sq.y += d.dy;
+Bitboard game_rules::attackers(const Board & b, const Square s, const Colour by, const Bitboard occ) {
 
-    while (val(sq)) {
-        Piece otherp = b.get(sq);
-        if (otherp != EMPTY) {
-            return otherp == p1 || otherp == p2;
-        }
-        sq.x += d.dx;
-        sq.y += d.dy;
-    }
-    return false;
+    const Bitboard queens = b.pieces(by, QUEEN);
+
+    // a pawn of the other colour on s would attack exactly the squares our pawns attack s from
+    return (pawn_attacks(opposite_colour(by), s) & b.pieces(by, PAWN))
+        | (knight_attacks(s) & b.pieces(by, KNIGHT))
+        | (king_attacks(s) & b.pieces(by, KING))
+        | (bishop_attacks(s, occ) & (b.pieces(by, BISHOP) | queens))
+        | (rook_attacks(s, occ) & (b.pieces(by, ROOK) | queens));
+}
+
+Bitboard game_rules::attackers(const Board & b, const Square s, const Colour by) {
+    return game_rules::attackers(b, s, by, b.occupied());
 }
 
 /**
@@ -532,81 +462,15 @@ bool line_search_check(const Board & b, Square sq, const Piece p1, const Piece p
  */
 bool game_rules::in_check(const Board & b, Colour c) {
 
-    Square temp{};
-    bool white = (c == WHITE);
-    Piece king = (white) ? W_KING : B_KING;
-    Square ksq{0, 0};
-    int king_x = 0, king_y = 0;
-    bool king_found = false;
-
-    // find king square
-    for (int i = 0; i < 8; ++i) {
-        for (int j = 0; j < 8; ++j) {
-            if (b.get(mksq(i, j)) == king) {
-                king_found = true;
-                ksq = mksq(i, j);
-                king_x = i;
-                king_y = j;
-            }
-        }
-    }
-
-    if (!king_found) { return false; }
-
-    // check pawns
-    if (white) {
-        if (king_x > 0 && king_y < 7 && b.get(mksq(king_x - 1, king_y + 1)) == B_PAWN) { return true; }
-        if (king_x < 7 && king_y < 7 && b.get(mksq(king_x + 1, king_y + 1)) == B_PAWN) { return true; }
-    } else {
-        if (king_x > 0 && king_y > 0 && b.get(mksq(king_x - 1, king_y - 1)) == W_PAWN) { return true; }
-        if (king_x < 7 && king_y > 0 && b.get(mksq(king_x + 1, king_y - 1)) == W_PAWN) { return true; }
-    }
+    const Square king = b.king_square(c);
+    if (is_sentinel(king)) { return false; }
 
-    // check knight
-    Piece enemy_knight = white ? B_KNIGHT : W_KNIGHT;
-    for (int i = 0; i < 8; ++i) {
-        if (val(temp = mksq(king_x + XKN[i], king_y + YKN[i])) && b.get(temp) == enemy_knight) {
-            return true;
-        }
-    }
-
-    // check king (daft but thorough - stops legal_moves letting kings move next to each other)
-    Piece enemy_king = white ? B_KING : W_KING;
-    for (int i = 0; i < 8; ++i) {
-        if (val(temp = mksq(king_x + XD[i], king_y + YD[i])) && b.get(temp) == enemy_king){
-            return true;
-        }
-    }
+    return game_rules::in_check(b, c, king);
+}
 
-    // search out from king
-    Piece queen, bishop, rook;
-    if (white) {
-        queen = B_QUEEN;
-        rook = B_ROOK;
-        bishop = B_BISHOP;
-    } else {
-        queen = W_QUEEN;
-        rook = W_ROOK;
-        bishop = W_BISHOP;
-    }
-    
-    // diagonal: bishop or queen
-    if (line_search_check(b, ksq, bishop, queen, Delta{1, 1})
-         || line_search_check(b, ksq, bishop, queen, Delta{1, -1})
-         || line_search_check(b, ksq, bishop, queen, Delta{-1, 1})
-         || line_search_check(b, ksq, bishop, queen, Delta{-1, -1})) {
-        return true;    
-    }
-            
-    // orthogonal: rook or queen
-    if (line_search_check(b, ksq, queen, rook, Delta{1, 0})
-         || line_search_check(b, ksq, queen, rook, Delta{-1, 0})
-         || line_search_check(b, ksq, queen, rook, Delta{0, 1})
-         || line_search_check(b, ksq, queen, rook, Delta{0, -1})) {
-        return true;
-    }
-    
-    return false;
+bool game_rules::in_check(const Board & b, const Colour c, const Square king) {
+    // kings are included (daft but thorough - stops legal_moves letting kings move next to each other)
+    return game_rules::attackers(b, king, opposite_colour(c)) != EMPTY_BB;
 }
 
 bool game_rules::in_check(const Board & b) {
@@ -617,45 +481,46 @@ bool game_rules::in_check(const Board & b) {
  *  Legal move functions
  ************************************************************************/
 
-void game_rules::legal_moves(const Board & b, vector<Move> & moves) {
-    
-    Colour col = b.get_white() ? WHITE : BLACK;
-    
-    // get moves for every piece on the board
-    for (int x = 0; x < 8; ++x) {
-        for (int y = 0; y < 8; ++y) {
-            Move piece_moves_arr[32];
-            ptr_vec<Move> piece_moves(piece_moves_arr, 32);
-            Square sq = mksq(x, y);
-            if (colour(b.get(sq)) == col) {
-                game_rules::piecemoves_ignore_check(b, sq, piece_moves);
-            }
-            for (int j = 0; j < piece_moves.size(); ++j) {
-                moves.push_back(piece_moves[j]);
-            }
-        }
-    }
+/**
+ * Generates the pseudo-legal moves for each piece, and keeps only those which are legal.
+ * Checkers and pins are worked out once per position (see CheckInfo), and no move is
+ * actually made.
+ */
+void game_rules::legal_moves(const Board & b, ptr_vec<Move> & moves) {
 
-    // for each, check whether it leaves us in check
-    auto itr = moves.begin();
-    Move m{};
+    const CheckInfo info(b);
+    Bitboard own_pieces = b.occupied(info.col);
 
-    while (itr != moves.end()) {
-        m = *itr;
-        Board local = b;
-        local.mutate_hard(m);
-        if (game_rules::in_check(local)) {
-            itr = moves.erase(itr);
-        } else {
-            itr++;
+    Move piece_moves_arr[32];
+
+    while (own_pieces) {
+
+        const Square s = pop_lsb(own_pieces);
+        const bool is_king = info.has_king() && equal(s, info.ksq);
+        const Bitboard allowed = is_king ? FULL_BB : info.allowed(s);
+        if (!allowed) { continue; }
+
+        ptr_vec<Move> piece_moves(piece_moves_arr, 32);
+        game_rules::piecemoves_ignore_check(b, s, piece_moves);
+
+        for (int j = 0; j < piece_moves.size(); ++j) {
+            if (info.is_legal(b, piece_moves[j], allowed)) {
+                moves.push(piece_moves[j]);
+            }
         }
     }
 }
 
+void game_rules::legal_moves(const Board & b, vector<Move> & moves) {
+    Move moves_arr[MAX_LEGAL_MOVES];
+    ptr_vec<Move> legal(moves_arr, MAX_LEGAL_MOVES);
+    game_rules::legal_moves(b, legal);
+    moves.insert(moves.end(), moves_arr, moves_arr + legal.size());
+}
+
 vector<Move> game_rules::legal_moves(const Board & b) {
     vector<Move> moves;
     moves.reserve(32);
     game_rules::legal_moves(b, moves);
     return moves;
 }
-
@@ -9,12 +9,33 @@
  * There are also some flags, which represent information about that move,
  * along with appropriate accessors and mutators (since the flags are bit
  * hacks, this saves a lot of trouble).
+ *
+ * The whole move is packed into 32 bits, so that move lists and candidate
+ * sets take as little room as possible. Each square is stored as its 7-bit
+ * index (x + 8y, or 127 for SQUARE_SENTINEL), and read back through from()
+ * and to().
  */
 struct Move {
 
-    Square from;
-    Square to;
-    uint_fast16_t flags;
+    uint16_t squares;
+    uint16_t flags;
+
+    Move() = default;
+    constexpr Move(const Square from, const Square to, const uint16_t flags = 0)
+            : squares(pack(from) | (pack(to) << TO_SHIFT)), flags(flags) {}
+
+    constexpr Square from() const { return unpack(squares & SQUARE_MASK); }
+    constexpr Square to() const { return unpack(squares >> TO_SHIFT); }
+
+    /**
+     * The squares' indices (x + 8y), read without the sentinel check of from() and to(): for code which
+     * plays a move on the board, and so never sees the sentinel.
+     */
+    constexpr int from_index() const { return squares & SQUARE_MASK; }
+    constexpr int to_index() const { return squares >> TO_SHIFT; }
+
+    constexpr void set_from(const Square s) { squares = (squares & ~SQUARE_MASK) | pack(s); }
+    constexpr void set_to(const Square s) { squares = (squares & SQUARE_MASK) | (pack(s) << TO_SHIFT); }
 
     bool is_prom() const;
     void set_prom();
@@ -48,8 +69,20 @@ struct Move {
     void set_score(int);
     void inc_score(int);
 
+private:
+    static constexpr int TO_SHIFT = 7;
+    static constexpr uint16_t SQUARE_MASK = 0x7F;
+
+    static constexpr uint16_t pack(const Square s) {
+        return (s.x == 0xFF || s.y == 0xFF) ? SQUARE_MASK : (uint16_t) sq_index(s);
+    }
+    static constexpr Square unpack(const unsigned i) {
+        return (i == SQUARE_MASK) ? SQUARE_SENTINEL : index_sq((int) i);
+    }
 };
 
+static_assert(sizeof(Move) == 4, "moves should pack into 32 bits");
+
 /**
  * Some basic special values and utility functions.
  */
@@ -57,18 +90,18 @@ struct Move {
 const Move MOVE_SENTINEL = Move{SQUARE_SENTINEL, SQUARE_SENTINEL, 0};
 
 constexpr Move empty_move() {
-    return Move{{0, 0}, {0, 0}, 0};
+    return Move{Square{0, 0}, Square{0, 0}, 0};
 }
 
 inline bool is_sentinel(const Move m) {
-    return equal(m.from, SQUARE_SENTINEL);
+    return is_sentinel(m.from());
 }
 
 /**
  * Returns true iff the two moves start from and end at the same squares.
  */
 inline bool equal(const Move m1, const Move m2) {
-    return equal(m1.from, m2.from) && equal(m1.to, m2.to);
+    return m1.squares == m2.squares;
 }
 
 /**
@@ -154,4 +187,16 @@ struct Board;
 Move stom(const Board &, const std::string &);
 std::string mtos(const Board &, Move);
 
+/**
+ * Converts each of the moves, all of which must be playable on the given board, to SAN.
+ * The SAN is appended to the given vector.
+ */
+void mtos(const Board &, const std::vector<Move> &, std::vector<std::string> &);
+
+/**
+ * Converts a line of moves, played one after another from the given board, to SAN separated
+ * by spaces. The moves are made on a single copy of the board.
+ */
+std::string mtos_line(const Board &, const std::vector<Move> &);
+
 #endif //STASE_MOVE_H
@@ -0,0 +1,268 @@
+#include "board.h"
+#include "board.hpp"
+#include "move_gen.h"
+
+/*************************************************************************
+ *  Checks and pins
+ ************************************************************************/
+
+/**
+ * @return the pieces of the given colour which are pinned to their king on the given square
+ */
+Bitboard pinned_pieces(const Board & b, const Square ksq, const Colour col) {
+
+    const Colour enemy = opposite_colour(col);
+    const Bitboard enemy_occ = b.occupied(enemy);
+    const Bitboard queens = b.pieces(enemy, QUEEN);
+
+    // enemy sliders which would attack the king if none of our pieces were in the way
+    Bitboard snipers = (rook_attacks(ksq, enemy_occ) & (b.pieces(enemy, ROOK) | queens))
+                       | (bishop_attacks(ksq, enemy_occ) & (b.pieces(enemy, BISHOP) | queens));
+    Bitboard pinned = EMPTY_BB;
+
+    while (snipers) {
+        const Square sniper = pop_lsb(snipers);
+        const Delta d = get_delta_between(ksq, sniper);
+        const Bitboard blockers = ray_bb(ksq, d) & ~ray_bb(sniper, d) & ~sq_bb(sniper) & b.occupied();
+        if (!more_than_one(blockers)) {
+            pinned |= blockers & b.occupied(col);
+        }
+    }
+
+    return pinned;
+}
+
+/**
+ * @return the squares a piece other than the king may move to in order to answer the check
+ * given by the checker: capturing it or, for sliders, blocking the line.
+ */
+Bitboard block_or_capture_mask(const Board & b, const Square ksq, const Square checker) {
+    const Ptype t = type(b.get(checker));
+    if (t == PAWN || t == KNIGHT) {
+        return sq_bb(checker);
+    }
+    const Delta d = get_delta_between(ksq, checker);
+    return ray_bb(ksq, d) & ~ray_bb(checker, d);
+}
+
+CheckInfo::CheckInfo(const Board & b)
+        : col(b.colour_to_move()),
+          enemy(opposite_colour(col)),
+          ksq(b.king_square(col)),
+          checkers(EMPTY_BB),
+          pinned(EMPTY_BB),
+          check_mask(FULL_BB),
+          occ_without_king(b.occupied())
+{
+    // without a king, nothing can be illegal
+    if (!has_king()) { return; }
+
+    checkers = game_rules::attackers(b, ksq, enemy);
+    pinned = pinned_pieces(b, ksq, col);
+    occ_without_king &= ~sq_bb(ksq);
+
+    // in double check only the king may move
+    if (more_than_one(checkers)) {
+        check_mask = EMPTY_BB;
+    } else if (checkers) {
+        check_mask = block_or_capture_mask(b, ksq, lsb_sq(checkers));
+    }
+}
+
+/**
+ * King moves are tested with the king lifted off the board, so it cannot hide from a slider
+ * along its own line. En-passant captures can uncover a check along the rank in ways a pin
+ * mask cannot see, so they are tested against the enemy's attacks with both pawns moved.
+ */
+bool CheckInfo::is_legal(const Board & b, const Move m, const Bitboard allowed) const {
+
+    if (!has_king()) { return true; }
+
+    if (equal(m.from(), ksq)) {
+        // castling moves have already been checked by castle_checks
+        return m.is_cas() || !game_rules::attackers(b, m.to(), enemy, occ_without_king);
+    }
+    if (m.is_ep()) {
+        const Bitboard captured = sq_bb(m.to().x, m.from().y);
+        const Bitboard occ = (b.occupied() ^ sq_bb(m.from()) ^ captured) | sq_bb(m.to());
+        return !(game_rules::attackers(b, ksq, enemy, occ) & ~captured);
+    }
+    return contains(allowed, m.to());
+}
+
+/*************************************************************************
+ *  Staged generation
+ ************************************************************************/
+
+namespace {
+
+    /** Piece values for MVV-LVA ordering only. The king is never a victim. */
+    inline int order_value(const Piece p) {
+        switch (type(p)) {
+            case PAWN: return 1;
+            case KNIGHT: return 3;
+            case BISHOP: return 3;
+            case ROOK: return 5;
+            case QUEEN: return 9;
+            default: return 0;
+        }
+    }
+
+    /**
+     * Most valuable victim first, then least valuable attacker; promoting captures rank by
+     * the piece promoted to as well.
+     */
+    inline int mvv_lva(const Board & b, const Move m) {
+        const Piece attacker = b.get(m.from());
+        int score = 16 * order_value(m.get_cap_piece()) - order_value(attacker);
+        if (m.is_prom()) {
+            score += 16 * order_value(m.get_prom_piece(colour(attacker)));
+        }
+        return score;
+    }
+
+    /**
+     * @return the squares the piece on the given square attacks, or for a pawn the squares it
+     * could capture on. A piece which attacks no enemy piece cannot capture anything.
+     */
+    inline Bitboard capture_targets(const Board & b, const Square s) {
+        const Piece p = b.get(s);
+        switch (type(p)) {
+            case PAWN: return pawn_attacks(colour(p), s);
+            case KNIGHT: return knight_attacks(s);
+            case BISHOP: return bishop_attacks(s, b.occupied());
+            case ROOK: return rook_attacks(s, b.occupied());
+            case QUEEN: return queen_attacks(s, b.occupied());
+            case KING: return king_attacks(s);
+            default: return EMPTY_BB;
+        }
+    }
+}
+
+MoveGen::MoveGen(const Board & b) : b(b), info(b), current(GEN_CAPTURES), size(0), idx(0) {
+    generate(GEN_CAPTURES);
+}
+
+bool MoveGen::next(Move & m) {
+    while (idx == size) {
+        if (current == GEN_DONE) { return false; }
+        current = (GenStage) (current + 1);
+        if (current == GEN_DONE) { return false; }
+        generate(current);
+    }
+    m = moves_arr[idx++];
+    return true;
+}
+
+void MoveGen::generate(const GenStage stage) {
+
+    size = 0;
+    idx = 0;
+    if (stage == GEN_DONE) { return; }
+
+    Bitboard pieces = b.occupied(info.col);
+
+    switch (stage) {
+        case GEN_CAPTURES: {
+            Bitboard victims = b.occupied(info.enemy);
+            if (b.get_ep_exists()) { victims |= sq_bb(b.get_ep_sq()); }
+            Bitboard with_targets = EMPTY_BB;
+            for (Bitboard bb = pieces; bb; ) {
+                const Square s = pop_lsb(bb);
+                if (capture_targets(b, s) & victims) { with_targets |= sq_bb(s); }
+            }
+            pieces = with_targets;
+            break;
+        }
+        case GEN_PROMOTIONS:
+            pieces = b.pieces(info.col, PAWN) & rank_bb(info.col == WHITE ? 6 : 1);
+            break;
+        case GEN_CASTLING:
+            if (!info.has_king() || info.checkers) { return; }
+            pieces = sq_bb(info.ksq);
+            break;
+        default:
+            break;
+    }
+
+    Move piece_moves_arr[32];
+
+    while (pieces) {
+
+        const Square s = pop_lsb(pieces);
+        const bool is_king = info.has_king() && equal(s, info.ksq);
+        const Bitboard allowed = is_king ? FULL_BB : info.allowed(s);
+        if (!allowed) { continue; }
+
+        ptr_vec<Move> piece_moves(piece_moves_arr, 32);
+        game_rules::piecemoves_ignore_check(b, s, piece_moves);
+
+        for (int j = 0; j < piece_moves.size(); ++j) {
+            const Move m = piece_moves[j];
+
+            bool wanted;
+            switch (stage) {
+                case GEN_CAPTURES: wanted = m.is_cap(); break;
+                case GEN_PROMOTIONS: wanted = m.is_prom() && !m.is_cap(); break;
+                case GEN_CASTLING: wanted = m.is_cas(); break;
+                default: wanted = !m.is_cap() && !m.is_prom() && !m.is_cas(); break;
+            }
+
+            if (wanted && info.is_legal(b, m, allowed)) {
+                moves_arr[size++] = m;
+            }
+        }
+    }
+
+    // insertion sort: the lists are short, and this keeps equal captures in generation order
+    if (stage == GEN_CAPTURES) {
+        int scores[MAX_LEGAL_MOVES];
+        for (int i = 0; i < size; ++i) {
+            scores[i] = mvv_lva(b, moves_arr[i]);
+        }
+        for (int i = 1; i < size; ++i) {
+            const Move m = moves_arr[i];
+            const int score = scores[i];
+            int j = i - 1;
+            for (; j >= 0 && scores[j] < score; --j) {
+                moves_arr[j + 1] = moves_arr[j];
+                scores[j + 1] = scores[j];
+            }
+            moves_arr[j + 1] = m;
+            scores[j + 1] = score;
+        }
+    }
+}
+
+bool game_rules::has_any_legal_move(const Board & b) {
+
+    const CheckInfo info(b);
+    Bitboard own_pieces = b.occupied(info.col);
+
+    // the king is the only piece which can move in double check, and often the only one in check
+    if (info.has_king()) {
+        own_pieces &= ~sq_bb(info.ksq);
+        Move king_moves_arr[32];
+        ptr_vec<Move> king_moves(king_moves_arr, 32);
+        game_rules::piecemoves_ignore_check(b, info.ksq, king_moves);
+        for (int j = 0; j < king_moves.size(); ++j) {
+            if (info.is_legal(b, king_moves[j], FULL_BB)) { return true; }
+        }
+        if (info.check_mask == EMPTY_BB) { return false; }
+    }
+
+    Move piece_moves_arr[32];
+
+    while (own_pieces) {
+        const Square s = pop_lsb(own_pieces);
+        const Bitboard allowed = info.allowed(s);
+        if (!allowed) { continue; }
+
+        ptr_vec<Move> piece_moves(piece_moves_arr, 32);
+        game_rules::piecemoves_ignore_check(b, s, piece_moves);
+        for (int j = 0; j < piece_moves.size(); ++j) {
+            if (info.is_legal(b, piece_moves[j], allowed)) { return true; }
+        }
+    }
+    return false;
+}
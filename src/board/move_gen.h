@@ -0,0 +1,87 @@
+#ifndef STASE_MOVE_GEN_H
+#define STASE_MOVE_GEN_H
+
+#include "../../include/stase/board.h"
+#include "attacks.h"
+
+/*
+ * Staged move generation. Rather than building the whole list of legal moves up front, a
+ * MoveGen hands them out one at a time, in stages: captures first (most valuable victim,
+ * least valuable attacker), then quiet promotions, castling and finally the quiet moves.
+ * Each stage is only generated once the one before it has been used up, so a caller which
+ * stops early (after the captures, say) never pays for the rest.
+ */
+
+/**
+ * What a position's checks and pins allow, worked out once and then used to test each
+ * pseudo-legal move. A position without a king for the side to move allows everything.
+ */
+struct CheckInfo {
+
+    Colour col;
+    Colour enemy;
+    Square ksq;
+    Bitboard checkers;
+    Bitboard pinned;
+    Bitboard check_mask;
+    Bitboard occ_without_king;
+
+    explicit CheckInfo(const Board &);
+
+    inline bool has_king() const { return !is_sentinel(ksq); }
+
+    /**
+     * @return the squares the (non-king) piece on the given square may move to without
+     * leaving its king in check, ignoring en-passant.
+     */
+    inline Bitboard allowed(const Square s) const {
+        if (contains(pinned, s)) {
+            return check_mask & ray_bb(ksq, get_delta_between(ksq, s));
+        }
+        return check_mask;
+    }
+
+    /**
+     * @return true if the pseudo-legal move, made by a piece whose allowed squares are given,
+     * is legal.
+     */
+    bool is_legal(const Board &, Move, Bitboard allowed) const;
+};
+
+enum GenStage {
+    GEN_CAPTURES = 0,
+    GEN_PROMOTIONS = 1,
+    GEN_CASTLING = 2,
+    GEN_QUIETS = 3,
+    GEN_DONE = 4
+};
+
+class MoveGen {
+
+public:
+    explicit MoveGen(const Board &);
+
+    /**
+     * Writes the next legal move into the given move and returns true, or returns false once
+     * every stage has been used up.
+     */
+    bool next(Move &);
+
+    /**
+     * @return the stage the last move returned by next() came from. Callers which only want
+     * captures can stop as soon as this moves past GEN_CAPTURES.
+     */
+    inline GenStage stage() const { return current; }
+
+private:
+    void generate(GenStage);
+
+    const Board & b;
+    const CheckInfo info;
+    GenStage current;
+    Move moves_arr[MAX_LEGAL_MOVES];
+    int size;
+    int idx;
+};
+
+#endif //STASE_MOVE_GEN_H
@@ -0,0 +1,73 @@
+#ifndef STASE_ZOBRIST_H
+#define STASE_ZOBRIST_H
+
+#include <array>
+#include <cstdint>
+
+#include "bitboard.h"
+
+/*
+ * Zobrist keys. Each (piece, square) pair, each castling configuration, each en-passant file and
+ * the side to move is given a random 64-bit number, and a position's key is the xor of the
+ * numbers for everything true of it. Making a move then only needs the few numbers it changes
+ * to be xored in and out, so the Board keeps its key up to date as it goes.
+ *
+ * The numbers are generated at compile time, so the tables are usable from static initialisers
+ * and identical between builds.
+ */
+
+typedef uint64_t ZobristKey;
+
+namespace __zobrist {
+
+    /** splitmix64: small, fast and good enough for this. */
+    constexpr uint64_t splitmix64(uint64_t & state) {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    const int NUM_PIECE_KEYS = NUM_PIECE_BBS * 64;
+    const int NUM_CASTLING_KEYS = 16;
+    const int NUM_EP_KEYS = 8;
+
+    struct Keys {
+        ZobristKey pieces[NUM_PIECE_KEYS];
+        ZobristKey castling[NUM_CASTLING_KEYS];
+        ZobristKey ep_file[NUM_EP_KEYS];
+        ZobristKey white_to_move;
+    };
+
+    constexpr Keys generate_keys() {
+        Keys k{};
+        uint64_t state = 0x5374617365ull;
+
+        for (ZobristKey & key : k.pieces) { key = splitmix64(state); }
+        for (ZobristKey & key : k.ep_file) { key = splitmix64(state); }
+        k.white_to_move = splitmix64(state);
+
+        // castling rights are four independent bits, so each combination is the xor of its rights
+        ZobristKey rights[4]{};
+        for (ZobristKey & key : rights) { key = splitmix64(state); }
+        for (int i = 0; i < NUM_CASTLING_KEYS; ++i) {
+            k.castling[i] = 0;
+            for (int j = 0; j < 4; ++j) {
+                if (i & (1 << j)) { k.castling[i] ^= rights[j]; }
+            }
+        }
+
+        return k;
+    }
+
+    inline constexpr Keys KEYS = generate_keys();
+}
+
+/**
+ * @return the key for the given (non-empty) piece standing on the given square
+ */
+constexpr ZobristKey piece_key(const Piece p, const int x, const int y) {
+    return __zobrist::KEYS.pieces[bb_index(p) * 64 + x + 8 * y];
+}
+
+#endif //STASE_ZOBRIST_H
@@ -32,7 +32,10 @@ void discover_feature_frames(Gamestate & gs, const Hook & hook) {
  */
 CandSet * cands_in_check(const Gamestate & gs, CandSet * cand_set) {
     // currently, there is no special logic.
-    cand_set->critical = game_rules::legal_moves(gs.board);
+    Move legal_moves_arr[MAX_LEGAL_MOVES];
+    ptr_vec<Move> legal_moves(legal_moves_arr, MAX_LEGAL_MOVES);
+    game_rules::legal_moves(gs.board, legal_moves);
+    cand_set->critical.assign(legal_moves_arr, legal_moves_arr + legal_moves.size());
     return cand_set;
 }
 
@@ -131,7 +134,10 @@ CandSet * cands(Gamestate & gs, CandSet * cand_set) {
     }
 
     if (m == 0) {
-        cand_set->legal = game_rules::legal_moves(gs.board);
+        Move legal_moves_arr[MAX_LEGAL_MOVES];
+        ptr_vec<Move> legal_moves(legal_moves_arr, MAX_LEGAL_MOVES);
+        game_rules::legal_moves(gs.board, legal_moves);
+        cand_set->legal.assign(legal_moves_arr, legal_moves_arr + legal_moves.size());
     }
 
     return cand_set;
@@ -276,7 +282,10 @@ CandSet * cands_report(Gamestate & gs) {
     }
 
     if (m == 0) {
-        cand_set->legal = game_rules::legal_moves(gs.board);
+        Move legal_moves_arr[MAX_LEGAL_MOVES];
+        ptr_vec<Move> legal_moves(legal_moves_arr, MAX_LEGAL_MOVES);
+        game_rules::legal_moves(gs.board, legal_moves);
+        cand_set->legal.assign(legal_moves_arr, legal_moves_arr + legal_moves.size());
     }
 
     board_utils::print(gs.board);
@@ -286,29 +295,32 @@ CandSet * cands_report(Gamestate & gs) {
 
 }
 
+/**
+ * Prints the moves with their scores, converting them to SAN in one go.
+ */
+void print_moves(const Board & b, const std::pmr::vector<Move> & moves, bool scores, std::ostream & o) {
+    std::vector<std::string> sans;
+    mtos(b, std::vector<Move>(moves.begin(), moves.end()), sans);
+    for (int i = 0; i < moves.size(); ++i) {
+        o << std::setw(5) << sans[i];
+        if (scores) {
+            o << "[" << moves[i].get_score() << "] ";
+        }
+    }
+    o << "\n";
+}
+
 void print_cand_set(const Gamestate & gs, const CandSet & cand_set, std::ostream & o) {
     o << "Candidates generated:\n";
     o << std::setw(10) << "Critical: ";
-    for (const Move & move : cand_set.critical) {
-        o << std::setw(5) << mtos(gs.board, move) << "[" << move.get_score() << "] ";
-    }
-    o << "\n";
+    print_moves(gs.board, cand_set.critical, true, o);
 
     o << std::setw(10) << "Medial: ";
-    for (const Move & move : cand_set.medial) {
-        o <<  std::setw(5) << mtos(gs.board, move) << "[" << move.get_score() << "] ";
-    }
-    o << "\n";
+    print_moves(gs.board, cand_set.medial, true, o);
 
     o << std::setw(10) << "Final: ";
-    for (const Move & move : cand_set.final) {
-        o  << std::setw(5) << mtos(gs.board, move) << "[" << move.get_score() << "] ";
-    }
-    o << "\n";
+    print_moves(gs.board, cand_set.final, true, o);
 
     o << std::setw(10) << "Legal: ";
-    for (const Move & move : cand_set.legal) {
-        o << std::setw(5) << mtos(gs.board, move);
-    }
-    o << "\n";
+    print_moves(gs.board, cand_set.legal, false, o);
 }
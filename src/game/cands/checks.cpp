@@ -13,11 +13,11 @@ bool find_pawn_checks(Gamestate & gs, const Square s, const Square k_sq) {
     game_rules::piecemoves_ignore_check(gs.board, s, moves);
 
     for (int i = 0; i < moves.size(); ++i) {
-        if (equal(left_of_king, moves[i].to) || equal(right_of_king, moves[i].to)) {
+        if (equal(left_of_king, moves[i].to()) || equal(right_of_king, moves[i].to())) {
             bool result =
                 gs.add_frame(
                     check_hook.id,
-                    FeatureFrame{s, moves[i].to, 0, 0}
+                    FeatureFrame{s, moves[i].to(), 0, 0}
                 );
             if (!result) { return false; }
         }
@@ -121,9 +121,9 @@ int play_check(const Gamestate & gs, const FeatureFrame * ff, Move * moves, int
         Move m{ff->centre, ff->secondary, 0};
         int score;
         if (move_is_safe(gs, m)) {
-            score = safe_check_score(gs.board.get(m.from));
+            score = safe_check_score(gs.board.get(m.from()));
         } else {
-            score = unsafe_check_score(gs.board.get(m.from));
+            score = unsafe_check_score(gs.board.get(m.from()));
         }
         m.set_score(score);
 
@@ -246,8 +246,8 @@ int defend_square(const Gamestate & gs, const Square s, Move * moves, int idx, i
 
     for (int i = 0; i < covering_moves.size(); ++i) {
         Move & m = covering_moves[i];
-        Delta d = get_delta_between(m.from, m.to);
-        if (!gs.is_kpinned_piece(m.from, d) && move_is_safe(gs, m)) {
+        Delta d = get_delta_between(m.from(), m.to());
+        if (!gs.is_kpinned_piece(m.from(), d) && move_is_safe(gs, m)) {
             if (idx < end) {
                 m.set_score(defend_score(gs.board.get(s)));
                 moves[idx++] = m;
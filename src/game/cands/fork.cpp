@@ -319,7 +319,7 @@ bool find_queen_forks(Gamestate & gs, const Square s) {
         if (parallel(d1, d2)) { continue; }
 
         // don't record forks from unsafe squares
-        SquareControlStatus status = gs.control_cache->get_control_status(fork_sq);
+        SquareControlStatus status = gs.control_cache.get_control_status(fork_sq);
         if (colour(p) == WHITE
             && (status.balance < 0 || status.min_b < piece_value(KING))) { continue; }
         else if (colour(p) == BLACK
@@ -731,7 +731,7 @@ const Responder play_fork_resp{
      * They should always be found by the unsafe_piece hook regardless.
      */
 
-    Piece p = gs.board.get(m.from);
+    Piece p = gs.board.get(m.from());
     int forkable = 0;
     MoveType dir_array[2] = {ORTHO, DIAG};
 
@@ -741,9 +741,9 @@ const Responder play_fork_resp{
             for (int j = 0; j < 4; ++j) {
 
                 Delta d = D_ORTH[j];
-                Square s = gs.first_piece_encountered(m.to, d);
+                Square s = gs.first_piece_encountered(m.to(), d);
 
-                if (is_sentinel(s) || equal(s, m.from)) { continue; }
+                if (is_sentinel(s) || equal(s, m.from())) { continue; }
                 Piece forked_p = gs.board.get(s);
 
                 // avoid pieces of the same colour
@@ -16,9 +16,9 @@ int trade_piece(const Gamestate & gs, const FeatureFrame * ff, Move * moves, int
     // find the maximum value available
     int max_val = 0;
     for (int i = 0; i < piece_moves.size(); ++i) {
-        Piece p = gs.board.get(piece_moves[i].to);
+        Piece p = gs.board.get(piece_moves[i].to());
         if (p != EMPTY && piece_value(p) > max_val
-                && !gs.is_kpinned_piece(ff->centre, get_delta_between(piece_moves[i].from, piece_moves[i].to))) {
+                && !gs.is_kpinned_piece(ff->centre, get_delta_between(piece_moves[i].from(), piece_moves[i].to()))) {
             max_val = piece_value(p);
         }
     }
@@ -29,11 +29,11 @@ int trade_piece(const Gamestate & gs, const FeatureFrame * ff, Move * moves, int
 
     // return a trade with all pieces of this maximum value
     for (int i = 0; i < piece_moves.size(); ++i) {
-        if (piece_value(gs.board.get(piece_moves[i].to)) == max_val
-                && !gs.is_kpinned_piece(ff->centre, get_delta_between(piece_moves[i].from, piece_moves[i].to))) {
+        if (piece_value(gs.board.get(piece_moves[i].to())) == max_val
+                && !gs.is_kpinned_piece(ff->centre, get_delta_between(piece_moves[i].from(), piece_moves[i].to()))) {
             if (idx < end) {
                 Piece trade_this = gs.board.get(ff->centre);
-                Piece for_this = gs.board.get(piece_moves[i].to);
+                Piece for_this = gs.board.get(piece_moves[i].to());
                 piece_moves[i].set_score(trade_score(trade_this, for_this));
                 moves[idx++] = piece_moves[i];
             } else {
@@ -57,9 +57,9 @@ bool multiple_directions_exist(const ptr_vec<Move> & moves) {
     if (moves.size() == 0) {
         return false;
     }
-    Delta d = get_delta_between(moves[0].from, moves[0].to);
+    Delta d = get_delta_between(moves[0].from(), moves[0].to());
     for (int i = 1; i < moves.size(); ++i) {
-        if (!equal(get_delta_between(moves[i].from, moves[i].to), d)) {
+        if (!equal(get_delta_between(moves[i].from(), moves[i].to()), d)) {
             return true;
         }
     }
@@ -86,8 +86,8 @@ int retreat_piece(const Gamestate & gs, const FeatureFrame * ff, Move * moves, i
 
         if (track_directions) {
             // count how many moves go in this direction, or directly opposite it
-            int forward_dir = ordinal_of_delta(get_delta_between(piece_moves[i].from, piece_moves[i].to));
-            int reverse_dir = ordinal_of_delta(get_delta_between(piece_moves[i].to, piece_moves[i].from));
+            int forward_dir = ordinal_of_delta(get_delta_between(piece_moves[i].from(), piece_moves[i].to()));
+            int reverse_dir = ordinal_of_delta(get_delta_between(piece_moves[i].to(), piece_moves[i].from()));
             direction_counts[forward_dir] += 1;
             direction_counts[reverse_dir] += 1;
             if (direction_counts[forward_dir] > 3) {
@@ -99,14 +99,14 @@ int retreat_piece(const Gamestate & gs, const FeatureFrame * ff, Move * moves, i
 
         if (is_king) {
             const Colour c = colour(gs.board.get(ff->centre));
-            would_be_unsafe = !would_be_safe_king_square(gs, piece_moves[i].to, c);
+            would_be_unsafe = !would_be_safe_king_square(gs, piece_moves[i].to(), c);
         } else {
-            would_be_unsafe = would_be_unsafe_after(gs, piece_moves[i].to, piece_moves[i]);
+            would_be_unsafe = would_be_unsafe_after(gs, piece_moves[i].to(), piece_moves[i]);
         }
 
-        if (!would_be_unsafe && !gs.is_kpinned_piece(ff->centre, get_delta_between(piece_moves[i].from, piece_moves[i].to))) {
+        if (!would_be_unsafe && !gs.is_kpinned_piece(ff->centre, get_delta_between(piece_moves[i].from(), piece_moves[i].to()))) {
             if (idx < end) {
-                piece_moves[i].set_score(retreat_score(gs.board.get(piece_moves[i].from)));
+                piece_moves[i].set_score(retreat_score(gs.board.get(piece_moves[i].from())));
                 moves[idx++] = piece_moves[i];
             } else {
                 return idx;
@@ -132,11 +132,11 @@ int desperado_piece(const Gamestate & gs, const FeatureFrame * ff, Move * moves,
     Move max_move = MOVE_SENTINEL;
 
     for (int i = 0; i < piece_moves.size(); ++i) {
-        Piece p = gs.board.get(piece_moves[i].to);
+        Piece p = gs.board.get(piece_moves[i].to());
         if (p != EMPTY
             && piece_value(p) > max_val
-            && !gs.is_kpinned_piece(ff->centre, get_delta_between(piece_moves[i].from, piece_moves[i].to))
-            && (type(desperado) != KING || totally_undefended(gs, opposite_colour(desperado), piece_moves[i].to))) {
+            && !gs.is_kpinned_piece(ff->centre, get_delta_between(piece_moves[i].from(), piece_moves[i].to()))
+            && (type(desperado) != KING || totally_undefended(gs, opposite_colour(desperado), piece_moves[i].to()))) {
             max_val = piece_value(p);
             max_move = piece_moves[i];
         }
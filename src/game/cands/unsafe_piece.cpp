@@ -13,7 +13,7 @@ bool is_unsafe_piece_hook(Gamestate & gs, const Square s) {
     Colour c = colour(p);
     if (p == EMPTY) { return true; }
 
-    SquareControlStatus ss = gs.control_cache->get_control_status(s);
+    SquareControlStatus ss = gs.control_cache.get_control_status(s);
 
     if (is_weak_status(gs, s, c, ss)) {
         return gs.add_frame(unsafe_piece_hook.id, FeatureFrame{s, SQUARE_SENTINEL, ss.min_w, ss.min_b});
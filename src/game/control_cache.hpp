@@ -62,6 +62,23 @@ struct ControlCache {
         }
     }
 
+    /**
+     * Marks invalid the squares gamma-reachable from the start or end square of the given move,
+     * which is about to be played on the given board. This is the in-place counterpart to update.
+     */
+    inline void invalidate(const Board & b, const Move m) {
+
+        Square invalidated[128];
+        ptr_vec<Square> inval_sqs(invalidated, 128);
+        find_invalidated_squares(b, m, inval_sqs);
+
+        for (int i = 0; i < inval_sqs.size(); ++i) {
+            const uint64_t MASK = ~(1l << index(invalidated[i]));
+            status_present &= MASK;
+            count_present &= MASK;
+        }
+    }
+
     /**
      * Copies data from the given cache without modification. Does not update the Gamestate pointer
      * which the cache maintains: if desired, this must be updated manually.
@@ -3,6 +3,7 @@
 
 #include "../../include/stase/game.h"
 #include "../board/board.hpp"
+#include "../board/attacks.h"
 #include "cands/cands.h"
 #include "cands/hook.hpp"
 #include "control_cache.hpp"
@@ -11,6 +12,26 @@
 
 const int MAX_FRAMES = 20;
 
+/**
+ * Everything needed to take back a move made with Gamestate::make_move. The pins and feature
+ * frames are not stored: they are cheap to find again, and far larger than the rest together.
+ */
+struct GamestateUndo {
+    BoardUndo board;
+    Move last_move;
+    Square w_king;
+    Square b_king;
+    bool w_cas;
+    bool b_cas;
+    bool in_check;
+    bool game_over;
+    GamePhase phase;
+    uint64_t status_present;
+    uint64_t count_present;
+    KingNet w_king_net;
+    KingNet b_king_net;
+};
+
 class Gamestate {
 
 public:
@@ -23,18 +44,18 @@ public:
 
     Move last_move;
     mutable Square w_king;
-    KingNet * w_king_net;
+    KingNet w_king_net;
     mutable Square b_king;
-    KingNet * b_king_net;
-    Square * wpieces;
-    Square * bpieces;
+    KingNet b_king_net;
+    Square wpieces[16];
+    Square bpieces[16];
     PinCache wpin_cache;
     PinCache bpin_cache;
     PinCache wdiscoveries;
     PinCache bdiscoveries;
 
-    ControlCache * control_cache;
-    PieceEncounteredCache * pdir_cache;
+    // filled in lazily by const users of the gamestate, which is why it is mutable
+    mutable ControlCache control_cache;
     FeatureFrame frames[NUM_HOOKS][MAX_FRAMES];
 
     explicit Gamestate(const Board & b)
@@ -47,11 +68,10 @@ public:
     {
         alloc();
         find_kings();
-        compute_cache(board, pdir_cache);
         find_kpins_and_discoveries(w_king);
         find_kpins_and_discoveries(b_king);
-        w_king_net = new KingNet(*this, board, w_king);
-        b_king_net = new KingNet(*this, board, b_king);
+        w_king_net = KingNet(*this, board, w_king);
+        b_king_net = KingNet(*this, board, b_king);
     }
 
     explicit Gamestate(const Gamestate & o, const Move m)
@@ -63,21 +83,21 @@ public:
     {
         alloc();
 
-        if (o.board.get(m.from) == W_KING) {
-            w_king = m.to;
+        if (o.board.get(m.from()) == W_KING) {
+            w_king = m.to();
             b_king = o.b_king;
-        } else if (o.board.get(m.from) == B_KING) {
+        } else if (o.board.get(m.from()) == B_KING) {
             w_king = o.w_king;
-            b_king = m.to;
+            b_king = m.to();
         } else {
             w_king = o.w_king;
             b_king = o.b_king;
         }
 
-        if (m.is_cas() && colour(board.get(m.from)) == WHITE) {
+        if (m.is_cas() && colour(board.get(m.from())) == WHITE) {
             w_cas = true;
             b_cas = o.b_cas;
-        } else if (m.is_cas() && colour(board.get(m.from)) == BLACK) {
+        } else if (m.is_cas() && colour(board.get(m.from())) == BLACK) {
             w_cas = o.w_cas;
             b_cas = true;
         } else {
@@ -85,18 +105,15 @@ public:
             b_cas = o.b_cas;
         }
 
-        // copy pdir_cache contents across and then update it
-        copy_cache(o.pdir_cache, pdir_cache);
-        update_cache(board, pdir_cache, m);
         update_phase(m);
-        this->control_cache->update(o.board, *o.control_cache, m);
+        control_cache.update(o.board, o.control_cache, m);
 
         // re-find pins and discoveries
         find_kpins_and_discoveries(w_king);
         find_kpins_and_discoveries(b_king);
 
-        w_king_net = new KingNet(*this, board, w_king);
-        b_king_net = new KingNet(*this, board, b_king);
+        w_king_net = KingNet(*this, board, w_king);
+        b_king_net = KingNet(*this, board, b_king);
     }
 
     explicit Gamestate(const std::string & fen)
@@ -109,11 +126,10 @@ public:
     {
         alloc();
         find_kings();
-        compute_cache(board, pdir_cache);
         find_kpins_and_discoveries(w_king);
         find_kpins_and_discoveries(b_king);
-        w_king_net = new KingNet(*this, board, w_king);
-        b_king_net = new KingNet(*this, board, b_king);
+        w_king_net = KingNet(*this, board, w_king);
+        b_king_net = KingNet(*this, board, b_king);
     }
 
     explicit Gamestate(const std::string & fen, GamePhase phase)
@@ -126,127 +142,56 @@ public:
     {
         alloc();
         find_kings();
-        compute_cache(board, pdir_cache);
         find_kpins_and_discoveries(w_king);
         find_kpins_and_discoveries(b_king);
-        w_king_net = new KingNet(*this, board, w_king);
-        b_king_net = new KingNet(*this, board, b_king);
+        w_king_net = KingNet(*this, board, w_king);
+        b_king_net = KingNet(*this, board, b_king);
     }
 
-    explicit Gamestate(Gamestate && o)
-    {
-        board = o.board;
-        game_over = o.game_over;
-        w_cas = o.w_cas;
-        b_cas = o.b_cas;
-        in_check = o.in_check;
-        phase = o.phase;
-
-        last_move = o.last_move;
-        w_king = o.w_king;
-        w_king_net = o.w_king_net;
-        o.w_king_net = nullptr;
-        b_king = o.b_king;
-        b_king_net = o.b_king_net;
-        o.b_king_net = nullptr;
-        wpieces = o.wpieces; o.wpieces = nullptr;
-        bpieces = o.bpieces; o.bpieces = nullptr;
-        wpin_cache = o.wpin_cache;
-        bpin_cache = o.bpin_cache;
-        wdiscoveries = o.wdiscoveries;
-        bdiscoveries = o.bdiscoveries;
-
-        control_cache = o.control_cache;
-        control_cache->gs = this;
-        o.control_cache = nullptr;
-        pdir_cache = o.pdir_cache; o.pdir_cache = nullptr;
-
-        // copy contents of feature frames across
-        for (int i = 0; i < ALL_HOOKS.size(); ++i) {
-            for (int j = 0; j < MAX_FRAMES; ++j) {
-                frames[i][j] = o.frames[i][j];
-                if (is_sentinel(o.frames[i][j].centre)) { break; }
-            }
-        }
+    /**
+     * Everything a gamestate owns is held inline, so a move is no cheaper than a copy: both copy
+     * the members across, and point the control cache back at the new gamestate.
+     */
+    Gamestate(Gamestate && o) noexcept {
+        copy_from(o);
     }
 
     /**
-     * Copy constructor. This is painfully slow and should be avoided wherever possible.
+     * Copy constructor. This copies a few kilobytes and should be avoided where it can be.
      * Currently, it's one use case is when caching the puzzles read from file: they need
      * to be copied when a second or later benchmark asks for them.
      */
-    explicit Gamestate(const Gamestate & o)
-    {
-        alloc();
-        board = o.board;
-        game_over = o.game_over;
-        w_cas = o.w_cas;
-        b_cas = o.b_cas;
-        in_check = o.in_check;
-        phase = o.phase;
-
-        last_move = o.last_move;
-        w_king = o.w_king;
-        b_king = o.b_king;
-        wpin_cache = o.wpin_cache;
-        bpin_cache = o.bpin_cache;
-        wdiscoveries = o.wdiscoveries;
-        bdiscoveries = o.bdiscoveries;
-
-        for (int i = 0; i < 16; ++i) {
-            wpieces[i] = o.wpieces[i];
-            if (is_sentinel(wpieces[i])) { break; }
-        }
-        for (int i = 0; i < 16; ++i) {
-            bpieces[i] = o.bpieces[i];
-            if (is_sentinel(bpieces[i])) { break; }
-        }
-
-        // copy the caches
-        control_cache->copy(*o.control_cache);
-        copy_cache(o.pdir_cache, pdir_cache);
-
-        w_king_net = new KingNet(*this, board, w_king);
-        b_king_net = new KingNet(*this, board, b_king);
-
-        // copy contents of feature frames across
-        for (int i = 0; i < ALL_HOOKS.size(); ++i) {
-            for (int j = 0; j < MAX_FRAMES; ++j) {
-                frames[i][j] = o.frames[i][j];
-                if (is_sentinel(o.frames[i][j].centre)) { break; }
-            }
-        }
+    explicit Gamestate(const Gamestate & o) {
+        copy_from(o);
     }
 
-    ~Gamestate() {
-        delete control_cache;
-        delete pdir_cache;
-        delete w_king_net;
-        delete b_king_net;
-        delete[] wpieces;
-        delete[] bpieces;
+    Gamestate & operator=(const Gamestate & o) {
+        if (this != &o) { copy_from(o); }
+        return *this;
     }
 
-    Gamestate & operator=(const Gamestate &) = default;
-    Gamestate & operator=(Gamestate &&) = default;
+    Gamestate & operator=(Gamestate && o) noexcept {
+        if (this != &o) { copy_from(o); }
+        return *this;
+    }
 
     inline Piece sneak(const Move m) const {
         Piece sneaked = board.sneak(m);
-        Piece p = board.get(m.to);
+        Piece p = board.get(m.to());
         if (p == W_KING) {
-            w_king = m.to;
+            w_king = m.to();
         } else if (p == B_KING) {
-            b_king = m.to;
+            b_king = m.to();
         }
         return sneaked;
     }
     inline void unsneak(const Move m, const Piece sneaked) const {
         board.unsneak(m, sneaked);
-        Piece p = board.get(m.from);
+        Piece p = board.get(m.from());
         if (p == W_KING) {
-            w_king = m.from;
+            w_king = m.from();
         } else if (p == B_KING) {
-            b_king = m.from;
+            b_king = m.from();
         }
     }
 
@@ -282,7 +227,7 @@ public:
      * encountered before the edge of the board.
      */
     inline Square first_piece_encountered(const Square s, const Delta d) const {
-        return pdir_cache->d[(d.dx + 1)][(d.dy + 1)].p[s.x][s.y];
+        return first_piece_in_direction(s, d, board.occupied());
     }
 
     /**
@@ -292,13 +237,14 @@ public:
     inline void next_in_place(const Move m) {
 
         update_phase(m);
-        if (board.get(m.from) == W_KING) {
-            w_king = m.to;
+        const Piece moved = board.get(index_sq(m.from_index()));
+        if (moved == W_KING) {
+            w_king = m.to();
             if (m.is_cas()) {
                 w_cas = true;
             }
-        } else if (board.get(m.from) == B_KING) {
-            b_king = m.to;
+        } else if (moved == B_KING) {
+            b_king = m.to();
             if (m.is_cas()) {
                 b_cas = true;
             }
@@ -308,6 +254,74 @@ public:
 
     }
 
+    /**
+     * Plays the move on this gamestate in place, recording what is needed to take it back in
+     * the given undo record. The result is the same as constructing Gamestate(gs, m), except
+     * that nothing is allocated and the board is not copied. Any feature frames which hooks
+     * had added are cleared, as they are when a new gamestate is constructed.
+     */
+    inline void make_move(const Move m, GamestateUndo & undo) {
+
+        undo.last_move = last_move;
+        undo.w_king = w_king;
+        undo.b_king = b_king;
+        undo.w_cas = w_cas;
+        undo.b_cas = b_cas;
+        undo.in_check = in_check;
+        undo.game_over = game_over;
+        undo.phase = phase;
+        undo.w_king_net = w_king_net;
+        undo.b_king_net = b_king_net;
+
+        update_phase(m);
+        const Piece moved = board.get(index_sq(m.from_index()));
+        if (moved == W_KING) {
+            w_king = m.to();
+            w_cas = w_cas || m.is_cas();
+        } else if (moved == B_KING) {
+            b_king = m.to();
+            b_cas = b_cas || m.is_cas();
+        }
+
+        control_cache.invalidate(board, m);
+        undo.status_present = control_cache.status_present;
+        undo.count_present = control_cache.count_present;
+        board.make_move(m, undo.board);
+        last_move = m;
+        in_check = false;
+        game_over = false;
+
+        refresh_pins();
+        w_king_net = KingNet(*this, board, w_king);
+        b_king_net = KingNet(*this, board, b_king);
+    }
+
+    /**
+     * Takes back the move, which must be the last one made with make_move, using the undo
+     * record it filled in.
+     */
+    inline void unmake_move(const Move m, const GamestateUndo & undo) {
+
+        board.unmake_move(m, undo.board);
+        last_move = undo.last_move;
+        w_king = undo.w_king;
+        b_king = undo.b_king;
+        w_cas = undo.w_cas;
+        b_cas = undo.b_cas;
+        in_check = undo.in_check;
+        game_over = undo.game_over;
+        phase = undo.phase;
+
+        // only squares cached both before and after the move can have kept their values: the
+        // rest have either been invalidated, or been filled in since, in a different position
+        control_cache.status_present &= undo.status_present;
+        control_cache.count_present &= undo.count_present;
+
+        refresh_pins();
+        w_king_net = undo.w_king_net;
+        b_king_net = undo.b_king_net;
+    }
+
     /**
      * Records that the piece on the given square is pinned to its king and is therefore
      * not able to move.
@@ -429,18 +443,15 @@ public:
 
 private:
     /**
-     * Allocates memory for all the fields in a gamestate which need it.
+     * Initialises the fields of a new gamestate which need it: the piece lists, cache and
+     * feature frames all start out empty. Nothing is allocated.
      */
     inline void alloc() {
         // initialise the piece lists with sentinels
-        wpieces = new Square[16];
-        bpieces = new Square[16];
         wpieces[0] = SQUARE_SENTINEL;
         bpieces[0] = SQUARE_SENTINEL;
 
-        control_cache = new ControlCache;
-        control_cache->gs = this;
-        pdir_cache = new PieceEncounteredCache;
+        control_cache.gs = this;
 
         // add sentinel to start of every list
         for (int i = 0; i < ALL_HOOKS.size(); ++i) {
@@ -448,6 +459,62 @@ private:
         }
     }
 
+    /**
+     * Copies every member of the given gamestate into this one. The piece lists and feature
+     * frames are copied only up to their sentinels, and the control cache is pointed at this
+     * gamestate rather than the one it came from.
+     */
+    inline void copy_from(const Gamestate & o) {
+        board = o.board;
+        game_over = o.game_over;
+        w_cas = o.w_cas;
+        b_cas = o.b_cas;
+        in_check = o.in_check;
+        phase = o.phase;
+
+        last_move = o.last_move;
+        w_king = o.w_king;
+        w_king_net = o.w_king_net;
+        b_king = o.b_king;
+        b_king_net = o.b_king_net;
+        wpin_cache = o.wpin_cache;
+        bpin_cache = o.bpin_cache;
+        wdiscoveries = o.wdiscoveries;
+        bdiscoveries = o.bdiscoveries;
+
+        for (int i = 0; i < 16; ++i) {
+            wpieces[i] = o.wpieces[i];
+            if (is_sentinel(wpieces[i])) { break; }
+        }
+        for (int i = 0; i < 16; ++i) {
+            bpieces[i] = o.bpieces[i];
+            if (is_sentinel(bpieces[i])) { break; }
+        }
+
+        control_cache.copy(o.control_cache);
+        control_cache.gs = this;
+
+        for (int i = 0; i < ALL_HOOKS.size(); ++i) {
+            for (int j = 0; j < MAX_FRAMES; ++j) {
+                frames[i][j] = o.frames[i][j];
+                if (is_sentinel(o.frames[i][j].centre)) { break; }
+            }
+        }
+    }
+
+    /**
+     * Forgets the pins, discoveries and feature frames, and finds the pins and discoveries afresh.
+     */
+    inline void refresh_pins() {
+        wpin_cache = PinCache();
+        bpin_cache = PinCache();
+        wdiscoveries = PinCache();
+        bdiscoveries = PinCache();
+        clear_all_frames();
+        find_kpins_and_discoveries(w_king);
+        find_kpins_and_discoveries(b_king);
+    }
+
     /**
      * Transitions the Gamestate's phase according to certain conditions, based on the Gamestate and
      * the given move which creates the new gamestate. This move shouldn't have been played yet: this
@@ -461,7 +528,7 @@ private:
                 }
                 break;
             case MIDGAME:
-                if (type(board.get(m.from)) == QUEEN && type(board.get(m.to)) == QUEEN) {
+                if (type(board.get(m.from())) == QUEEN && type(board.get(m.to())) == QUEEN) {
                     phase = ENDGAME;
                 }
                 break;
@@ -475,16 +542,10 @@ private:
      * squares of the kings.
      */
     inline void find_kings() {
-        for (int x = 0; x < 8; ++x) {
-            for (int y = 0; y < 8; ++y) {
-                Piece p = board.get(mksq(x, y));
-                if (p == W_KING) {
-                    w_king = mksq(x, y);
-                } else if (p == B_KING) {
-                    b_king = mksq(x, y);
-                }
-            }
-        }
+        const Square w = board.king_square(WHITE);
+        const Square b = board.king_square(BLACK);
+        if (!is_sentinel(w)) { w_king = w; }
+        if (!is_sentinel(b)) { b_king = b; }
     }
 
     /**
@@ -70,7 +70,7 @@ bool can_see_x_ray(const Gamestate & gs, const Piece p, const Square from, const
  * for its colour (ie non-negative for black, non-positive for white).
  */
 bool zero_or_worse_control(const Gamestate & gs, const Square s) {
-    SquareControlStatus status = gs.control_cache->get_control_status(s);
+    SquareControlStatus status = gs.control_cache.get_control_status(s);
     if (colour(gs.board.get(s)) == WHITE) {
         return status.balance <= 0 && status.min_w > piece_value(PAWN);
     } else {
@@ -83,7 +83,7 @@ bool zero_or_worse_control(const Gamestate & gs, const Square s) {
  * A defender is counted even if it is pinned.
  */
 bool totally_undefended(const Gamestate & gs, const Colour c, const Square s) {
-    SquareControlStatus status = gs.control_cache->get_control_status(s);
+    SquareControlStatus status = gs.control_cache.get_control_status(s);
     return c == WHITE
         ? status.min_w == NOT_ATTACKED_AT_ALL
         : status.min_b == NOT_ATTACKED_AT_ALL;
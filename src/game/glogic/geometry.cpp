@@ -113,26 +113,26 @@ inline void gamma_explore(const Board & b, const Square s, ptr_vec<Square> & squ
 void find_invalidated_squares(const Board & b, const Move m, ptr_vec<Square> & squares) {
 
     for (const Delta d : D) {
-        gamma_explore(b, m.from, squares, d, direction_of_delta(d));
-        gamma_explore(b, m.to, squares, d, direction_of_delta(d));
+        gamma_explore(b, m.from(), squares, d, direction_of_delta(d));
+        gamma_explore(b, m.to(), squares, d, direction_of_delta(d));
     }
 
-    if (type(b.get(m.from)) == KNIGHT) {
+    if (type(b.get(m.from())) == KNIGHT) {
         for (int j = 0; j < 8; ++j) {
-            Square temp = mksq(m.from.x + XKN[j], m.from.y + YKN[j]);
+            Square temp = mksq(m.from().x + XKN[j], m.from().y + YKN[j]);
             if (val(temp)) {
                 squares.push(temp);
             }
-            temp = mksq(m.to.x + XKN[j], m.to.y + YKN[j]);
+            temp = mksq(m.to().x + XKN[j], m.to().y + YKN[j]);
             if (val(temp)) {
                 squares.push(temp);
             }
         }
     }
 
-    else if (type(b.get(m.to)) == KNIGHT) {
+    else if (type(b.get(m.to())) == KNIGHT) {
         for (int j = 0; j < 8; ++j) {
-            Square temp = mksq(m.to.x + XKN[j], m.to.y + YKN[j]);
+            Square temp = mksq(m.to().x + XKN[j], m.to().y + YKN[j]);
             if (val(temp)) {
                 squares.push(temp);
             }
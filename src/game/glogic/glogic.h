@@ -4,7 +4,6 @@
 #include "../../../include/stase/game.h"
 #include "../../../include/stase/board.h"
 #include "piece_moves.hpp"
-#include "piece_encounter_cache.hpp"
 #include "edge_of_board_lookup.h"
 #include "../../utils/ptr_vec.h"
 
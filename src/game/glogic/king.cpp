@@ -9,7 +9,7 @@
  * @param colour: the colour of the king to check this for.
  */
 bool would_be_safe_king_square(const Gamestate & gs, const Square s, const Colour colour) {
-    SquareControlStatus status = gs.control_cache->get_control_status(s);
+    SquareControlStatus status = gs.control_cache.get_control_status(s);
     return colour == WHITE
         ? status.min_b > ATTACKED_BY_PINNED_PIECE
         : status.min_w > ATTACKED_BY_PINNED_PIECE;
@@ -27,8 +27,8 @@ bool has_safe_king(const Gamestate & gs, const Colour king_colour) {
 
 bool has_luft(const Gamestate & gs, const Colour c) {
 
-    const KingNet * king_net = (c == WHITE ? gs.w_king_net : gs.b_king_net);
-    const Square k_sq = king_net->king_square();
+    const KingNet & king_net = (c == WHITE ? gs.w_king_net : gs.b_king_net);
+    const Square k_sq = king_net.king_square();
     Square luft1, luft2, luft3;
 
     if (k_sq.y == 7) {
@@ -64,9 +64,9 @@ bool has_luft(const Gamestate & gs, const Colour c) {
         return true;
     }
 
-    if ((val(luft1) && king_net->is_flight_square(luft1))
-        || (val(luft2) && king_net->is_flight_square(luft2))
-        || (val(luft3) && king_net->is_flight_square(luft3))) {
+    if ((val(luft1) && king_net.is_flight_square(luft1))
+        || (val(luft2) && king_net.is_flight_square(luft2))
+        || (val(luft3) && king_net.is_flight_square(luft3))) {
         return true;
     }
 
@@ -1,6 +1,7 @@
 #include "glogic.h"
 #include "board.h"
 #include "../gamestate.hpp"
+#include "../../board/attacks.h"
 
 #include <iostream>
 using std::cout;
@@ -24,228 +25,110 @@ using std::cout;
  */
 
 /*
- * Performs a linear search on the board according to the given delta.
- * returns the alpha count of the walk
+ * Returns the squares attacked by the given piece along the lines it slides on, given the
+ * occupancy of the board. Non-sliding pieces return an empty set.
  */
-inline int alpha_walk(const Board & b, const Square s, Delta d) {
-    
-    int sum = 0;
-    Square temp = s;
-    bool cont = true;
-    
-    temp.x += d.dx;
-    temp.y += d.dy;
+inline Bitboard slider_attacks(const Piece p, const Square s, const Bitboard occ) {
 
-    while (val(temp) && cont) {
+    Bitboard attacks = EMPTY_BB;
 
-        Piece otherp = b.get(temp);
-        if (otherp == EMPTY) {
-            ++sum;
-        } else {
-            // ALPHA: only count empty squares
-            cont = false;
-        }
-        temp.x += d.dx;
-        temp.y += d.dy;
+    if (can_move_in_direction(p, ORTHO)) {
+        attacks |= rook_attacks(s, occ);
     }
-    
-    return sum;
+    if (can_move_in_direction(p, DIAG)) {
+        attacks |= bishop_attacks(s, occ);
+    }
+
+    return attacks;
 }
 
 /*
  * computes and returns the number of squares which the given piece 'alpha controls'
  */
 int alpha_control(const Board & b, const Square s) {
-    
-    int sum = 0;
-    
-    Piece p = b.get(s);
-    
-    if (can_move_in_direction(p, ORTHO)) {
-        for (int i = ORTHO_START; i < ORTHO_STOP; ++i) {
-            sum += alpha_walk(b, s, Delta{XD[i], YD[i]});
-        }
-    }
-    
-    if (can_move_in_direction(p, DIAG)) {
-        for (int i = DIAG_START; i < DIAG_STOP; ++i) {
-            sum += alpha_walk(b, s, Delta{XD[i], YD[i]});
-        }
-    }
-    
-    if (can_move_in_direction(p, KNIGHT_MOVE)) {
-    
-        int x = get_x(s);
-        int y = get_y(s);
-        Square sq;
-        
-        if (val(sq = mksq(x + 1, y + 2)) && b.get(sq) == EMPTY)
-            ++sum;
-        if (val(sq = mksq(x + 1, y - 2)) && b.get(sq) == EMPTY)
-            ++sum;
-        if (val(sq = mksq(x + 2, y + 1)) && b.get(sq) == EMPTY)
-            ++sum;
-        if (val(sq = mksq(x + 2, y - 1)) && b.get(sq) == EMPTY)
-            ++sum;
-        if (val(sq = mksq(x - 1, y + 2)) && b.get(sq) == EMPTY)
-            ++sum;
-        if (val(sq = mksq(x - 1, y - 2)) && b.get(sq) == EMPTY)
-            ++sum;
-        if (val(sq = mksq(x - 2, y + 1)) && b.get(sq) == EMPTY)
-            ++sum;
-        if (val(sq = mksq(x - 2, y - 1)) && b.get(sq) == EMPTY)
-            ++sum;
-    }
-    
-    return sum;
-
-}
 
-// performs a linear search on the board according to the given delta.
-// returns the beta count of the walk
-inline int beta_walk(const Board & b, const Square s, Delta d) {
-    
-    int sum = 0;
-    Square temp = s;
-    bool cont = true;
+    Piece p = b.get(s);
+    Bitboard occ = b.occupied();
 
-    temp.x += d.dx;
-    temp.y += d.dy;
-    
-    while (val(temp) && cont) {
+    // ALPHA: only count empty squares
+    int sum = popcount(slider_attacks(p, s, occ) & ~occ);
 
-        Piece otherp = b.get(temp);
-        if (otherp == EMPTY) {
-            ++sum;
-        } else {
-            // BETA: count the endpoint
-            cont = false;
-            ++sum;
-        }
-        temp.x += d.dx;
-        temp.y += d.dy;
+    if (can_move_in_direction(p, KNIGHT_MOVE)) {
+        sum += popcount(knight_attacks(s) & ~occ);
     }
-    
+
     return sum;
+
 }
 
 // computes and returns the number of squares which the given piece 'beta controls'
 int beta_control(const Board & b, const Square s) {
-    
-    int sum = 0;
-    
+
     Piece p = b.get(s);
-    
-    if (can_move_in_direction(p, ORTHO)) {
-        for (int i = ORTHO_START; i < ORTHO_STOP; ++i) {
-            sum += beta_walk(b, s, Delta{XD[i], YD[i]});
-        }
-    }
-    
-    if (can_move_in_direction(p, DIAG)) {
-        for (int i = DIAG_START; i < DIAG_STOP; ++i) {
-            sum += beta_walk(b, s, Delta{XD[i], YD[i]});
-        }
-    }
-    
+
+    // BETA: count the endpoints too
+    int sum = popcount(slider_attacks(p, s, b.occupied()));
+
     if (can_move_in_direction(p, KNIGHT_MOVE)) {
-    
-        int x = get_x(s);
-        int y = get_y(s);
-        
-        if (val(mksq(x + 1, y + 2)))
-            ++sum;
-        if (val(mksq(x + 1, y - 2)))
-            ++sum;
-        if (val(mksq(x + 2, y + 1)))
-            ++sum;
-        if (val(mksq(x + 2, y - 1)))
-            ++sum;
-        if (val(mksq(x - 1, y + 2)))
-            ++sum;
-        if (val(mksq(x - 1, y - 2)))
-            ++sum;
-        if (val(mksq(x - 2, y + 1)))
-            ++sum;
-        if (val(mksq(x - 2, y - 1)))
-            ++sum;
-        
+        sum += popcount(knight_attacks(s));
     }
-    
+
     return sum;
 
 }
 
-// performs a linear search on the board according to the given delta.
+// jumps along the line from piece to piece according to the given delta.
 // returns the gamma count of the walk
 inline int gamma_walk(const Board & b, const Square s, Delta d, MoveType dir) {
-    
+
     int sum = 0;
-    Square temp = s;
-    bool cont = true;
-    
-    temp.x += d.dx;
-    temp.y += d.dy;
-    
-    while (val(temp) && cont) {
+    const Bitboard occ = b.occupied();
+    const Colour c = colour(b.get(s));
+    Square current = s;
 
-        Piece otherp = b.get(temp);
-        if (otherp == EMPTY) {
-            ++sum;
-        } else {
-            // gamma: x-ray
-            cont = (colour(otherp) == colour(b.get(s))) && can_move_in_direction(otherp, dir);
-            ++sum;
+    while (true) {
+
+        Square next = first_piece_in_direction(current, d, occ);
+        if (is_sentinel(next)) {
+            // open line to the edge of the board
+            return sum + popcount(ray_bb(current, d));
+        }
+
+        // the squares up to and including the piece found
+        sum += popcount(ray_bb(current, d) & ~ray_bb(next, d));
+
+        // gamma: x-ray
+        Piece otherp = b.get(next);
+        if (colour(otherp) != c || !can_move_in_direction(otherp, dir)) {
+            return sum;
         }
-        temp.x += d.dx;
-        temp.y += d.dy;
+        current = next;
     }
-    
-    return sum;
 }
 
 // computes and returns the number of squares which the given piece 'gamma controls'
 int gamma_control(const Board & b, const Square s) {
-    
+
     int sum = 0;
-    
+
     Piece p = b.get(s);
-    
+
     if (can_move_in_direction(p, ORTHO)) {
         for (int i = ORTHO_START; i < ORTHO_STOP; ++i) {
             sum += gamma_walk(b, s, Delta{XD[i], YD[i]}, ORTHO);
         }
     }
-    
+
     if (can_move_in_direction(p, DIAG)) {
         for (int i = DIAG_START; i < DIAG_STOP; ++i) {
             sum += gamma_walk(b, s, Delta{XD[i], YD[i]}, DIAG);
         }
     }
-    
+
     if (can_move_in_direction(p, KNIGHT_MOVE)) {
-    
-        int x = get_x(s);
-        int y = get_y(s);
-
-        if (val(mksq(x + 1, y + 2)))
-            ++sum;
-        if (val(mksq(x + 1, y - 2)))
-            ++sum;
-        if (val(mksq(x + 2, y + 1)))
-            ++sum;
-        if (val(mksq(x + 2, y - 1)))
-            ++sum;
-        if (val(mksq(x - 1, y + 2)))
-            ++sum;
-        if (val(mksq(x - 1, y - 2)))
-            ++sum;
-        if (val(mksq(x - 2, y + 1)))
-            ++sum;
-        if (val(mksq(x - 2, y - 1)))
-            ++sum;
+        sum += popcount(knight_attacks(s));
     }
-    
+
     return sum;
 
 }
@@ -263,25 +146,21 @@ int gamma_control(const Board & b, const Square s) {
 int control_walk(const Board & b, const Square s, Delta d, MoveType dir) {
 
     int sum = 0;
-    Square temp = s;
-    bool cont = true;
-    
-    temp.x += d.dx;
-    temp.y += d.dy;
-    
-    while (val(temp) && cont) {
+    const Bitboard occ = b.occupied();
+    Square temp = first_piece_in_direction(s, d, occ);
+
+    while (!is_sentinel(temp)) {
 
         Piece otherp = b.get(temp);
 
-        if ((otherp != EMPTY) && can_move_in_direction(otherp, dir)) {
+        if (can_move_in_direction(otherp, dir)) {
             // any piece which can move in the right dir? account and continue
             sum += ((colour(otherp) == WHITE) ? 1 : -1);
-        } else  if (otherp != EMPTY) {
+        } else {
             // blocking piece, abort
-            cont = false;
+            break;
         }
-        temp.x += d.dx;
-        temp.y += d.dy;
+        temp = first_piece_in_direction(temp, d, occ);
     }
     
     return sum;
@@ -2,6 +2,7 @@
 #include "../heur/heur.h"
 #include "glogic.h"
 #include "../gamestate.hpp"
+#include "../../board/attacks.h"
 
 /**
  * Returns a SquareControlStatus summarising the status of the given square, without using
@@ -48,6 +49,9 @@ SquareControlStatus __sneaked__evaluate_square_control(const Gamestate & gs, con
     int x, y;
     Square temp;
 
+    // the board may be sneaked, but its bitboards are kept up to date regardless
+    const Bitboard occ = gs.board.occupied();
+
     // go through the delta pairs entailing each sliding direction
     MoveType dir = DIAG;
     for (int i = 0; i < 8; ++i) {
@@ -60,22 +64,18 @@ SquareControlStatus __sneaked__evaluate_square_control(const Gamestate & gs, con
         int prior_balance = basic_balance;
 
         int x_inc = XD[i], y_inc = YD[i];
+        Delta d = delta(x_inc, y_inc);
         bool cont = true;
         bool x_ray = false;
         Colour x_ray_colour = INVALID_COLOUR;
         bool poly_x_ray = false;
 
-        x = get_x(s) + x_inc, y = get_y(s) + y_inc;
+        temp = first_piece_in_direction(s, d, occ);
 
-        // work outwards in that direction
-        while (val(temp = mksq(x, y)) && cont) {
+        // work outwards in that direction, jumping from piece to piece
+        while (!is_sentinel(temp) && cont) {
 
             Piece p = gs.board.get(temp);
-            if (p == EMPTY) {
-                x += x_inc;
-                y += y_inc;
-                continue;
-            }
 
             bool moves_in_right_dir = can_move_in_direction(p, dir);
 
@@ -85,14 +85,14 @@ SquareControlStatus __sneaked__evaluate_square_control(const Gamestate & gs, con
 
                 // they can only contribute from the very first square along the diagonal, because that's
                 // the only square they can capture the target from
-                if (x == get_x(s) + x_inc && y == get_y(s) + y_inc) {
+                if (temp.x == s.x + x_inc && temp.y == s.y + y_inc) {
 
                     // otherwise, the diagonal has to be going in the right direction for their colour
                     if (colour(p) == WHITE && y_inc == -1) {
                         // white pawns can capture up the board, so if we are working out from
                         // the target and moving down the board, a white pawn is able to take
                         // it may however be pinned of course, in which case the diagonal is done.
-                        if (gs.is_kpinned_piece(temp, delta(x_inc, y_inc))) {
+                        if (gs.is_kpinned_piece(temp, d)) {
                             cont = false;
                             attacked_by_pinned_w_piece = true;
                             continue;
@@ -101,7 +101,7 @@ SquareControlStatus __sneaked__evaluate_square_control(const Gamestate & gs, con
                         }
                     } else if (colour(p) == BLACK && y_inc == 1) {
                         // vice versa
-                        if (gs.is_kpinned_piece(temp, delta(x_inc, y_inc))) {
+                        if (gs.is_kpinned_piece(temp, d)) {
                             cont = false;
                             attacked_by_pinned_b_piece = true;
                             continue;
@@ -114,7 +114,7 @@ SquareControlStatus __sneaked__evaluate_square_control(const Gamestate & gs, con
 
             if (moves_in_right_dir) {
 
-                if (!x_ray && gs.is_kpinned_piece(temp, delta(x_inc, y_inc))) {
+                if (!x_ray && gs.is_kpinned_piece(temp, d)) {
                     cont = false;
                     if (colour(p) == WHITE) {
                         attacked_by_pinned_w_piece = true;
@@ -168,8 +168,7 @@ SquareControlStatus __sneaked__evaluate_square_control(const Gamestate & gs, con
                 cont = false;
             }
 
-            x += x_inc;
-            y += y_inc;
+            temp = first_piece_in_direction(temp, d, occ);
 
         }
 
@@ -93,7 +93,7 @@ bool is_weak_square(const Gamestate & gs, const Square s, const Colour c, const
     if (!use_caches) {
         return is_weak_status(gs, s, c, __sneaked__evaluate_square_control(gs, s));
     }
-    return is_weak_status(gs, s, c, gs.control_cache->get_control_status(s));
+    return is_weak_status(gs, s, c, gs.control_cache.get_control_status(s));
 }
 
 /**
@@ -125,7 +125,7 @@ bool is_unsafe_piece(const Gamestate & gs, const Square s) {
  * Not suitable for kings (use eg is_safe_for_king).
  */
 bool would_be_unsafe_after(const Gamestate & gs, const Square s, const Move m) {
-    return (gs.board.get(s) != EMPTY || equal(s, m.to)) && would_be_weak_after(gs, s, colour(gs.board.get(s)), m);
+    return (gs.board.get(s) != EMPTY || equal(s, m.to())) && would_be_weak_after(gs, s, colour(gs.board.get(s)), m);
 }
 
 /**
@@ -134,10 +134,10 @@ bool would_be_unsafe_after(const Gamestate & gs, const Square s, const Move m) {
  */
 bool move_is_safe(const Gamestate & gs, const Move m) {
 
-    Piece p = gs.board.get(m.from);
+    Piece p = gs.board.get(m.from());
     if (p == EMPTY) { return true; }
 
-    SquareControlStatus status = gs.control_cache->get_control_status(m.to);
+    SquareControlStatus status = gs.control_cache.get_control_status(m.to());
 
     if (colour(p) == WHITE) {
 
@@ -152,7 +152,7 @@ bool move_is_safe(const Gamestate & gs, const Move m) {
         // if the square is only controlled by a king, special care is needed
         if (status.min_b == piece_value(B_KING)) {
             // pawn forward moves do not affect the control, so we can use the min attacker
-            if (type(p) == PAWN && m.from.x == m.to.x) {
+            if (type(p) == PAWN && m.from().x == m.to().x) {
                 return status.min_w <= ATTACKED_BY_PINNED_PIECE;
             }
             return status.balance >= 0;
@@ -191,7 +191,7 @@ bool move_is_safe(const Gamestate & gs, const Move m) {
 
         // if the square is only controlled by a king, special care is needed
         if (status.min_w == piece_value(W_KING)) {
-            if (type(p) == PAWN && m.from.x == m.to.x) {
+            if (type(p) == PAWN && m.from().x == m.to().x) {
                 return status.min_b <= ATTACKED_BY_PINNED_PIECE;
             }
             return status.balance <= 0;
@@ -33,28 +33,47 @@ const unsigned NUM_OUTER_CENTRAL_SQUARES = 12;
 /*
  * Returns an evaluation of the given board
  */
-int material_balance(const Gamestate & gs) {
+int material_balance(const Board & board) {
 
     int count = 0;
-    
-    for (int x = 0; x < 8; ++x) {
-        for (int y = 0; y < 8; ++y) {
-            Piece p = gs.board.get(mksq(x, y));
-            
-            if (colour(p) == WHITE) {
-                count += piece_value_millis(p);
-            } else if (colour(p) == BLACK) {
-                count -= piece_value_millis(p);
-            } else {
-                // colour can be INVALID
-            }
-        }
+
+    for (Ptype t : {KING, QUEEN, ROOK, KNIGHT, BISHOP, PAWN}) {
+        Piece w = mkpiece(WHITE, t);
+        Piece b = mkpiece(BLACK, t);
+        count += piece_value_millis(w) * (board.count(w) - board.count(b));
     }
-    
+
     return count;
 
 }
 
+int material_balance(const Gamestate & gs) {
+    return material_balance(gs.board);
+}
+
+/**
+ * The material balance after the move is played on the given board, plus the move's candidate
+ * score in favour of the side making it, on the same scale as heur. The resulting position is
+ * never looked at, so this is much cheaper than heur, and much cruder.
+ */
+Eval static_estimate(const Board & b, const Move m) {
+
+    const Colour mover = b.get_white() ? WHITE : BLACK;
+    int gain = __piece_constants::CAND_SCORE_VAL * m.get_score();
+
+    const Piece captured = b.get(m.to());
+    if (m.is_ep()) {
+        gain += __piece_constants::PAWN_VAL;
+    } else if (captured != EMPTY && colour(captured) != mover) {
+        gain += piece_value_millis(captured);
+    }
+    if (m.is_prom()) {
+        gain += piece_value_millis(m.get_prom_piece(mover)) - __piece_constants::PAWN_VAL;
+    }
+
+    return zero() + material_balance(b) + (mover == WHITE ? gain : -gain);
+}
+
 Eval heur(const Gamestate & gs, const MetricWeights * weights) {
     
     Eval ev = zero();
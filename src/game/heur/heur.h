@@ -30,6 +30,8 @@ namespace __piece_constants{
     const int ROOK_VAL = 5000;
     const int QUEEN_VAL = 9000;
     const int KING_VAL = 9001;
+    // what one point of candidate score is taken to be worth, by static_estimate
+    const int CAND_SCORE_VAL = 100;
     const uint8_t PAWN_VAL_SIMPLE = 1;
     const uint8_t BISHOP_VAL_SIMPLE = 3;
     const uint8_t KNIGHT_VAL_SIMPLE = 3;
@@ -6,8 +6,8 @@
  * @return a fraction between zero and one, where 1 represents a king unable to move, and 0 represents a king with
  *  many flight squares.
  */
-float flight_squares_score(const KingNet * king_net) {
-    return ((float) (8 - king_net->flight_squares())) / 8.0f;
+float flight_squares_score(const KingNet & king_net) {
+    return ((float) (8 - king_net.flight_squares())) / 8.0f;
 }
 
 float back_rank_mate_score(const Gamestate & gs, const Colour c) {
@@ -8,12 +8,14 @@
 class KingNet {
 
 private:
-    const Square k_sq;
+    Square k_sq;
     Square neighbours[8];
     bool safe[8];
     Byte n;
 
 public:
+    KingNet() : k_sq(SQUARE_SENTINEL), neighbours{}, safe{}, n(0) {}
+
     explicit KingNet(const Gamestate & gs, const Board & b, const Square k_sq) :
             k_sq(k_sq), n(0) {
 
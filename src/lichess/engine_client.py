@@ -3,6 +3,7 @@ import ctypes
 # load the shared library (once, on import)
 _ec_lib = ctypes.CDLL("./libengine_client.so")
 _ec_lib.get_computer_move.restype = ctypes.c_char_p
+_ec_lib.get_computer_move_on_clock.restype = ctypes.c_char_p
 _ec_lib.get_eval_str.restype = ctypes.c_char_p
 
 
@@ -18,6 +19,17 @@ class EngineClient:
         else:
             self._engine_client = _ec_lib.get_client()
 
+    def __del__(self):
+        self.free()
+
+    def free(self) -> None:
+        """
+        Destroys the C++ client, stopping any search it has going on. The client cannot be used afterwards.
+        """
+        if self._engine_client:
+            _ec_lib.free_client(self._engine_client)
+            self._engine_client = None
+
     def register_opponent_move(self, uci: str) -> None:
         """
         Update the engine so that it is aware of a move made by the opponent.
@@ -30,6 +42,25 @@ class EngineClient:
         """
         return _ec_lib.get_computer_move(self._engine_client, ctypes.c_double(seconds)).decode("utf8")
 
+    def get_computer_move_on_clock(self, remaining: float, increment: float, moves_to_go: int = 0) -> str:
+        """
+        Get the computer's move, budgeting the time to think from the clock: the time remaining and the increment
+        (in seconds), and the number of moves to go before the next time control (0 if there is none).
+        """
+        return _ec_lib.get_computer_move_on_clock(
+            self._engine_client,
+            ctypes.c_double(remaining),
+            ctypes.c_double(increment),
+            ctypes.c_int(moves_to_go)
+        ).decode("utf8")
+
+    def set_ponder(self, on: bool) -> None:
+        """
+        Turn pondering on or off. While on, the engine keeps searching during the opponent's turn, on the reply
+        it expects; turning it off stops any such search.
+        """
+        _ec_lib.set_ponder(self._engine_client, ctypes.c_bool(on))
+
     def get_node_count(self) -> int:
         """
         Fetches the number of nodes explored in the most recent move.
@@ -1,4 +1,5 @@
 import time
+from typing import Callable
 from src.lichess.engine_client import EngineClient
 from src.lichess.client import (
     stream_game_events,
@@ -10,9 +11,6 @@ from src.lichess.info import (
     ENGINE_USERNAME
 )
 
-THINK_TIME_PROPORTION: float = 0.05
-
-
 def post_update(token: str, game_id: str, evaluation: str, time_elapsed: float, nodes_visited: int) -> None:
     """
     Posts an update to the lichess chat with the engine's speed + evaluation.
@@ -26,9 +24,9 @@ def post_update(token: str, game_id: str, evaluation: str, time_elapsed: float,
 
 
 def play_game(token: str, game_id: str, chat_updates=True):
-    def play_a_move(think_time) -> bool:
+    def play_a_move(get_move: Callable[[], str]) -> bool:
         start = time.time()
-        move: str = engine.get_computer_move(think_time)
+        move: str = get_move()
         elapsed = time.time() - start
         if move == "ERROR":
             print("Encountered engine error")
@@ -43,50 +41,57 @@ def play_game(token: str, game_id: str, chat_updates=True):
 
     post_to_chat(token, game_id, "Hello there! I'll post regular updates. If you want me to stop, say \"mute\"!")
     engine: EngineClient = EngineClient()
+    engine.set_ponder(True)
 
     as_white: bool = False
 
-    for event in stream_game_events(token, game_id):
-
-        if "error" in event:
-            print(f"play game for {game_id} received error")
-            return
-
-        if event["type"] == "gameFull":
-
-            print("Received full game information")
-
-            as_white = (event["white"]["id"] == ENGINE_USERNAME)
-
-            if as_white:
-                if not play_a_move(think_time=5):
-                    resign_game(token, game_id)
-                    return
-
-        elif event["type"] == "chatLine":
-            if event["text"] in ["m", "mute"]:
-                chat_updates = False
-            elif event["text"] == "unmute":
-                chat_updates = True
-
-        elif "status" in event and event["status"] != "started":
-            print(f"Game {game_id} has ended")
-            return
-
-        elif event["type"] == "gameState":
-
-            move_played: str = event["moves"].split()[-1]
-            half_move_count = event["moves"].count(' ') + 1
-            millis_remaining = event["wtime"] if as_white else event["btime"]
-
-            if (as_white and half_move_count % 2 == 0) \
-                    or (not as_white and half_move_count % 2 == 1):
-                # update the engine with the opponent's move
-                engine.register_opponent_move(move_played)
-                # play a move of our own
-                if not play_a_move(int((millis_remaining * THINK_TIME_PROPORTION) / 1000)):
-                    print("Error encountered: resigning the game")
-                    resign_game(token, game_id)
-                    return
-        else:
-            print(f"Received event of type {event['type']}")
+    try:
+        for event in stream_game_events(token, game_id):
+
+            if "error" in event:
+                print(f"play game for {game_id} received error")
+                return
+
+            if event["type"] == "gameFull":
+
+                print("Received full game information")
+
+                as_white = (event["white"]["id"] == ENGINE_USERNAME)
+
+                if as_white:
+                    if not play_a_move(lambda: engine.get_computer_move(5)):
+                        resign_game(token, game_id)
+                        return
+
+            elif event["type"] == "chatLine":
+                if event["text"] in ["m", "mute"]:
+                    chat_updates = False
+                elif event["text"] == "unmute":
+                    chat_updates = True
+
+            elif "status" in event and event["status"] != "started":
+                print(f"Game {game_id} has ended")
+                return
+
+            elif event["type"] == "gameState":
+
+                move_played: str = event["moves"].split()[-1]
+                half_move_count = event["moves"].count(' ') + 1
+                millis_remaining = event["wtime"] if as_white else event["btime"]
+                millis_increment = event["winc"] if as_white else event["binc"]
+
+                if (as_white and half_move_count % 2 == 0) \
+                        or (not as_white and half_move_count % 2 == 1):
+                    # update the engine with the opponent's move
+                    engine.register_opponent_move(move_played)
+                    # play a move of our own
+                    if not play_a_move(lambda: engine.get_computer_move_on_clock(millis_remaining / 1000, millis_increment / 1000)):
+                        print("Error encountered: resigning the game")
+                        resign_game(token, game_id)
+                        return
+            else:
+                print(f"Received event of type {event['type']}")
+    finally:
+        # however the game ends, stop any search on the opponent's time and destroy the engine
+        engine.set_ponder(False)
+        engine.free()
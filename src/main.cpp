@@ -129,14 +129,14 @@ void play_game(const std::string & starting_fen, bool engine_is_white, int secon
                 cout << "The computer played " << mtos(b, cmove) << "\n";
                 b = b.successor_hard(cmove);
             } else {
-                cout << "The computer tried to play an illegal move (from " << sqtos(cmove.from) << " to " << sqtos(cmove.to) << ").\n";
+                cout << "The computer tried to play an illegal move (from " << sqtos(cmove.from()) << " to " << sqtos(cmove.to()) << ").\n";
                 cout << "You win!\n";
                 keep_playing = false;
             }
 
         }
 
-        if (game_rules::in_check(b) && game_rules::legal_moves(b).empty()) {
+        if (game_rules::in_check(b) && !game_rules::has_any_legal_move(b)) {
             cout << "Checkmate!\n";
             cout << (players_turn
                         ? "You win!\n"
@@ -16,7 +16,8 @@ bool score_puzzle_against_cands(const Puzzle & puzzle) {
         // the solver only has to find the odd moves
         if (i % 2 == 1) {
 
-            std::vector<Move> candidates = cands(gs, new CandSet)->critical;
+            CandSet cand_set;
+            const std::pmr::vector<Move> & candidates = cands(gs, &cand_set)->critical;
 
             bool found = false;
             for (const Move & cand_move: candidates) {
@@ -92,7 +93,7 @@ bool score_engine_against_puzzle(const Puzzle & puzzle, int positions_allowed) {
     }
     std::cout << "\n";
     for (int i = 1; i < line_played.size(); ++i) {
-        std::cout << move2uci(line_played[i]->move) << " ";
+        std::cout << move2uci(edge_move(line_played[i - 1], line_played[i])) << " ";
     }
     std::cout << "\n";
 
@@ -101,7 +102,7 @@ bool score_engine_against_puzzle(const Puzzle & puzzle, int positions_allowed) {
     }
 
     for (int i = 1; i < puzzle.solution_moves.size(); ++i) {
-        if (!equal(puzzle.solution_moves[i], line_played[i + 1]->move)) {
+        if (!equal(puzzle.solution_moves[i], edge_move(line_played[i], line_played[i + 1]))) {
             return false;
         }
     }
@@ -0,0 +1,101 @@
+#ifndef STASE_ARENA_H
+#define STASE_ARENA_H
+
+#include <memory>
+#include <memory_resource>
+#include <type_traits>
+#include <vector>
+
+#include "../../include/stase/search.h"
+#include "../game/gamestate.hpp"
+#include "search_tools.h"
+
+// nothing in the tree is destructed when its arena is reset, so the gamestates must own no memory
+static_assert(std::is_trivially_destructible_v<Gamestate>);
+
+/**
+ * The memory for one search. Allocation is a pointer bump into a block owned by the arena, and
+ * a new block is taken from the heap only when the current one is full. The whole tree is then
+ * freed by a single reset rather than node by node.
+ *
+ * Nothing allocated here is destructed: the nodes, gamestates and candidate sets keep all their
+ * memory in the arena (their vectors are given it as their resource), so there is nothing left
+ * for a destructor to do.
+ *
+ * Each thread searching the tree has its own blocks, chosen by its search_thread_index, so that
+ * threads never bump the same pointer. Deallocation does nothing, wherever the memory came from.
+ */
+class SearchArena {
+
+private:
+    static constexpr size_t FIRST_BLOCK_BYTES = 1 << 20;
+
+    class ThreadResource : public std::pmr::memory_resource {
+
+    private:
+        std::vector<std::unique_ptr<std::pmr::monotonic_buffer_resource>> & blocks;
+
+    public:
+        explicit ThreadResource(std::vector<std::unique_ptr<std::pmr::monotonic_buffer_resource>> & blocks) :
+            blocks(blocks)
+        {}
+
+    private:
+        void * do_allocate(size_t bytes, size_t alignment) override {
+            return blocks[search_thread_index() % blocks.size()]->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void *, size_t, size_t) override {}
+
+        bool do_is_equal(const std::pmr::memory_resource & other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    std::vector<std::unique_ptr<std::pmr::monotonic_buffer_resource>> blocks;
+    ThreadResource resource;
+
+public:
+    explicit SearchArena(const int threads = 1) : resource(blocks) {
+        for (int i = 0; i < threads; ++i) {
+            blocks.push_back(std::make_unique<std::pmr::monotonic_buffer_resource>(FIRST_BLOCK_BYTES));
+        }
+    }
+
+    SearchArena(const SearchArena &) = delete;
+    SearchArena & operator=(const SearchArena &) = delete;
+
+    inline std::pmr::memory_resource * get() { return &resource; }
+
+    /**
+     * Creates a root node for the given position, allocated from the arena along with its
+     * gamestate and (empty) candidate set.
+     */
+    inline SearchNode * new_root(const std::string & fen, const GamePhase phase) {
+        std::pmr::polymorphic_allocator<> alloc(&resource);
+        return alloc.new_object<SearchNode>(
+            alloc.new_object<Gamestate>(fen, phase),
+            alloc.new_object<CandSet>(&resource),
+            &resource);
+    }
+
+    inline SearchNode * new_root(const Gamestate & gs) {
+        std::pmr::polymorphic_allocator<> alloc(&resource);
+        return alloc.new_object<SearchNode>(
+            alloc.new_object<Gamestate>(gs),
+            alloc.new_object<CandSet>(&resource),
+            &resource);
+    }
+
+    /**
+     * Frees everything allocated from the arena at once. Any nodes allocated from it must not
+     * be used again.
+     */
+    inline void reset() {
+        for (auto & b : blocks) {
+            b->release();
+        }
+    }
+};
+
+#endif //STASE_ARENA_H
@@ -1,22 +1,10 @@
 #include "search_tools.h"
 #include "../game/gamestate.hpp"
 
-long SearchNode::hash() {
-    return ::board_hash(gs->board);
-}
-
-long board_hash(const Board & b) {
-    long hash = 0l;
-    long mask = 1l;
-
-    for (int x = 0; x < 8; ++x) {
-        for (int y = 0; y < 8; ++y) {
-            if (b.get(x, y) != EMPTY) {
-                hash |= mask;
-            }
-            mask <<= 1;
-        }
-    }
-
-    return hash;
+/**
+ * The board keeps its own Zobrist key up to date as moves are made, so there is nothing to compute.
+ * Lazy nodes have no board yet, and are given their key when they are materialised.
+ */
+ZobristKey SearchNode::hash() {
+    return gs ? gs->board.get_key() : 0;
 }
@@ -1,132 +1,336 @@
-#include <chrono>
 #include <pthread.h>
-#include <thread>
 #include <signal.h>
 #include "engine.h"
 #include "search.h"
 #include "search_tools.h"
 
-bool thread_has_stopped(pthread_t thread) {
-    return pthread_kill(thread, 0) == ESRCH;
+/**
+ * The number of nodes in all the given trees.
+ */
+int total_size(const std::vector<SearchNode *> & roots) {
+    int size = 0;
+    for (SearchNode * root : roots) {
+        size += subtree_size(root);
+    }
+    return size;
 }
 
-void * Engine::start(void * args) {
-
-    SearchArgs * search_args = (SearchArgs *) args;
-
-    reset_node_count();
-    reset_abort_flag();
+/**
+ * The number of nodes counted by all the given contexts.
+ */
+int total_node_count(const std::vector<SearchContext *> & contexts) {
+    int count = 0;
+    for (const SearchContext * ctx : contexts) {
+        count += ctx->node_count();
+    }
+    return count;
+}
 
-    auto start = std::chrono::high_resolution_clock::now();
-    greedy_search(search_args->root, search_args->cycles, search_args->game_history, search_args->metric_weights, *search_args->o);
-    auto stop = std::chrono::high_resolution_clock::now();
-    double secs = duration_cast<std::chrono::microseconds>(stop - start).count() / 1000000.0;
+/**
+ * Aborts the search of every tree, from outside the threads searching them.
+ */
+void abort_all(const std::vector<SearchContext *> & contexts) {
+    for (SearchContext * ctx : contexts) {
+        ctx->abort_analysis();
+    }
+}
 
-    *search_args->nodes_out = subtree_size(search_args->root);
-    *search_args->move_out = current_best_move(search_args->root);
-    *search_args->score_out = search_args->root->score;
-    *search_args->secs_out = secs;
-    return nullptr;
+/**
+ * The given best move, or if there is none because the search stopped before its root was expanded (as it may
+ * on a nearly empty clock), the root's first legal move, so that a move is still played. Only a position with
+ * no legal moves gets none.
+ */
+Move or_first_legal(const Move best, const SearchNode * root) {
+    if (!is_sentinel(best)) { return best; }
+    const std::vector<Move> moves = game_rules::legal_moves(root->gs->board);
+    return moves.empty() ? MOVE_SENTINEL : moves[0];
 }
 
-void * Engine::start_with_timeout(void * args) {
+void * Engine::start(void * args) {
 
     SearchArgs * search_args = (SearchArgs *) args;
 
-    reset_node_count();
-    reset_abort_flag();
-
-    pthread_t t_id;
-    pthread_create(
-        &t_id,
-        nullptr,
-        &start,
-        args
-    );
-
-    int n = (int) (search_args->seconds / 0.1);
-    for (int i = 0; i < n; ++i) {
-        std::this_thread::sleep_for(std::chrono::milliseconds((int)(0.1 * 1000)));
-        if (thread_has_stopped(t_id)) {
-            break;
-        }
+    Move best;
+    if (search_args->roots.size() > 1) {
+        best = ensemble_search(
+            search_args->roots,
+            search_args->contexts,
+            search_args->cycles,
+            search_args->game_history,
+            search_args->metric_weights,
+            search_args->threads);
+    } else {
+        greedy_search(search_args->root, *search_args->contexts[0], search_args->cycles, search_args->game_history, search_args->metric_weights, *search_args->o, search_args->threads);
+        best = current_best_move(search_args->root);
     }
+    double secs = search_args->contexts[0]->elapsed_seconds();
 
-    abort_analysis();
-    pthread_join(t_id, nullptr);
-    reset_abort_flag();
-
-    *search_args->nodes_out = subtree_size(search_args->root);
-    *search_args->move_out = current_best_move(search_args->root);
+    *search_args->nodes_out = total_size(search_args->roots);
+    *search_args->move_out = or_first_legal(best, search_args->root);
     *search_args->score_out = search_args->root->score;
+    *search_args->secs_out = secs;
 
+    {
+        std::lock_guard<std::mutex> guard(search_args->done_mutex);
+        search_args->done = true;
+    }
+    search_args->done_cv.notify_all();
     return nullptr;
 }
 
 void Engine::run() {
 
-    if (root == nullptr) { return; }
+    if (tree->root == nullptr) { return; }
 
+    join_search();
+    delete search_args;
     search_args =
-        new SearchArgs{
-            root,
+        new SearchArgs(
+            tree->root,
             cycle_limit,
             &obs,
-            timeout_seconds,
             &nodes,
             &best_move,
             &score,
             &actual_seconds,
             game_history,
-            metric_weights
-        };
-
-    set_node_limit(node_limit);
-
-    if (timeout_seconds == -1) {
-        pthread_create(
-            &t_id,
-            nullptr,
-            &Engine::start,
-            search_args
-        );
-    } else {
-        pthread_create(
-            &t_id,
-            nullptr,
-            &Engine::start_with_timeout,
-            search_args
-        );
+            metric_weights,
+            threads);
+    search_args->contexts.push_back(&tree->context);
+    for (const std::unique_ptr<SearchTree> & further : ensemble) {
+        search_args->roots.push_back(further->root);
+        search_args->contexts.push_back(&further->context);
+    }
+
+    // reset here rather than in the search thread, so that a kill straight after this is not lost;
+    // the search stops itself at its deadlines, so needs nothing to time it
+    for (SearchContext * ctx : search_args->contexts) {
+        ctx->reset();
+        ctx->set_deadlines(budget.soft_seconds, budget.hard_seconds);
+    }
+
+    joinable = pthread_create(
+        &t_id,
+        nullptr,
+        &Engine::start,
+        search_args
+    ) == 0;
+}
+
+/**
+ * Waits for the search thread to end, if it has been started and not yet waited for.
+ */
+void Engine::join_search() {
+    if (joinable) {
+        pthread_join(t_id, nullptr);
+        joinable = false;
+    }
+}
+
+/**
+ * Gives the search which is running the given time budget from now, in place of whatever it had (such
+ * as none, for a search started to run until killed). The budget for later runs is not changed.
+ */
+void Engine::limit_time(const TimeBudget time_budget) {
+    if (!search_args) { return; }
+    for (SearchContext * ctx : search_args->contexts) {
+        ctx->set_deadlines(time_budget.soft_seconds, time_budget.hard_seconds);
     }
 }
 
 Move Engine::blocking_run() {
     run();
-    pthread_join(t_id, nullptr);
-    reset_abort_flag();
-    reset_node_count();
-    if (auto_cleanup) { cleanup(); }
+    join_search();
     return best_move;
 }
 
 Move Engine::await() {
-    pthread_join(t_id, nullptr);
-    reset_abort_flag();
-    reset_node_count();
-    if (auto_cleanup) { cleanup(); }
+    join_search();
     return best_move;
 }
 
 void Engine::kill() {
-    abort_analysis();
-    pthread_join(t_id, nullptr);
-    reset_abort_flag();
-    nodes = node_count();
-    reset_node_count();
-    best_move = current_best_move(root);
-    if (auto_cleanup) { cleanup(); }
+    if (!search_args) { return; }
+    abort_all(search_args->contexts);
+    join_search();
+    nodes = total_node_count(search_args->contexts);
+}
+
+/**
+ * Asks the running search to stop, without waiting for it to: await then returns as soon as it has.
+ */
+void Engine::stop() {
+    if (!search_args) { return; }
+    abort_all(search_args->contexts);
 }
 
 bool Engine::has_finished() {
-    return thread_has_stopped(t_id);
+    if (!search_args) { return true; }
+    std::lock_guard<std::mutex> guard(search_args->done_mutex);
+    return search_args->done;
+}
+
+/**
+ * Waits until the running search has finished, or for the given number of seconds if that is sooner.
+ * Returns true if the search has finished.
+ */
+bool Engine::wait_for(const double seconds) {
+    if (!search_args) { return true; }
+    std::unique_lock<std::mutex> guard(search_args->done_mutex);
+    return search_args->done_cv.wait_for(
+        guard, std::chrono::duration<double>(seconds), [this] { return search_args->done; });
+}
+
+/**
+ * The number of nodes the current (or last) search has added to the tree so far, across all its trees.
+ */
+int Engine::live_node_count() const {
+    return search_args ? total_node_count(search_args->contexts) : 0;
+}
+
+/**
+ * The roots of all the trees the engine searches, its own first: there is more than one only in a
+ * root-parallel search.
+ */
+std::vector<SearchNode *> Engine::get_roots() const {
+    std::vector<SearchNode *> roots{tree->root};
+    for (const std::unique_ptr<SearchTree> & further : ensemble) {
+        roots.push_back(further->root);
+    }
+    return roots;
+}
+
+/**
+ * Sets the number of nodes each run from now on may add to the tree (or -1 for no limit), shared
+ * between the trees of a root-parallel search.
+ */
+void Engine::set_node_limit(const int limit) {
+    node_limit = limit;
+    tree->context.node_limit = tree_node_limit(limit, root_parallel);
+    for (std::unique_ptr<SearchTree> & further : ensemble) {
+        further->context.node_limit = tree_node_limit(limit, root_parallel);
+    }
+}
+
+/**
+ * The node of the tree for the position after the given moves from its root, or null if the tree
+ * has none. The given position, which starts as the root's, is moved on by the moves.
+ */
+SearchNode * Engine::node_after(const std::vector<Move> & moves, Gamestate & position) const {
+
+    SearchNode * node = tree->root;
+
+    for (const Move m : moves) {
+        SearchNode * next = nullptr;
+        if (node) {
+            for (SearchNode * child : node->children) {
+                if (equal_exactly(edge_move(node, child), m)) {
+                    next = child;
+                    break;
+                }
+            }
+        }
+        node = next;
+        position = Gamestate(position, m);
+    }
+    return node;
+}
+
+/**
+ * A new tree for the given position, with the same settings as the engine's own. If the given node
+ * of the engine's tree is for that position and has been built, its subtree is copied into the new
+ * tree; otherwise the new tree starts from just the position.
+ */
+std::unique_ptr<Engine::SearchTree> Engine::tree_at(
+        const SearchNode * node,
+        const Gamestate & position,
+        const std::vector<Gamestate> * history) const {
+
+    std::unique_ptr<SearchTree> at = new_tree();
+    if (node && !node->is_lazy()) {
+        at->root = copy_subtree(node, at->arena.get(), tree->context.table, at->context.table, history);
+    } else {
+        at->root = at->arena.new_root(position);
+    }
+    return at;
+}
+
+/**
+ * Moves the engine on to the position after the given moves from its root, once it has stopped
+ * searching. If the tree has a built node for that position, its subtree is copied into a new tree,
+ * so that its scores and visit counts carry over to the next search, and the old tree is freed in
+ * the background. Otherwise the new tree starts from just the position. The further trees of a
+ * root-parallel search always start again. The last search is forgotten, so until the next run there
+ * is no search to stop or limit, and no live node count.
+ * Returns true if a subtree was kept.
+ */
+bool Engine::advance(const std::vector<Move> & moves) {
+
+    // the last search's contexts belong to the trees about to be freed
+    join_search();
+    delete search_args;
+    search_args = nullptr;
+
+    Gamestate position = tree->root ? Gamestate(*tree->root->gs) : Gamestate(fen, game_phase);
+    const SearchNode * node = node_after(moves, position);
+    const bool kept = node && !node->is_lazy();
+
+    std::unique_ptr<SearchTree> advanced = tree_at(node, position, game_history);
+    release_in_background(std::move(tree));
+    tree = std::move(advanced);
+
+    for (std::unique_ptr<SearchTree> & further : ensemble) {
+        std::unique_ptr<SearchTree> fresh = new_tree();
+        fresh->root = fresh->arena.new_root(position);
+        release_in_background(std::move(further));
+        further = std::move(fresh);
+    }
+
+    fen = board_utils::board_to_fen(position.board);
+    game_phase = position.phase;
+    return kept;
+}
+
+/**
+ * A new engine with the same settings, for the position after the given moves from this one's root
+ * and with the given game leading to it, once this one has stopped searching. It starts from a copy
+ * of this engine's subtree for that position, if there is one, as advance would; this engine is left
+ * as it was, so the two can then search separately.
+ */
+std::unique_ptr<Engine> Engine::fork(const std::vector<Move> & moves, const std::vector<Gamestate> * history) const {
+
+    Gamestate position = tree->root ? Gamestate(*tree->root->gs) : Gamestate(fen, game_phase);
+    const SearchNode * node = node_after(moves, position);
+
+    std::unique_ptr<Engine> forked = std::make_unique<Engine>(
+        board_utils::board_to_fen(position.board),
+        obs,
+        node_limit,
+        cycle_limit,
+        budget,
+        tree->context.lazy_children,
+        tree->context.table != nullptr,
+        threads,
+        root_parallel,
+        position.phase,
+        history,
+        metric_weights);
+    forked->tree = tree_at(node, position, history);
+    return forked;
+}
+
+void * Engine::release(void * tree) {
+    delete (SearchTree *) tree;
+    return nullptr;
+}
+
+/**
+ * Frees a tree no longer needed on a thread of its own, so that the caller need not wait for it.
+ */
+void Engine::release_in_background(std::unique_ptr<SearchTree> tree) {
+    pthread_t t;
+    if (pthread_create(&t, nullptr, &Engine::release, tree.get()) == 0) {
+        tree.release();
+        pthread_detach(t);
+    }
 }
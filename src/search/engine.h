@@ -5,7 +5,14 @@
 #include "../../include/stase/game.h"
 #include "../game/gamestate.hpp"
 #include "search_tools.h"
+#include "arena.h"
+#include "transpositions.h"
+#include "search_context.h"
+#include "time_manager.h"
+#include <condition_variable>
 #include <csignal>
+#include <memory>
+#include <mutex>
 
 class Engine {
 
@@ -15,25 +22,88 @@ private:
         SearchNode * root;
         int cycles;
         Observer * o;
-        double seconds;
         int * nodes_out;
         Move * move_out;
         Eval * score_out;
         double * secs_out;
         const std::vector<Gamestate> * game_history;
         const MetricWeights * metric_weights;
+        int threads;
+        std::vector<SearchNode *> roots;
+        std::vector<SearchContext *> contexts;
+
+        // set, under the mutex, once the search has finished and written out its results
+        std::mutex done_mutex;
+        std::condition_variable done_cv;
+        bool done;
+
+        SearchArgs(
+                SearchNode * root,
+                int cycles,
+                Observer * o,
+                int * nodes_out,
+                Move * move_out,
+                Eval * score_out,
+                double * secs_out,
+                const std::vector<Gamestate> * game_history,
+                const MetricWeights * metric_weights,
+                int threads) :
+            root(root),
+            cycles(cycles),
+            o(o),
+            nodes_out(nodes_out),
+            move_out(move_out),
+            score_out(score_out),
+            secs_out(secs_out),
+            game_history(game_history),
+            metric_weights(metric_weights),
+            threads(threads),
+            roots{root},
+            contexts(),
+            done(false)
+        {}
     };
 
-    const std::string fen;
-    SearchNode * root;
+    /**
+     * A search tree, with its own memory, transpositions and context. The engine searches one, or
+     * several at once in a root-parallel search. The root is left for the owner to make.
+     */
+    struct SearchTree {
+        SearchArena arena;
+        TranspositionTable table;
+        SearchContext context;
+        SearchNode * root;
+
+        SearchTree(int threads, int node_limit, bool lazy, bool transpositions) :
+            arena(threads),
+            table(arena.get()),
+            context(node_limit, lazy, transpositions ? &table : nullptr),
+            root(nullptr)
+        {}
+    };
+
+    /**
+     * The node limit of each tree of a root-parallel search, which share the limit between them.
+     */
+    static int tree_node_limit(const int node_limit, const int trees) {
+        return node_limit == -1 ? -1 : (node_limit + trees - 1) / trees;
+    }
+
+    std::string fen;
+    GamePhase game_phase;
+    std::unique_ptr<SearchTree> tree;
+    std::vector<std::unique_ptr<SearchTree>> ensemble;
     Observer & obs;
     SearchArgs * search_args;
 
     pthread_t t_id;
-    int node_limit;
+    // set while the search thread has been started and not yet joined
+    bool joinable;
     int cycle_limit;
-    double timeout_seconds;
-    bool auto_cleanup;
+    TimeBudget budget;
+    int threads;
+    int root_parallel;
+    int node_limit;
 
     Move best_move;
     int nodes;
@@ -49,30 +119,41 @@ public:
             Observer & o,
             int node_limit,
             int cycle_limit,
-            double timeout_seconds,
-            bool cleanup,
+            TimeBudget budget,
+            bool lazy_children,
+            bool transpositions,
+            int threads,
+            int root_parallel,
             GamePhase game_phase,
             const std::vector<Gamestate> * game_history,
             const MetricWeights * metric_weights):
         fen(fen),
+        game_phase(game_phase),
+        tree(std::make_unique<SearchTree>(threads, tree_node_limit(node_limit, root_parallel), lazy_children, transpositions)),
         obs(o),
         search_args(nullptr),
 
         t_id(0),
-        node_limit(node_limit),
+        joinable(false),
         cycle_limit(cycle_limit),
-        timeout_seconds(timeout_seconds),
-        auto_cleanup(cleanup),
+        budget(budget),
+        threads(threads),
+        root_parallel(root_parallel),
+        node_limit(node_limit),
 
         best_move(MOVE_SENTINEL),
         nodes(0),
         score(zero()),
-        actual_seconds(timeout_seconds),
+        actual_seconds(budget.hard_seconds),
 
         game_history(game_history),
         metric_weights(metric_weights)
     {
-        root = new SearchNode(new Gamestate(fen, game_phase), new CandSet);
+        tree->root = tree->arena.new_root(fen, game_phase);
+        for (int i = 1; i < root_parallel; ++i) {
+            ensemble.push_back(new_tree());
+            ensemble.back()->root = ensemble.back()->arena.new_root(fen, game_phase);
+        }
 #ifdef ENGINE_STACK_TRACE
         signal(SIGSEGV, print_stack_trace_and_abort);
         signal(SIGABRT, print_stack_trace_and_abort);
@@ -81,31 +162,86 @@ public:
     }
 
     ~Engine() {
+        stop();
+        join_search();
         delete search_args;
-        if (auto_cleanup) { cleanup(); }
     }
 
     Observer & get_obs() const { return obs; }
     std::string get_fen() const { return fen; }
-    SearchNode * get_root() const { return root; }
+    SearchNode * get_root() const { return tree->root; }
+    std::vector<SearchNode *> get_roots() const;
     Move get_best_move() { return best_move; }
     int get_nodes_explored() const { return nodes; }
     Eval get_score() const { return score; }
     double get_actual_seconds() const { return actual_seconds; }
     const std::vector<Gamestate> * get_game_history() { return game_history; }
+    const SearchContext & get_context() const { return tree->context; }
+
+    /**
+     * Sets the time to search for on each run from now on (or -1 for no timeout).
+     */
+    void set_timeout(double secs) { budget = budget_for_move_time(secs); }
+
+    /**
+     * Sets the time budget for each run from now on (see time_manager.h).
+     */
+    void set_time_budget(TimeBudget time_budget) { budget = time_budget; }
+
+    void set_node_limit(int limit);
+
+    void limit_time(TimeBudget time_budget);
+
+    /**
+     * Sets the game leading to the root, to be used from the next run on. It must not change while a
+     * search is running.
+     */
+    void set_game_history(const std::vector<Gamestate> * history) { game_history = history; }
 
     void run();
     Move blocking_run();
     Move await();
     void kill();
+    void stop();
 
     bool has_finished();
-
-    void cleanup() { delete_tree(root); root = nullptr; }
+    bool wait_for(double seconds);
+    int live_node_count() const;
+
+    bool advance(const std::vector<Move> & moves);
+    std::unique_ptr<Engine> fork(const std::vector<Move> & moves, const std::vector<Gamestate> * history) const;
+
+    /**
+     * Frees the whole search tree at once, by resetting the arena it was allocated from (along
+     * with the transposition table's slots), and the further trees of a root-parallel search.
+     * The tree lives in the engine's arena, so it is freed with the engine anyway; this frees it
+     * sooner, for an engine kept after its search.
+     */
+    void cleanup() {
+        tree->table.clear();
+        tree->arena.reset();
+        tree->root = nullptr;
+        ensemble.clear();
+    }
 
 private:
+    /**
+     * An empty tree, for the engine to search with the same settings as its first.
+     */
+    std::unique_ptr<SearchTree> new_tree() const {
+        return std::make_unique<SearchTree>(
+            threads, tree->context.node_limit, tree->context.lazy_children, tree->context.table != nullptr);
+    }
+
+    SearchNode * node_after(const std::vector<Move> & moves, Gamestate & position) const;
+    std::unique_ptr<SearchTree> tree_at(const SearchNode * node, const Gamestate & position, const std::vector<Gamestate> * history) const;
+
+    void join_search();
+
+    static void release_in_background(std::unique_ptr<SearchTree> tree);
+    static void * release(void *);
+
     static void * start(void *);
-    static void * start_with_timeout(void *);
 };
 
 
@@ -116,8 +252,11 @@ private:
     Observer & obs;
     int nodes;
     int cycles;
-    double seconds;
-    bool cleanup;
+    TimeBudget budget;
+    bool lazy;
+    bool transpositions;
+    int threads;
+    int root_parallel;
     GamePhase game_phase;
     const std::vector<Gamestate> * game_history;
     const MetricWeights * metric_weights;
@@ -127,8 +266,11 @@ private:
             Observer & obs,
             int node_limit,
             int cycle_limit,
-            double timeout_seconds,
-            bool cleanup,
+            TimeBudget budget,
+            bool lazy,
+            bool transpositions,
+            int threads,
+            int root_parallel,
             GamePhase game_phase,
             const std::vector<Gamestate> * game_history,
             const MetricWeights * metric_weights) :
@@ -136,8 +278,11 @@ private:
         obs(obs),
         nodes(node_limit),
         cycles(cycle_limit),
-        seconds(timeout_seconds),
-        cleanup(cleanup),
+        budget(budget),
+        lazy(lazy),
+        transpositions(transpositions),
+        threads(threads),
+        root_parallel(root_parallel),
         game_phase(game_phase),
         game_history(game_history),
         metric_weights(metric_weights)
@@ -146,7 +291,7 @@ private:
 public:
 
     static EngineBuilder for_position(std::string fen_string) {
-        return EngineBuilder(fen_string, DEFAULT_OBSERVER, -1, -1, -1, true, OPENING, nullptr, &DEFAULT_METRIC_WEIGHTS);
+        return EngineBuilder(fen_string, DEFAULT_OBSERVER, -1, -1, budget_for_move_time(-1), false, true, 1, 1, OPENING, nullptr, &DEFAULT_METRIC_WEIGHTS);
     }
 
     static EngineBuilder for_starting_position() {
@@ -154,39 +299,82 @@ public:
     }
 
     EngineBuilder with_game_phase(GamePhase phase) {
-        return EngineBuilder(fen, obs, nodes, cycles, seconds, cleanup, phase, game_history, metric_weights);
+        return EngineBuilder(fen, obs, nodes, cycles, budget, lazy, transpositions, threads, root_parallel, phase, game_history, metric_weights);
     }
 
     EngineBuilder with_obs(Observer & observer) {
-        return EngineBuilder(fen, observer, nodes, cycles, seconds, cleanup, game_phase, game_history, metric_weights);
+        return EngineBuilder(fen, observer, nodes, cycles, budget, lazy, transpositions, threads, root_parallel, game_phase, game_history, metric_weights);
     }
 
     EngineBuilder with_node_limit(int node_limit) {
-        return EngineBuilder(fen, obs, node_limit, cycles, seconds, cleanup, game_phase, game_history, metric_weights);
+        return EngineBuilder(fen, obs, node_limit, cycles, budget, lazy, transpositions, threads, root_parallel, game_phase, game_history, metric_weights);
     }
 
     EngineBuilder with_cycle_limit(int cycle_limit) {
-        return EngineBuilder(fen, obs, nodes, cycle_limit, seconds, cleanup, game_phase, game_history, metric_weights);
+        return EngineBuilder(fen, obs, nodes, cycle_limit, budget, lazy, transpositions, threads, root_parallel, game_phase, game_history, metric_weights);
     }
 
     EngineBuilder with_timeout(double secs) {
-        return EngineBuilder(fen, obs, nodes, cycles, secs, cleanup, game_phase, game_history, metric_weights);
+        return EngineBuilder(fen, obs, nodes, cycles, budget_for_move_time(secs), lazy, transpositions, threads, root_parallel, game_phase, game_history, metric_weights);
+    }
+
+    /**
+     * Budgets the time for the move from a clock, with the given time remaining, increment, and moves to
+     * go before the next time control (or 0 if there is none), rather than a fixed time.
+     */
+    EngineBuilder with_clock(double remaining_seconds, double increment_seconds, int moves_to_go) {
+        return EngineBuilder(fen, obs, nodes, cycles, budget_for_clock(remaining_seconds, increment_seconds, moves_to_go), lazy, transpositions, threads, root_parallel, game_phase, game_history, metric_weights);
     }
 
-    EngineBuilder with_cleanup(bool auto_cleanup) {
-        return EngineBuilder(fen, obs, nodes, cycles, seconds, auto_cleanup, game_phase, game_history, metric_weights);
+    /**
+     * With lazy children, moves from the legal list are kept as bare edges, scored by a static
+     * estimate, until the search first goes into them.
+     */
+    EngineBuilder with_lazy_children(bool lazy_children) {
+        return EngineBuilder(fen, obs, nodes, cycles, budget, lazy_children, transpositions, threads, root_parallel, game_phase, game_history, metric_weights);
+    }
+
+    /**
+     * With transpositions (the default), a position reached by more than one move order is kept
+     * in one node shared between them, rather than being searched separately along each.
+     */
+    EngineBuilder with_transpositions(bool share_transpositions) {
+        return EngineBuilder(fen, obs, nodes, cycles, budget, lazy, share_transpositions, threads, root_parallel, game_phase, game_history, metric_weights);
+    }
+
+    /**
+     * With more than one thread, the threads search the one tree at once (see greedy_search).
+     */
+    EngineBuilder with_threads(int search_threads) {
+        return EngineBuilder(fen, obs, nodes, cycles, budget, lazy, transpositions, search_threads, root_parallel, game_phase, game_history, metric_weights);
+    }
+
+    /**
+     * With a root-parallel search of n trees, n separate trees are searched at once, each from its
+     * own share of the root's candidates, and their root moves are merged at the end to choose a
+     * move (see ensemble_search). Each tree is searched with the given number of threads.
+     */
+    EngineBuilder with_root_parallel(int trees) {
+        return EngineBuilder(fen, obs, nodes, cycles, budget, lazy, transpositions, threads, trees, game_phase, game_history, metric_weights);
     }
 
     EngineBuilder with_game_history(const std::vector<Gamestate> * _game_history) {
-        return EngineBuilder(fen, obs, nodes, cycles, seconds, cleanup, game_phase, _game_history, metric_weights);
+        return EngineBuilder(fen, obs, nodes, cycles, budget, lazy, transpositions, threads, root_parallel, game_phase, _game_history, metric_weights);
     }
 
     EngineBuilder with_metric_weights(const MetricWeights * _metric_weights) {
-        return EngineBuilder(fen, obs, nodes, cycles, seconds, cleanup, game_phase, game_history, _metric_weights);
+        return EngineBuilder(fen, obs, nodes, cycles, budget, lazy, transpositions, threads, root_parallel, game_phase, game_history, _metric_weights);
     }
 
     Engine build() {
-        return Engine(fen, obs, nodes, cycles, seconds, cleanup, game_phase, game_history, metric_weights);
+        return Engine(fen, obs, nodes, cycles, budget, lazy, transpositions, threads, root_parallel, game_phase, game_history, metric_weights);
+    }
+
+    /**
+     * Builds the engine on the heap, for an owner which keeps it from one search to the next.
+     */
+    std::unique_ptr<Engine> build_unique() {
+        return std::make_unique<Engine>(fen, obs, nodes, cycles, budget, lazy, transpositions, threads, root_parallel, game_phase, game_history, metric_weights);
     }
 };
 
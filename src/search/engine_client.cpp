@@ -5,7 +5,13 @@
 EngineClient::EngineClient() :
         gs(new Gamestate(Board::starting_pos())),
         nodes(0),
-        game_status(ONGOING)
+        record(gs->board),
+        game_status(ONGOING),
+        ponder(false),
+        ponder_hit(false),
+        forking(false),
+        fork_thread(0),
+        ponder_move(MOVE_SENTINEL)
 {
     game_history.push_back(*gs);
 }
@@ -13,7 +19,13 @@ EngineClient::EngineClient() :
 EngineClient::EngineClient(const char * fen) :
         gs(new Gamestate(std::string(fen))),
         nodes(0),
-        game_status(ONGOING)
+        record(gs->board),
+        game_status(ONGOING),
+        ponder(false),
+        ponder_hit(false),
+        forking(false),
+        fork_thread(0),
+        ponder_move(MOVE_SENTINEL)
 {
     game_history.push_back(*gs);
 }
@@ -21,7 +33,13 @@ EngineClient::EngineClient(const char * fen) :
 EngineClient::EngineClient(const std::string & fen) :
         gs(new Gamestate(fen)),
         nodes(0),
-        game_status(ONGOING)
+        record(gs->board),
+        game_status(ONGOING),
+        ponder(false),
+        ponder_hit(false),
+        forking(false),
+        fork_thread(0),
+        ponder_move(MOVE_SENTINEL)
 {
     game_history.push_back(*gs);
 }
@@ -29,29 +47,76 @@ EngineClient::EngineClient(const std::string & fen) :
 EngineClient::EngineClient(const std::string & fen, GamePhase phase) :
         gs(new Gamestate(fen, phase)),
         nodes(0),
-        game_status(ONGOING)
+        record(gs->board),
+        game_status(ONGOING),
+        ponder(false),
+        ponder_hit(false),
+        forking(false),
+        fork_thread(0),
+        ponder_move(MOVE_SENTINEL)
 {
     game_history.push_back(*gs);
 }
 
+EngineClient::~EngineClient() {
+    stop_pondering();
+}
+
+/**
+ * Moves the engine's tree on past the moves played since it last searched, keeping the subtree for the
+ * position reached, if it has one.
+ */
+void EngineClient::advance_engine() {
+    if (engine && !unplayed.empty()) {
+        engine->advance(unplayed);
+    }
+    unplayed.clear();
+}
+
 const char * EngineClient::get_computer_move(double think_time) {
+    return play_move(budget_for_move_time(think_time));
+}
+
+const char * EngineClient::get_computer_move_on_clock(double remaining_seconds, double increment_seconds, int moves_to_go) {
+    return play_move(budget_for_clock(remaining_seconds, increment_seconds, moves_to_go));
+}
+
+/**
+ * Searches for a move within the given time budget, and plays it.
+ */
+const char * EngineClient::play_move(const TimeBudget budget) {
 #ifdef PYBIND_DEBUG_LOG
     std::cout << "[C++] entering get_computer_move\n";
 #endif
     if (game_has_ended()) {
         return (new std::string(name(game_status)))->c_str();
     }
-    Engine engine =
-        EngineBuilder::for_position(board_utils::board_to_fen(gs->board))
-            .with_timeout(think_time)
-            .with_game_history(&game_history)
-            .build();
-    std::string * uci = new string(move2uci(engine.blocking_run()));
-    gs = new Gamestate(*gs, uci2move(*uci));
-    nodes = engine.get_nodes_explored();
-    eval_str = etos(engine.get_score());
+    await_fork();
+    Move move;
+    if (ponder_hit) {
+        move = finish_ponder_hit(budget);
+    } else {
+        advance_engine();
+        if (!engine) {
+            engine =
+                EngineBuilder::for_position(board_utils::board_to_fen(gs->board))
+                    .with_game_history(&game_history)
+                    .build_unique();
+        }
+        engine->set_time_budget(budget);
+        move = engine->blocking_run();
+    }
+    std::string * uci = new string(move2uci(move));
+    gs = new Gamestate(*gs, move);
+    nodes = engine->get_nodes_explored();
+    eval_str = etos(engine->get_score());
+    // the tree is moved on when the opponent replies, straight to the position after both moves
+    unplayed.push_back(move);
     game_history.push_back(*gs);
     update_status();
+    if (ponder && !game_has_ended()) {
+        start_pondering();
+    }
 #ifdef PYBIND_DEBUG_LOG
     std::cout << "[C++] exiting get_computer_move\n";
 #endif
@@ -66,14 +131,125 @@ void EngineClient::register_opponent_move(const char * uci) {
 #ifdef PYBIND_DEBUG_LOG
     std::cout << "[C++] entering register_opponent_move\n";
 #endif
-    gs = new Gamestate(*gs, uci2move(string(uci)));
+    const Move move = uci2move(string(uci));
+    gs = new Gamestate(*gs, move);
     game_history.push_back(*gs);
+    unplayed.push_back(move);
+    await_fork();
+    if (ponder_engine && equal_exactly(move, ponder_move)) {
+        // the engine which has been pondering is already searching this position, so it carries on
+        engine = std::move(ponder_engine);
+        ponder_move = MOVE_SENTINEL;
+        ponder_hit = true;
+        unplayed.clear();
+    } else {
+        stop_pondering();
+        advance_engine();
+    }
     update_status();
+    if (game_has_ended()) {
+        stop_pondering();
+    }
 #ifdef PYBIND_DEBUG_LOG
     std::cout << "[C++] exiting register_opponent_move\n";
 #endif
 }
 
+void EngineClient::set_ponder(const bool on) {
+    ponder = on;
+    if (!ponder) {
+        stop_pondering();
+    }
+}
+
+Move EngineClient::get_ponder_move() const {
+    return ponder_move;
+}
+
+/**
+ * Picks the reply the engine expects to the move just played (the next move of its trust line), and leaves a
+ * fork of the engine searching the position after it until the opponent's move comes in. The engine itself
+ * stays as it is, so that its tree can still be moved on if some other reply is played.
+ * Copying the tree takes a while, so it is done on another thread, and our move is returned meanwhile.
+ */
+void EngineClient::start_pondering() {
+    const std::vector<SearchNode *> line = retrieve_trust_line(engine->get_root());
+    if (line.size() < 3) { return; }
+
+    ponder_move = edge_move(line[1], line[2]);
+    ponder_line = {unplayed.back(), ponder_move};
+    // the search reads the game history throughout, so it gets its own copy, which stays as it is
+    ponder_history = game_history;
+    ponder_history.emplace_back(*gs, ponder_move);
+
+    forking = true;
+    pthread_create(&fork_thread, nullptr, &EngineClient::fork_ponder_engine, this);
+}
+
+/**
+ * Forks the engine along the ponder line and starts the fork searching. Nothing else touches the engine, or
+ * the ponder engine, until this thread has been joined.
+ */
+void * EngineClient::fork_ponder_engine(void * args) {
+    EngineClient * client = (EngineClient *) args;
+    client->ponder_engine = client->engine->fork(client->ponder_line, &client->ponder_history);
+    client->ponder_engine->set_timeout(-1);
+    client->ponder_engine->set_node_limit(__engine_params::PONDER_NODE_LIMIT);
+    client->ponder_engine->run();
+    return nullptr;
+}
+
+/**
+ * Waits for the ponder engine to be forked, if it is being.
+ */
+void EngineClient::await_fork() {
+    if (forking) {
+        pthread_join(fork_thread, nullptr);
+        forking = false;
+    }
+}
+
+/**
+ * Stops and discards any search going on in the background, whether of an expected reply or, after
+ * it was played, of our next move.
+ */
+void EngineClient::stop_pondering() {
+    await_fork();
+    ponder_move = MOVE_SENTINEL;
+    if (ponder_engine) {
+        ponder_engine->kill();
+        ponder_engine.reset();
+    }
+    if (ponder_hit) {
+        engine->kill();
+        engine->set_node_limit(-1);
+        engine->set_game_history(&game_history);
+        ponder_hit = false;
+    }
+}
+
+/**
+ * Lets the search which has been going on since the expected reply was played carry on within the given
+ * budget from now (unless it finishes first), and returns its move. If it already stopped at the ponder
+ * node limit, it is run again on the same tree within the budget, without the limit.
+ */
+Move EngineClient::finish_ponder_hit(const TimeBudget budget) {
+    Move move;
+    if (engine->has_finished()) {
+        engine->set_node_limit(-1);
+        engine->set_game_history(&game_history);
+        engine->set_time_budget(budget);
+        move = engine->blocking_run();
+    } else {
+        engine->limit_time(budget);
+        move = engine->await();
+        engine->set_node_limit(-1);
+        engine->set_game_history(&game_history);
+    }
+    ponder_hit = false;
+    return move;
+}
+
 int EngineClient::get_node_count() const {
     return nodes;
 }
@@ -95,11 +271,8 @@ GameStatus EngineClient::current_status() const {
 }
 
 void EngineClient::update_status() {
-    std::vector<Board> boards(game_history.size());
-    for (const Gamestate & gamestate : game_history) {
-        boards.push_back(gamestate.board);
-    }
-    game_status = game_rules::check_status(boards);
+    record.push(gs->board);
+    game_status = record.status(gs->board);
 }
 
 /**
@@ -113,16 +286,25 @@ extern "C" {
     EngineClient * get_client_for_position(const char * fen) {
         return new EngineClient(fen);
     }
+    void free_client(EngineClient * client) {
+        delete client;
+    }
     void register_opponent_move(EngineClient * client, const char * uci) {
         client->register_opponent_move(uci);
     }
     const char * get_computer_move(EngineClient * client, double seconds) {
         return client->get_computer_move(seconds);
     }
+    const char * get_computer_move_on_clock(EngineClient * client, double remaining, double increment, int moves_to_go) {
+        return client->get_computer_move_on_clock(remaining, increment, moves_to_go);
+    }
     int get_node_count(EngineClient * client) {
         return client->get_node_count();
     }
     const char * get_eval_str(EngineClient * client) {
         return client->get_eval_cstr();
     }
+    void set_ponder(EngineClient * client, bool on) {
+        client->set_ponder(on);
+    }
 }
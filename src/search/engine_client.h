@@ -2,23 +2,46 @@
 #define STASE_ENGINE_CLIENT_H
 
 #include "../../include/stase/game.h"
+#include "time_manager.h"
+
+#include <memory>
+#include <pthread.h>
+
+class Engine;
 
 /**
  * THe EngineClient provides an easy interface to play a game involving an engine. Moves can be fetched and opponent
  * moves can be added. The game-history is tracked so that 3-fold repetition is correctly accounted for.
+ * The engine's search tree is kept from move to move: when the game reaches a position already in the tree, the
+ * search carries on from what was found there.
+ * With pondering on, the engine searches on the opponent's time too: after each move of its own, it searches the
+ * position after the reply it expects, and if that reply is played it carries on with that search.
  */
 class EngineClient {
     Gamestate * gs;
     int nodes;
     std::string eval_str;
     std::vector<Gamestate> game_history;
+    GameRecord record;
     GameStatus game_status;
+    std::unique_ptr<Engine> engine;
+    std::vector<Move> unplayed;
+    bool ponder;
+    bool ponder_hit;
+    // the ponder engine is forked on its own thread, which must be joined before either engine is touched
+    bool forking;
+    pthread_t fork_thread;
+    std::unique_ptr<Engine> ponder_engine;
+    Move ponder_move;
+    std::vector<Move> ponder_line;
+    std::vector<Gamestate> ponder_history;
 
 public:
     EngineClient();
     explicit EngineClient(const char * fen);
     explicit EngineClient(const std::string & fen);
     explicit EngineClient(const std::string & fen, GamePhase phase);
+    ~EngineClient();
 
     /**
      * Fetches a move in the current position and updates the engine to the resulting position.
@@ -26,6 +49,12 @@ public:
      */
     const char * get_computer_move(double think_time);
 
+    /**
+     * As get_computer_move, but budgets the time to think from a clock, with the given time remaining and increment
+     * (in seconds), and moves to go before the next time control (or 0 if there is none).
+     */
+    const char * get_computer_move_on_clock(double remaining_seconds, double increment_seconds, int moves_to_go);
+
     /**
      * Updates the engine according to the given move (eg played by an opponent) so that
      * subsequent get_move calls reference the resulting position.
@@ -44,8 +73,25 @@ public:
 
     GameStatus current_status() const;
 
+    /**
+     * Turns pondering on or off, from the next move on (turning it off also stops any search going on).
+     */
+    void set_ponder(bool on);
+
+    /**
+     * The reply being pondered on, or the sentinel if there is none.
+     */
+    Move get_ponder_move() const;
+
 private:
     void update_status();
+    void advance_engine();
+    void start_pondering();
+    static void * fork_ponder_engine(void * client);
+    void await_fork();
+    void stop_pondering();
+    const char * play_move(TimeBudget budget);
+    Move finish_ponder_hit(TimeBudget budget);
 };
 
 #endif //STASE_ENGINE_CLIENT_H
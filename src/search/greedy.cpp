@@ -3,53 +3,65 @@
 #include "search.h"
 #include "game.h"
 #include "search_tools.h"
+#include "transpositions.h"
+#include "time_manager.h"
 #include "../game/gamestate.hpp"
 
+#include <pthread.h>
+
 /**
- * @return true if there are three identical positions on the path from the given node to the root.
- * Note that this is not sufficient to avoid threefold repetition: you also need to know about moves
- * from the whole game.
+ * Counts the earlier occurrences of the given position, up to the given maximum, on the path from the given node
+ * (which holds the position before it) to the root and then back through the game. Three earlier occurrences make
+ * a draw by repetition. The path is followed by parent pointers, so below a node shared by transposition it is the
+ * path that node was first reached by; nodes are only shared just after an irreversible move, though, so no
+ * position on either path before it can occur again below it, and the count is the same whichever path is taken
+ * (see link_transpositions).
  */
-bool threefold_rep(const SearchNode * node, const std::vector<Gamestate> * game_history) {
+int earlier_occurrences(
+        const Board & board,
+        const SearchNode * parent,
+        const std::vector<Gamestate> * game_history,
+        const int max) {
 
+    const ZobristKey key = board.get_key();
     int count = 0;
-    const SearchNode * current = node->parent;
+    const SearchNode * current = parent;
 
     while (current) {
-        if (current->board_hash == node->board_hash && node->gs->board.equivalent(current->gs->board)) {
-            if (++count == 3) {
-                return true;
+        if (current->board_hash == key && board.equivalent(current->gs->board)) {
+            if (++count == max) {
+                return count;
             }
         }
         if (current->parent) {
             // check for pawn moves!
-            Piece moved = current->parent->gs->board.get(current->move.from);
+            Piece moved = current->parent->gs->board.get(current->move.from());
             if (type(moved) == PAWN) {
-                return false;
+                return count;
             }
         }
         current = current->parent;
     }
 
-    if (!game_history) { return false; }
+    if (!game_history) { return count; }
 
     // we now search the board history
     for (int i = (int)game_history->size() - 1; i >= 0; --i) {
         const Gamestate & gs = game_history->operator[](i);
-        if (board_hash(gs.board) == node->board_hash && gs.board.equivalent(node->gs->board)) {
-            if (++count == 3) {
-                return true;
+        if (gs.board.get_key() == key && gs.board.equivalent(board)) {
+            if (++count == max) {
+                return count;
             }
         }
         if (i > 0) {
             // check for pawn moves!
-            Piece moved = game_history->operator[](i - 1).board.get(gs.last_move.from);
+            Piece moved = game_history->operator[](i - 1).board.get(gs.last_move.from());
             if (type(moved) == PAWN) {
-                return false;
+                return count;
             }
         }
     }
-    return false;
+    return count;
 }
 
 /**
@@ -59,8 +71,10 @@ bool threefold_rep(const SearchNode * node, const std::vector<Gamestate> * game_
  */
 void add_legal_moves(SearchNode * node) {
 
-    std::vector<Move> legals = game_rules::legal_moves(node->gs->board);
-    if (legals.empty()) {
+    Move legals_arr[MAX_LEGAL_MOVES];
+    ptr_vec<Move> legals(legals_arr, MAX_LEGAL_MOVES);
+    game_rules::legal_moves(node->gs->board, legals);
+    if (legals.size() == 0) {
         if (node->gs->in_check) {
             node->gs->game_over = true;
             node->terminal = true;
@@ -75,15 +89,25 @@ void add_legal_moves(SearchNode * node) {
         }
     }
 
-    std::vector<Move> approved;
+    std::pmr::vector<Move> & approved = node->cand_set->legal;
+    approved.clear();
     approved.reserve(legals.size());
 
-    for (const Move & legal : legals) {
+    // the moves to the existing children, which for those reached by transposition are not their own
+    Move created_arr[MAX_LEGAL_MOVES];
+    ptr_vec<Move> created(created_arr, MAX_LEGAL_MOVES);
+    for (const SearchNode * j : node->children) {
+        created.push(edge_move(node, j));
+    }
+
+    for (int i = 0; i < legals.size(); ++i) {
+
+        const Move legal = legals[i];
 
         // check in children
         bool already_created = false;
-        for (const SearchNode * j : node->children) {
-            if (equal_exactly(j->move, legal)) {
+        for (int j = 0; j < created.size(); ++j) {
+            if (equal_exactly(created[j], legal)) {
                 already_created = true;
                 break;
             }
@@ -93,8 +117,89 @@ void add_legal_moves(SearchNode * node) {
             approved.push_back(legal);
         }
     }
+}
+
+/**
+ * Generates the candidates of a newly built node and scores it: as mate if it has no moves, as a
+ * draw if it repeats a position for the third time, and otherwise by the heuristic.
+ */
+void evaluate_new_node(
+        SearchNode * node,
+        const SearchContext & ctx,
+        const std::vector<Gamestate> * game_history,
+        const MetricWeights * metric_weights,
+        Observer & obs) {
+
+    const int earlier = earlier_occurrences(node->gs->board, node->parent, game_history, 3);
+
+    node->cand_set = cands(*node->gs, node->cand_set);
+    if (node->gs->game_over) {
+        node->score =
+            node->gs->board.get_white()
+                ? white_has_been_mated()
+                : black_has_been_mated();
+    } else if (earlier == 3) {
+        node->score = zero();
+        node->gs->game_over = true;
+        obs.register_event(node, THREEFOLD_REP);
+    } else {
+        node->score = heur(*node->gs, metric_weights);
+    }
 
-    node->cand_set->legal = approved;
+    // only positions just after an irreversible move are shared (see link_transpositions)
+    if (ctx.table && node->gs->board.get_halfmoves() == 0) {
+        ctx.table->insert(node);
+    }
+}
+
+/**
+ * Builds a lazy node and replaces its estimated score with a real one, as though it had been
+ * created in full by deepen. Does nothing to a node which is not lazy.
+ */
+void materialise_and_evaluate(
+        SearchNode * node,
+        SearchContext & ctx,
+        const std::vector<Gamestate> * game_history,
+        const MetricWeights * metric_weights,
+        Observer & obs) {
+
+    if (!node->is_lazy()) { return; }
+    materialise(node, ctx);
+    evaluate_new_node(node, ctx, game_history, metric_weights, obs);
+}
+
+/**
+ * Links the given node to the existing nodes for any of the moves which lead to a position already
+ * in the transposition table, and puts the rest of the moves into fresh, to have new children made
+ * for them.
+ *
+ * Whether a position below a shared node is a repetition depends on the path taken to it, back to the
+ * last irreversible move. So only positions reached by an irreversible move (a capture or a pawn move,
+ * which resets the halfmove clock) are shared, by every path to them: nothing before such a move can
+ * be repeated after it, so the subtree below is the same on every path. Transpositions by reversible
+ * moves alone are searched separately along each path.
+ */
+void link_transpositions(
+        SearchNode * node,
+        const std::pmr::vector<Move> & moves,
+        ptr_vec<Move> & fresh,
+        const SearchContext & ctx) {
+
+    const TranspositionTable * table = ctx.table;
+
+    for (const Move m : moves) {
+        if (table) {
+            const Board b = node->gs->board.successor_hard(m);
+            SearchNode * existing = b.get_halfmoves() == 0 ? table->find(b) : nullptr;
+            if (existing) {
+                lock(existing);
+                link_child(node, existing, m);
+                unlock(existing);
+                continue;
+            }
+        }
+        fresh.push(m);
+    }
 }
 
 /**
@@ -102,19 +207,30 @@ void add_legal_moves(SearchNode * node) {
  * in the tree. If the depth given is greater than 1, then this will be done recursively
  * to create a new subtree of size equal to the depth.
  * If given a depth of 0, nothing will happen.
+ * The caller holds the node's lock, and the lock of each child is taken before deepening it.
+ * If the search is stopped, nothing more is created, but the nodes already deepened are still
+ * rescored on the way back up.
  * Returns true if new nodes are created, false otherwise.
  */
 bool deepen(
         SearchNode * node,
         CandList cand_list,
         int depth,
+        SearchContext & ctx,
         const std::vector<Gamestate> * game_history,
         const MetricWeights * metric_weights,
         Observer & obs,
         bool burst=false) {
 
     // exit conditions
-    check_abort();
+    if (check_abort(ctx)) {
+        return false;
+    }
+    if (node->is_lazy()) {
+        // a lazy node is only built when the search goes beyond it
+        if (depth == 0) { return false; }
+        materialise_and_evaluate(node, ctx, game_history, metric_weights, obs);
+    }
     if (node->gs->game_over) {
         update_terminal(node, obs);
         return false;
@@ -129,7 +245,7 @@ bool deepen(
         if (node->visit_count <= __engine_params::CRITICAL_THRESHOLD
               && quiess(*node->gs) >= __engine_params::QUIESS_THRESHOLD) {
             obs.register_event(node, BEGIN_BURST);
-            return deepen(node, CRITICAL, __engine_params::BURST_DEPTH, game_history, metric_weights, obs, true);
+            return deepen(node, CRITICAL, __engine_params::BURST_DEPTH, ctx, game_history, metric_weights, obs, true);
         } else {
             return false;
         }
@@ -155,14 +271,17 @@ bool deepen(
 
     // fetch list to extend
     if (cand_list == CRITICAL) { node->cand_set->order_list(cand_list); }
-    const std::vector<Move> & list = node->cand_set->get_list(cand_list);
+    const std::pmr::vector<Move> & list = node->cand_set->get_list(cand_list);
 
     if (list.empty()) {
         // even if the list is empty, we still need to recurse up to the given depth
         bool changes = false;
         for (SearchNode * i : node->children) {
-            changes = deepen(i, cand_list, depth - 1, game_history, metric_weights, obs, burst)
+            if (i->parent != node) { continue; }
+            lock(i);
+            changes = deepen(i, cand_list, depth - 1, ctx, game_history, metric_weights, obs, burst)
                         || changes;
+            unlock(i);
         }
         update_score(node);
         update_terminal(node, obs);
@@ -170,32 +289,30 @@ bool deepen(
         return changes;
     }
 
-    // create child for each move in the list (appending)
+    // create child for each move in the list (appending), sharing positions already in the tree
     int c = node->children.size();
-    for (const Move m : list) {
-        SearchNode * child = new_node(node, m);
-        child->cand_set = cands(*child->gs, child->cand_set);
-        if (child->gs->game_over) {
-            child->score =
-                child->gs->board.get_white()
-                    ? white_has_been_mated()
-                    : black_has_been_mated();
-        } else if (threefold_rep(child, game_history)) {
-            child->score = zero();
-            child->gs->game_over = true;
-            obs.register_event(child, THREEFOLD_REP);
-        } else {
-            child->score = heur(*child->gs, metric_weights);
+    Move fresh_arr[MAX_LEGAL_MOVES];
+    ptr_vec<Move> fresh(fresh_arr, MAX_LEGAL_MOVES);
+    link_transpositions(node, list, fresh, ctx);
+
+    const bool lazy = cand_list == LEGAL && ctx.lazy_children;
+    SearchNode * block = new_children(node, fresh, lazy, ctx);
+    if (!lazy) {
+        for (int i = 0; i < fresh.size(); ++i) {
+            evaluate_new_node(block + i, ctx, game_history, metric_weights, obs);
         }
-        node->children.push_back(child);
     }
     node->cand_set->clear_list(cand_list);
 
-    // recurse as appropriate
+    // recurse as appropriate. Transpositions are left as they are: they were searched along the
+    // path they were created on, and are only scored from here
     bool changes = (node->children.size() != c);
     for (SearchNode * child : node->children) {
-        changes = deepen(child, cand_list, depth - 1, game_history, metric_weights, obs, burst)
+        if (child->parent != node) { continue; }
+        lock(child);
+        changes = deepen(child, cand_list, depth - 1, ctx, game_history, metric_weights, obs, burst)
                     || changes;
+        unlock(child);
     }
 
     update_score(node);
@@ -212,11 +329,24 @@ bool deepen(
  */
 void visit_node(
         SearchNode * node,
+        SearchContext & ctx,
         const std::vector<Gamestate> * game_history,
         const MetricWeights * metric_weights,
         Observer & obs) {
 
-    if (!node || node->gs->game_over || node->terminal) {
+    if (!node) { return; }
+
+    if (check_abort(ctx)) {
+        // a stopped search still rescores each node it returns through, to keep it consistent with its children
+        lock(node);
+        update_score(node);
+        unlock(node);
+        return;
+    }
+
+    lock(node);
+    if (node->gs->game_over || node->terminal) {
+        unlock(node);
         return;
     }
 
@@ -224,36 +354,38 @@ void visit_node(
 
     switch (node->visit_count) {
         case __engine_params::CRITICAL_THRESHOLD:
-            deepen(node, CRITICAL, __engine_params::CRITICAL_DEPTH, game_history, metric_weights, obs);
+            deepen(node, CRITICAL, __engine_params::CRITICAL_DEPTH, ctx, game_history, metric_weights, obs);
             obs.close_event(node, VISIT_NODE, nullptr, 1);
-            return;
+            break;
         case __engine_params::MEDIAL_THRESHOLD:
-            deepen(node, MEDIAL, __engine_params::MEDIAL_DEPTH, game_history, metric_weights, obs);
+            deepen(node, MEDIAL, __engine_params::MEDIAL_DEPTH, ctx, game_history, metric_weights, obs);
             obs.close_event(node, VISIT_NODE, nullptr, 2);
-            return;
+            break;
         case __engine_params::FINAL_THRESHOLD:
-            deepen(node, FINAL, __engine_params::FINAL_DEPTH, game_history, metric_weights, obs);
+            deepen(node, FINAL, __engine_params::FINAL_DEPTH, ctx, game_history, metric_weights, obs);
             obs.close_event(node, VISIT_NODE, nullptr, 3);
-            return;
+            break;
         case __engine_params::LEGAL_THRESHOLD:
             if (node->cand_set->legal.empty()) {
                 add_legal_moves(node);
                 if (node->terminal) {
                     // stalemate could have been detected
                     obs.close_event(node, VISIT_NODE, nullptr, 4);
-                    return;
+                    break;
                 }
             }
-            deepen(node, LEGAL, __engine_params::LEGAL_DEPTH, game_history, metric_weights, obs);
+            deepen(node, LEGAL, __engine_params::LEGAL_DEPTH, ctx, game_history, metric_weights, obs);
             obs.close_event(node, VISIT_NODE, nullptr, 5);
-            return;
+            break;
         default:
             ++node->visit_count;
             update_score(node);
             update_terminal(node, obs);
             obs.close_event(node, VISIT_NODE, nullptr, 6);
-            return;
+            break;
     }
+
+    unlock(node);
 }
 
 /**
@@ -264,11 +396,17 @@ void visit_node(
  */
 bool force_visit(
         SearchNode * node,
+        SearchContext & ctx,
         const std::vector<Gamestate> * game_history,
         const MetricWeights * metric_weights,
         Observer & obs) {
 
-    if (!node || node->gs->game_over || node->terminal) {
+    if (!node || check_abort(ctx)) { return false; }
+
+    lock(node);
+    materialise_and_evaluate(node, ctx, game_history, metric_weights, obs);
+    if (node->gs->game_over || node->terminal) {
+        unlock(node);
         return false;
     }
 
@@ -278,17 +416,17 @@ bool force_visit(
 
     if (node->visit_count <= __engine_params::CRITICAL_THRESHOLD) {
         node->visit_count = __engine_params::CRITICAL_THRESHOLD;
-        changes = deepen(node, CRITICAL, __engine_params::CRITICAL_DEPTH, game_history, metric_weights, obs);
+        changes = deepen(node, CRITICAL, __engine_params::CRITICAL_DEPTH, ctx, game_history, metric_weights, obs);
     }
 
     if (!changes && node->visit_count < __engine_params::MEDIAL_THRESHOLD) {
         node->visit_count = __engine_params::MEDIAL_THRESHOLD;
-        changes = deepen(node, MEDIAL, __engine_params::MEDIAL_DEPTH, game_history, metric_weights, obs);
+        changes = deepen(node, MEDIAL, __engine_params::MEDIAL_DEPTH, ctx, game_history, metric_weights, obs);
     }
 
     if (!changes && node->visit_count < __engine_params::FINAL_THRESHOLD) {
         node->visit_count = __engine_params::FINAL_THRESHOLD;
-        changes = deepen(node, FINAL, __engine_params::FINAL_DEPTH, game_history, metric_weights, obs);
+        changes = deepen(node, FINAL, __engine_params::FINAL_DEPTH, ctx, game_history, metric_weights, obs);
     }
 
     if (!changes) {
@@ -299,6 +437,7 @@ bool force_visit(
     }
 
     obs.close_event(node, FORCE_VISIT);
+    unlock(node);
     return changes;
 }
 
@@ -310,6 +449,7 @@ bool force_visit(
  */
 bool force_visit_best_line(
         SearchNode * node,
+        SearchContext & ctx,
         const std::vector<Gamestate> * game_history,
         const MetricWeights * metric_weights,
         Observer & obs) {
@@ -317,43 +457,102 @@ bool force_visit_best_line(
     if (node == nullptr) { return false; }
 
     obs.open_event(node, FORCE_VISIT_LINE);
-    bool changes = force_visit(node->best_child, game_history, metric_weights, obs);
-    changes = force_visit(node, game_history, metric_weights, obs) || changes;
+    bool changes = force_visit(node->best_child, ctx, game_history, metric_weights, obs);
+    changes = force_visit(node, ctx, game_history, metric_weights, obs) || changes;
 
     obs.close_event(node, FORCE_VISIT_LINE);
     return changes;
 }
 
+/**
+ * The child to follow the best line into. This is the best child, unless other threads are on lines
+ * through it already: then each thread on a line through a child counts against it as a loss of
+ * VIRTUAL_LOSS, and the best child after those losses is taken instead. The caller holds the node's lock.
+ */
+SearchNode * select_child(const SearchNode * node) {
+
+    SearchNode * best = node->best_child;
+    if (!best || best->in_flight.load(std::memory_order_relaxed) == 0) {
+        return best;
+    }
+
+    const bool white = node->gs->board.get_white();
+    Eval best_score = 0;
+    best = nullptr;
+
+    for (SearchNode * child : node->children) {
+        Eval score = child->score;
+        if (!is_mate(score)) {
+            const int loss = __engine_params::VIRTUAL_LOSS * child->in_flight.load(std::memory_order_relaxed);
+            score = white ? score - loss : score + loss;
+        }
+        if (!best || (white ? score > best_score : score < best_score)) {
+            best_score = score;
+            best = child;
+        }
+    }
+    return best;
+}
+
 /**
  * Follows the best line from root to leaf, visiting each node in reverse (first
  * the leaf node, then back up to the root. If a swing is detected at any point,
  * then the path from the leaf back up to the current node is visited again, at
  * most once.
+ * Each node is visited at most once in a given cycle, as it would be in a tree, even
+ * if it is shared by transposition and so reached along more than one line.
+ * When several threads are searching, the line each follows is swayed by the others'
+ * (see select_child), and no lock is held while going down it.
  * Returns true if any descendant of the given node caused (and executed) a swing,
  * and false otherwise.
  */
 bool visit_best_line(
         SearchNode * node,
+        const unsigned cycle,
+        SearchContext & ctx,
         const std::vector<Gamestate> * game_history,
         const MetricWeights * metric_weights,
         Observer & obs) {
 
-    if (node == nullptr) { return false; }
+    if (node == nullptr || check_abort(ctx)) { return false; }
+
+    lock(node);
+    if (node->visit_cycle == cycle) {
+        unlock(node);
+        return false;
+    }
+    node->visit_cycle = cycle;
 
+    // building a lazy node is not a swing: its estimate was never searched
+    materialise_and_evaluate(node, ctx, game_history, metric_weights, obs);
     Eval prior = node->score;
+    SearchNode * next = select_child(node);
+    unlock(node);
+
     obs.open_event(node, VISIT_LINE);
+    node->in_flight.fetch_add(1, std::memory_order_relaxed);
 
     // recurse on the best child
-    bool has_swung = visit_best_line(node->best_child, game_history, metric_weights, obs);
+    bool has_swung = visit_best_line(next, cycle, ctx, game_history, metric_weights, obs);
 
-    // recurse on very-nearly-equal siblings
+    // take the children as they are now, since other threads may add to them
+    SearchNode * children_arr[MAX_LEGAL_MOVES];
+    ptr_vec<SearchNode *> children(children_arr, MAX_LEGAL_MOVES);
+    lock(node);
     bool uneven_visits = uneven_visit_distribution(node);
+    const SearchNode * best_child = node->best_child;
+    for (SearchNode * child : node->children) {
+        children.push(child);
+    }
+    unlock(node);
+
+    // recurse on very-nearly-equal siblings
     int extra_siblings_visited = 0;
-    for (int i = 0; i < node->children.size(); ++i) {
-        if (node->children[i] == node->best_child) { continue; }
+    for (int i = 0; i < children.size(); ++i) {
+        if (children[i] == best_child) { continue; }
         if (uneven_visits ||
-                millipawn_diff(node->best_child->score, node->children[i]->score) <= __engine_params::EVALS_EQUAL_THRESHOLD) {
-            has_swung = visit_best_line(node->children[i], game_history, metric_weights, obs) || has_swung;
+                millipawn_diff(best_child->score, children[i]->score) <= __engine_params::EVALS_EQUAL_THRESHOLD) {
+            has_swung = visit_best_line(children[i], cycle, ctx, game_history, metric_weights, obs) || has_swung;
             if (!uneven_visits &&
                     ++extra_siblings_visited == __engine_params::MAX_EXTRA_SIBLINGS) {
                 break;
@@ -362,11 +561,13 @@ bool visit_best_line(
     }
 
     // after the below recursion, visit the current node itself
-    visit_node(node, game_history, metric_weights, obs);
+    visit_node(node, ctx, game_history, metric_weights, obs);
+    node->in_flight.fetch_sub(1, std::memory_order_relaxed);
 
-    if (!has_swung && is_swing(prior, node->score)) {
+    // a search which has been stopped may have left the score half-updated, which is not a swing
+    if (!has_swung && !check_abort(ctx) && is_swing(prior, node->score)) {
         obs.register_event(node, SWING);
-        force_visit_best_line(node, game_history, metric_weights, obs);
+        force_visit_best_line(node, ctx, game_history, metric_weights, obs);
         obs.close_event(node, VISIT_LINE, nullptr, 1);
         return true;
     }
@@ -375,56 +576,232 @@ bool visit_best_line(
     return has_swung;
 }
 
+/**
+ * What the threads searching one tree share: the tree, the search's context and settings, the
+ * counts of the cycles they have started between them, and the root's best child as of the last
+ * cycle to end, with when it last changed (in ticks of the context's clock).
+ */
+struct SharedSearch {
+    SearchNode * root;
+    SearchContext & ctx;
+    const int cycles;
+    std::atomic<int> cycles_started;
+    std::atomic<unsigned> last_cycle;
+    const std::vector<Gamestate> * game_history;
+    const MetricWeights * metric_weights;
+    Observer & obs;
+    std::atomic<SearchNode *> best{nullptr};
+    std::atomic<SearchContext::Clock::rep> best_changed{0};
+};
+
+/**
+ * Notes the root's best child at the end of a cycle, and when it changes.
+ */
+void track_best_child(SharedSearch & search) {
+
+    lock(search.root);
+    SearchNode * best = search.root->best_trust_child;
+    unlock(search.root);
+
+    if (search.best.exchange(best, std::memory_order_relaxed) != best) {
+        search.best_changed.store(
+            SearchContext::Clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+    }
+}
+
+/**
+ * Whether the search has run out of time: it is past its soft deadline, and the root's best child has
+ * not changed recently enough to put the deadline back (see UNSTABLE_WINDOW), or it cannot be put back
+ * any further. The hard deadline is checked along with the aborts instead.
+ */
+bool out_of_time(SharedSearch & search) {
+
+    if (!search.ctx.past_soft_deadline()) { return false; }
+
+    const SearchContext::Clock::duration since_change =
+        SearchContext::Clock::now().time_since_epoch()
+            - SearchContext::Clock::duration(search.best_changed.load(std::memory_order_relaxed));
+    const double soft = search.ctx.soft_limit();
+    const bool unstable =
+        std::chrono::duration<double>(since_change).count() < soft * __engine_params::UNSTABLE_WINDOW;
+
+    return !(unstable && search.ctx.stretch_soft_deadline(soft * __engine_params::STRETCH_FACTOR));
+}
+
+/**
+ * Visits the best line from the root, cycle after cycle, until the given number of cycles have been
+ * started between all the threads searching the tree (or forever, if that is negative), until the
+ * search can exit, or until it is stopped. Running out of time stops the other threads too.
+ */
+void run_cycles(SharedSearch & search) {
+
+    while (!check_abort(search.ctx)
+            && (search.cycles < 0 || search.cycles_started.fetch_add(1) < search.cycles)) {
+
+        visit_best_line(search.root, ++search.last_cycle, search.ctx, search.game_history, search.metric_weights, search.obs);
+        search.ctx.register_cycle();
+        track_best_child(search);
+
+        if (search.root->terminal || soft_exit_criteria(search.root, search.ctx)) {
+            break;
+        }
+        if (out_of_time(search)) {
+            search.ctx.abort_analysis();
+            break;
+        }
+    }
+}
+
+struct SearchThreadArgs {
+    SharedSearch * search;
+    int index;
+};
+
+void * search_thread(void * args) {
+    SearchThreadArgs * thread_args = (SearchThreadArgs *) args;
+    set_search_thread_index(thread_args->index);
+    run_cycles(*thread_args->search);
+    return nullptr;
+}
+
+/**
+ * Searches the tree below the given root for the given number of cycles (or until stopped through the
+ * context, if that is negative), and returns the best line found. A stopped search returns the best
+ * line so far, and leaves the tree as it was, ready to be searched further.
+ * With more than one thread, the threads search the one tree at once and the calling thread waits for
+ * them, returning the best line once they have all stopped.
+ * The observer is then called from every thread, so should be the default one.
+ */
 std::vector<Move> greedy_search(
         SearchNode * root,
+        SearchContext & ctx,
         int cycles,
         const std::vector<Gamestate> * game_history,
         const MetricWeights * metric_weights,
-        Observer & obs) {
+        Observer & obs,
+        int threads) {
 
     if (root->score == zero()) {
         root->score = heur(*root->gs);
     }
-    if (root->cand_set->empty()) {
-        delete root->cand_set;
-        root->cand_set = cands(*root->gs, new CandSet);
+    // a root kept from an earlier search has already taken (and cleared) its candidates
+    if (root->visit_count == 0 && root->cand_set->empty()) {
+        cands(*root->gs, root->cand_set);
     }
 
-    int i = 0;
-
-    while (i++ < cycles || cycles < 0) {
-
-        visit_best_line(root, game_history, metric_weights, obs);
+    // a kept root was searched as a deeper node, so it may have children never visited, which a fresh
+    // root's first cycles would have: give each its first visit now
+    if (root->visit_count > 0) {
+        for (SearchNode * child : root->children) {
+            if (child->visit_count == 0) {
+                force_visit(child, ctx, game_history, metric_weights, obs);
+            }
+        }
+        update_score(root);
+    }
 
-        if (root->terminal || soft_exit_criteria(root)) {
-            break;
+    // carry on from the last cycle run on this tree, so that a node is never taken to be visited already
+    SharedSearch search{root, ctx, cycles, 0, root->visit_cycle, game_history, metric_weights, obs};
+    search.best = root->best_trust_child;
+
+    if (threads <= 1) {
+        run_cycles(search);
+    } else {
+        std::vector<pthread_t> t_ids(threads);
+        std::vector<SearchThreadArgs> args(threads);
+        for (int i = 0; i < threads; ++i) {
+            args[i] = SearchThreadArgs{&search, i};
+            pthread_create(&t_ids[i], nullptr, &search_thread, &args[i]);
+        }
+        for (int i = 0; i < threads; ++i) {
+            pthread_join(t_ids[i], nullptr);
         }
     }
 
     std::vector<SearchNode *> best_line = retrieve_trust_line(root);
 
     std::vector<Move> moves;
-    for (SearchNode * s : best_line) {
-        if (s != root) {
-            moves.push_back(s->move);
-        }
+    for (int i = 1; i < best_line.size(); ++i) {
+        moves.push_back(edge_move(best_line[i - 1], best_line[i]));
     }
 
     return moves;
 }
 
-Eval trust_score(SearchNode * node, bool is_white) {
+/**
+ * Keeps only a share of the root's candidates: the given share of every given number, taken in order
+ * through the critical, medial and final lists.
+ */
+void restrict_root_candidates(SearchNode * root, const int share, const int shares) {
 
-    if (is_mate(node->score)) {
-        return node->score;
+    int i = 0;
+    for (const CandList cand_list : {CRITICAL, MEDIAL, FINAL}) {
+        if (cand_list == CRITICAL) { root->cand_set->order_list(cand_list); }
+        std::pmr::vector<Move> & list = root->cand_set->get_list(cand_list);
+        int kept = 0;
+        for (int j = 0; j < list.size(); ++j) {
+            if (i++ % shares == share) {
+                list[kept++] = list[j];
+            }
+        }
+        list.resize(kept);
+    }
+}
+
+struct EnsembleThreadArgs {
+    SearchNode * root;
+    SearchContext * ctx;
+    int share;
+    int shares;
+    int cycles;
+    int threads;
+    const std::vector<Gamestate> * game_history;
+    const MetricWeights * metric_weights;
+};
+
+void * ensemble_thread(void * args) {
+
+    EnsembleThreadArgs * tree = (EnsembleThreadArgs *) args;
+
+    // as in greedy_search, a root kept or run before has already taken its candidates, and its share of them
+    if (tree->root->visit_count == 0 && tree->root->cand_set->empty()) {
+        cands(*tree->root->gs, tree->root->cand_set);
+        restrict_root_candidates(tree->root, tree->share, tree->shares);
     }
 
-    int penalty = 0;
-    if (node->visit_count <= 1) { penalty = 5000; }
-    else if (node->visit_count == 2) { penalty = 1500; }
-    else if (node->visit_count < 4) { penalty = 400; }
-    else if (node->visit_count < 8) { penalty = 100; }
+    greedy_search(
+        tree->root, *tree->ctx, tree->cycles, tree->game_history, tree->metric_weights, DEFAULT_OBSERVER, tree->threads);
+    return nullptr;
+}
+
+/**
+ * Searches several separate trees of the same position at once, each in its own thread(s) with its own
+ * context, and so its own transposition table and node limit. Each tree starts from its own share of the
+ * root's candidates, so that they search different moves until they reach the full legal list at the root
+ * (a tree left with no share at all takes every candidate instead, as greedy_search does for a root without
+ * any). The root moves of all the trees are then merged, without changing the trees (see merge_roots), and
+ * the move chosen from them is returned.
+ * The caller aborts the search by aborting every tree's context.
+ */
+Move ensemble_search(
+        const std::vector<SearchNode *> & roots,
+        const std::vector<SearchContext *> & contexts,
+        int cycles,
+        const std::vector<Gamestate> * game_history,
+        const MetricWeights * metric_weights,
+        int threads) {
+
+    const int n = roots.size();
+    std::vector<pthread_t> t_ids(n);
+    std::vector<EnsembleThreadArgs> args(n);
+    for (int i = 0; i < n; ++i) {
+        args[i] = EnsembleThreadArgs{roots[i], contexts[i], i, n, cycles, threads, game_history, metric_weights};
+        pthread_create(&t_ids[i], nullptr, &ensemble_thread, &args[i]);
+    }
+    for (int i = 0; i < n; ++i) {
+        pthread_join(t_ids[i], nullptr);
+    }
 
-    if (is_white) { return node->score - penalty; }
-    else { return node->score + penalty; }
+    // nothing here checks for an abort, so the trees are merged even if the search was stopped
+    return best_merged_move(merge_roots(roots), roots[0]->gs->board.get_white());
 }
@@ -1,10 +1,14 @@
 #include "game.h"
 #include "search.h"
 #include "search_tools.h"
+#include "transpositions.h"
 #include "../game/gamestate.hpp"
 
 #include <vector>
 using std::vector;
+#include <algorithm>
+#include <climits>
+#include <unordered_map>
 #include <iostream>
 using std::cout;
 #include <fstream>
@@ -15,15 +19,34 @@ using std::ostream;
 Observer DEFAULT_OBSERVER;
 
 /**
- * Recursively counts the number of nodes in the subtree rooted at the given node.
+ * The move from the given node to the given child. This is the child's own move unless the child
+ * was created under another parent and reached from this one by transposition, in which case it
+ * is the move recorded with the link from this one.
+ */
+Move edge_move(const SearchNode * node, const SearchNode * child) {
+
+    if (child->parent == node) { return child->move; }
+
+    for (const ParentLink * link = child->other_parents; link; link = link->next) {
+        if (link->parent == node) { return link->move; }
+    }
+    return MOVE_SENTINEL;
+}
+
+/**
+ * Recursively counts the number of nodes in the subtree rooted at the given node. A node shared
+ * by transposition is counted once, under the parent it was created under.
  */
 int subtree_size(SearchNode * node) {
 
-    if (node == nullptr) { return 0; }
+    // lazy nodes are only edges, until the search builds them
+    if (node == nullptr || node->is_lazy()) { return 0; }
 
     int size = 1;
     for (SearchNode * i : node->children) {
-        size += subtree_size(i);
+        if (i->parent == node) {
+            size += subtree_size(i);
+        }
     }
     return size;
 }
@@ -60,7 +83,7 @@ void print_line(std::vector<SearchNode *> & line) {
 
     cout << "[" << etos(line[0]->score) << "] ";
     for (int i = 1; i < line.size(); ++i) {
-        cout << mtos(line[i-1]->gs->board, line[i]->move) << " ";
+        cout << mtos(line[i-1]->gs->board, edge_move(line[i-1], line[i])) << " ";
     }
     cout << "\n";
 }
@@ -85,6 +108,11 @@ void write_to_file(SearchNode *node, ostream & output) {
 
     output << "######################\n";
 
+    if (node->is_lazy()) {
+        output << "SearchNode at " << node << " (lazy, estimated " << etos(node->score) << ")\n";
+        return;
+    }
+
     // SearchNode title line
     output << "SearchNode at " << node
            << " (created by " << mtos(node->gs->board, node->move) << ")\n";
@@ -105,9 +133,16 @@ void write_to_file(SearchNode *node, ostream & output) {
         output << node->children.size() << " children\n";
 
         // list of children and names
+        std::vector<Move> child_moves;
+        std::vector<std::string> child_sans;
+        for (const SearchNode * child : node->children) {
+            child_moves.push_back(edge_move(node, child));
+        }
+        mtos(node->gs->board, child_moves, child_sans);
+
         for (int i = 0; i < node->children.size(); ++i) {
             output << "Child " << i << ": " << node->children[i]
-                   << " (" << mtos(node->gs->board, node->children[i]->move)
+                   << " (" << child_sans[i]
                    << ") (" << etos(node->children[i]->score)
                    << ") (" << etos(trust_score(node->children[i], node->gs->board.get_white()))
                    << ") (" << subtree_depth(node->children[i]) << ")\n";
@@ -130,13 +165,13 @@ void write_to_file(SearchNode *node, ostream & output) {
 
     output << "Best line from here: (" << etos(node->score) << ")";
     for (int i = 1; i < best_line.size(); ++i) {
-        output << " " << mtos(best_line[i-1]->gs->board, best_line[i]->move);
+        output << " " << mtos(best_line[i-1]->gs->board, edge_move(best_line[i-1], best_line[i]));
     }
     output << "\n";
 
     output << "Trust line from here: (" << etos(trust_line[trust_line.size() - 1]->score) << ")";
     for (int i = 1; i < trust_line.size(); ++i) {
-        output << " " << mtos(trust_line[i-1]->gs->board, trust_line[i]->move);
+        output << " " << mtos(trust_line[i-1]->gs->board, edge_move(trust_line[i-1], trust_line[i]));
     }
 
     output << "\n";
@@ -147,12 +182,15 @@ void write_to_file(SearchNode *node, ostream & output) {
 
 /**
  * Writes the given node to the file. Then, calls this function recursively on each
- * child of the node. A pre-order traversal is used.
+ * child of the node. A pre-order traversal is used, and a node shared by transposition
+ * is written once, under the parent it was created under.
  */
 void write_to_file_recursively(SearchNode *node, ostream & output) {
     write_to_file(node, output);
     for (SearchNode * i : node->children) {
-        write_to_file_recursively(i, output);
+        if (i->parent == node) {
+            write_to_file_recursively(i, output);
+        }
     }
 }
 
@@ -171,61 +209,334 @@ void record_tree_in_file(const std::string & filename, SearchNode * root) {
 }
 
 /**
- * Allocates a new gamestate according to the previous state and the move given. The new
- * gamestate will represent the position after the given move has been played.
+ * Creates a child of the given node for each of the moves, representing the position after that
+ * move, and appends them to its children. The new nodes are allocated as one contiguous block
+ * ahead of their gamestates and candidates, so that scanning them walks memory in order. Memory
+ * comes from the same resource as the parent's list of children: within an engine, that is the
+ * search's arena, which is the only way the nodes are freed.
+ * If lazy is set, the children are left without gamestates or candidates, scored only by
+ * static_estimate, and are not counted as nodes until they are materialised.
+ * Returns the first of the new children.
+ */
+SearchNode * new_children(SearchNode * node, const ptr_vec<Move> & moves, const bool lazy, SearchContext & ctx) {
+
+    std::pmr::memory_resource * mem = node->children.get_allocator().resource();
+    std::pmr::polymorphic_allocator<> alloc(mem);
+
+    SearchNode * block = alloc.allocate_object<SearchNode>(moves.size());
+    node->children.reserve(node->children.size() + moves.size());
+
+    for (int i = 0; i < moves.size(); ++i) {
+        if (lazy) {
+            alloc.construct(block + i, nullptr, nullptr, static_estimate(node->gs->board, moves[i]), mem);
+            block[i].move = moves[i];
+        } else {
+            ctx.register_new_node();
+            alloc.construct(block + i, alloc.new_object<Gamestate>(*node->gs, moves[i]), alloc.new_object<CandSet>(mem), moves[i], mem);
+        }
+        block[i].parent = node;
+        node->children.push_back(block + i);
+    }
+    return block;
+}
+
+/**
+ * Adds an existing node, reached by transposition with the given move, to the children of the given
+ * node, which becomes one of its other parents.
+ */
+void link_child(SearchNode * node, SearchNode * child, const Move move) {
+
+    std::pmr::polymorphic_allocator<> alloc(node->children.get_allocator().resource());
+    child->other_parents = alloc.new_object<ParentLink>(ParentLink{node, move, child->other_parents});
+    node->children.push_back(child);
+}
+
+/**
+ * Builds the gamestate and (empty) candidate set of a lazy node from its parent, in the same
+ * memory as its siblings. Its score is left as the estimate: it is up to the caller to generate
+ * candidates and evaluate it.
  */
-SearchNode *new_node(const SearchNode * node, Move m) {
-    register_new_node();
-    SearchNode * new_node = new SearchNode(new Gamestate(*node->gs, m), new CandSet, m);
-    new_node->parent = node;
-    return new_node;
+void materialise(SearchNode * node, SearchContext & ctx) {
+
+    ctx.register_new_node();
+    std::pmr::memory_resource * mem = node->children.get_allocator().resource();
+    std::pmr::polymorphic_allocator<> alloc(mem);
+
+    node->gs = alloc.new_object<Gamestate>(*node->parent->gs, node->move);
+    node->cand_set = alloc.new_object<CandSet>(mem);
+    node->board_hash = node->gs->board.get_key();
 }
 
 /**
  * Checks the children of the node and sets the score and best_child pointers
  * accordingly.
  */
-void update_score(SearchNode * node) {
+void rescore(SearchNode * node) {
 
-    check_abort();
     if (node->children.empty()) { return; }
 
-    // find the best score among children
-    node->score = node->children[0]->score;
-    node->best_child = node->children[0];
-
-    for (int i = 1; i < node->children.size(); ++i) {
-        Eval score = node->children[i]->score;
-        if (node->gs->board.get_white() && score > node->score) {
-            node->score = score;
-            node->best_child = node->children[i];
-        } else if (!node->gs->board.get_white() && score < node->score) {
-            node->score = score;
-            node->best_child = node->children[i];
+    // the scan reads only the children's hot fields, and keeps the running bests in locals
+    const bool white = node->gs->board.get_white();
+    SearchNode * const * children = node->children.data();
+    const int n = node->children.size();
+
+    // find the best score and the most trusted score among children
+    Eval best_score = children[0]->score;
+    SearchNode * best_child = children[0];
+    Eval best_trust_score = trust_score(children[0], white);
+    SearchNode * best_trust_child = children[0];
+
+    for (int i = 1; i < n; ++i) {
+        const Eval score = children[i]->score;
+        if (white ? score > best_score : score < best_score) {
+            best_score = score;
+            best_child = children[i];
+        }
+        const Eval trust = trust_score(children[i], white);
+        if (white ? trust > best_trust_score : trust < best_trust_score) {
+            best_trust_score = trust;
+            best_trust_child = children[i];
         }
     }
 
     // if the score is mate, then we need to make it mate in one more move
-    if (is_mate(node->score)) {
-        if (white_is_mated(node->score) && !node->gs->board.get_white()) {
-            node->score = mate_in_one_more(node->score);
-        } else if (black_is_mated(node->score) && node->gs->board.get_white()) {
-            node->score = mate_in_one_more(node->score);
+    if (is_mate(best_score)) {
+        if (white_is_mated(best_score) && !white) {
+            best_score = mate_in_one_more(best_score);
+        } else if (black_is_mated(best_score) && white) {
+            best_score = mate_in_one_more(best_score);
+        }
+    }
+
+    node->score = best_score;
+    node->best_child = best_child;
+    node->best_trust_child = best_trust_child;
+}
+
+void rescore_parents(SearchNode *);
+
+/**
+ * Rescores one parent of a node whose score has changed, and its own parents in turn if that changes
+ * its score. A parent whose lock is held is skipped: if this thread holds it, deepen will rescore it
+ * on the way back up, and if another thread does, it is rescored when it is next visited.
+ */
+void rescore_parent(SearchNode * parent) {
+
+    if (!try_lock(parent)) { return; }
+    const Eval before = parent->score;
+    rescore(parent);
+    const bool changed = parent->score != before;
+    unlock(parent);
+
+    if (changed) { rescore_parents(parent); }
+}
+
+/**
+ * Rescores every parent of a node whose score has changed, and so on upwards for as long as the
+ * scores keep changing.
+ */
+void rescore_parents(SearchNode * node) {
+
+    if (node->parent) {
+        rescore_parent(node->parent);
+    }
+    for (ParentLink * link = node->other_parents; link; link = link->next) {
+        rescore_parent(link->parent);
+    }
+}
+
+/**
+ * Rescores the node from its children (see rescore). The search rescores the nodes on the line it
+ * is visiting as it returns up that line, but a node shared by transposition has parents off the
+ * line too, so if its score changes then those are rescored straight away.
+ * The caller should hold the node's lock if other threads are searching the tree.
+ */
+void update_score(SearchNode * node) {
+
+    const Eval before = node->score;
+    rescore(node);
+    if (node->other_parents && node->score != before) {
+        rescore_parents(node);
+    }
+}
+
+/**
+ * Merges the root children of several searches of the same position into one summary of the root
+ * moves, so that the best move can be chosen from them all. A move searched in more than one tree has
+ * the visits of all of them, and the score from whichever visited it most. The trees are only read:
+ * each stays as it was, ready to be searched again on its own.
+ */
+std::vector<MergedRootMove> merge_roots(const std::vector<SearchNode *> & roots) {
+
+    std::vector<MergedRootMove> merged;
+    std::vector<int> most_visits;
+
+    for (const SearchNode * root : roots) {
+        for (const SearchNode * child : root->children) {
+
+            const Move m = edge_move(root, child);
+            int i = 0;
+            while (i < merged.size() && !equal_exactly(merged[i].move, m)) { ++i; }
+
+            if (i == merged.size()) {
+                merged.push_back(MergedRootMove{m, child->score, child->visit_count});
+                most_visits.push_back(child->visit_count);
+                continue;
+            }
+            if (child->visit_count > most_visits[i]) {
+                merged[i].score = child->score;
+                most_visits[i] = child->visit_count;
+            }
+            merged[i].visit_count += child->visit_count;
         }
     }
+    return merged;
+}
+
+/**
+ * The most trusted of the merged root moves, as rescore would choose among a root's children (see
+ * trust_score), or the sentinel if there are none.
+ */
+Move best_merged_move(const std::vector<MergedRootMove> & merged, const bool white) {
+
+    Move best = MOVE_SENTINEL;
+    Eval best_trust = 0;
+    for (const MergedRootMove & root_move : merged) {
+        const Eval trust = trust_score(root_move.score, root_move.visit_count, white);
+        if (is_sentinel(best) || (white ? trust > best_trust : trust < best_trust)) {
+            best = root_move.move;
+            best_trust = trust;
+        }
+    }
+    return best;
+}
+
+using NodeCopies = std::unordered_map<const SearchNode *, SearchNode *>;
+
+/**
+ * Constructs a copy of the given node, without its children, in the given place and memory, as a
+ * child of the given parent (which may be null) reached by the given move. The game has moved on since
+ * the node was built, so its position may now be drawn by repetition: then it is scored as a draw like
+ * a new node would be, and is left out of the new table.
+ * Returns true if the node's children should be copied too, or false if it is now drawn.
+ */
+bool copy_node(
+        const SearchNode * node,
+        SearchNode * copy,
+        SearchNode * parent,
+        const Move move,
+        std::pmr::memory_resource * mem,
+        const TranspositionTable * from,
+        TranspositionTable * to,
+        const std::vector<Gamestate> * game_history) {
+
+    std::pmr::polymorphic_allocator<> alloc(mem);
+
+    if (node->is_lazy()) {
+        alloc.construct(copy, nullptr, nullptr, node->score, mem);
+        copy->move = move;
+        copy->parent = parent;
+        return false;
+    }
 
-    // now find the most trusted score among children
-    Eval best_trust_score = trust_score(node->children[0], node->gs->board.get_white());
-    node->best_trust_child = node->children[0];
+    CandSet * cand_set = alloc.new_object<CandSet>(mem);
+    for (const CandList cand_list : {CRITICAL, MEDIAL, FINAL, LEGAL}) {
+        const std::pmr::vector<Move> & list = node->cand_set->get_list(cand_list);
+        cand_set->get_list(cand_list).assign(list.begin(), list.end());
+    }
+    alloc.construct(copy, alloc.new_object<Gamestate>(*node->gs), cand_set, move, mem);
+    copy->parent = parent;
+    copy->score = node->score;
+    copy->visit_count = node->visit_count;
+    copy->terminal = node->terminal;
+
+    const int earlier = earlier_occurrences(node->gs->board, parent, game_history, 3);
+    if (earlier == 3 && !node->gs->game_over) {
+        copy->score = zero();
+        copy->gs->game_over = true;
+        copy->terminal = true;
+        return false;
+    }
+    if (from && to && earlier == 0 && from->find(node->gs->board) == node) {
+        to->insert(copy);
+    }
+    return true;
+}
+
+/**
+ * Copies the children of the given node to its copy, and their subtrees in turn, then rescores the
+ * copy from them. A child which has been copied already, as the child of another node, is linked as a
+ * transposition; the rest become the copy's own, and are allocated together as new_children would.
+ */
+void copy_children(
+        const SearchNode * node,
+        SearchNode * copy,
+        std::pmr::memory_resource * mem,
+        NodeCopies & copies,
+        const TranspositionTable * from,
+        TranspositionTable * to,
+        const std::vector<Gamestate> * game_history) {
+
+    int fresh = 0;
+    for (const SearchNode * child : node->children) {
+        if (!copies.count(child)) { ++fresh; }
+    }
 
-    for (int i = 1; i < node->children.size(); ++i) {
-        Eval score = trust_score(node->children[i], node->gs->board.get_white());
-        if ((node->gs->board.get_white() && score > best_trust_score)
-            || (!node->gs->board.get_white() && score < best_trust_score)) {
-            best_trust_score = score;
-            node->best_trust_child = node->children[i];
+    std::pmr::polymorphic_allocator<> alloc(mem);
+    SearchNode * block = alloc.allocate_object<SearchNode>(fresh);
+    copy->children.reserve(node->children.size());
+
+    // the children whose own children are to be copied, with their copies
+    const SearchNode * originals_arr[MAX_LEGAL_MOVES];
+    ptr_vec<const SearchNode *> originals(originals_arr, MAX_LEGAL_MOVES);
+    SearchNode * child_copies_arr[MAX_LEGAL_MOVES];
+    ptr_vec<SearchNode *> child_copies(child_copies_arr, MAX_LEGAL_MOVES);
+
+    int made = 0;
+    for (const SearchNode * child : node->children) {
+        auto found = copies.find(child);
+        if (found != copies.end()) {
+            link_child(copy, found->second, edge_move(node, child));
+            continue;
+        }
+        SearchNode * child_copy = block + made++;
+        if (copy_node(child, child_copy, copy, edge_move(node, child), mem, from, to, game_history)) {
+            originals.push(child);
+            child_copies.push(child_copy);
         }
+        copies[child] = child_copy;
+        copy->children.push_back(child_copy);
+    }
+
+    for (int i = 0; i < originals.size(); ++i) {
+        copy_children(originals[i], child_copies[i], mem, copies, from, to, game_history);
+    }
+    rescore(copy);
+}
+
+/**
+ * Copies the subtree below the given (built) node into the given memory, as a new tree whose root is
+ * the copy of the node, so that a search of its position can carry on from it. Scores, visit counts
+ * and candidates are kept, and nodes shared by transposition stay shared, except that positions now
+ * drawn by repetition in the given game are cut off as draws. Nodes of the subtree which were in the
+ * old table are put in the new one (either table may be null). The copy is ready to be searched from
+ * afresh: no node is locked, or counts as visited in any cycle.
+ * Must not be called while the subtree is being searched.
+ */
+SearchNode * copy_subtree(
+        const SearchNode * node,
+        std::pmr::memory_resource * mem,
+        const TranspositionTable * from,
+        TranspositionTable * to,
+        const std::vector<Gamestate> * game_history) {
+
+    std::pmr::polymorphic_allocator<> alloc(mem);
+    SearchNode * root = alloc.allocate_object<SearchNode>(1);
+    NodeCopies copies{{node, root}};
+    if (copy_node(node, root, nullptr, MOVE_SENTINEL, mem, from, to, game_history)) {
+        copy_children(node, root, mem, copies, from, to, game_history);
     }
+    return root;
 }
 
 /**
@@ -261,18 +572,3 @@ std::vector<SearchNode *> retrieve_trust_line(SearchNode * root) {
 
     return line;
 }
-
-/**
- * Deletes completely the tree or subtree of which the given node is the root.
- */
-void delete_tree(SearchNode * node) {
-
-    if (!node) { return; }
-
-    for (SearchNode * i : node->children) {
-        delete_tree(i);
-    }
-    delete node->gs;
-    delete node->cand_set;
-    delete node;
-}
@@ -0,0 +1,134 @@
+#ifndef STASE_SEARCH_CONTEXT_H
+#define STASE_SEARCH_CONTEXT_H
+
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+
+class TranspositionTable;
+
+/**
+ * The state of one search: its node count and limit, its abort flag and deadlines, the transposition
+ * table and settings it searches with, when it started, and how many cycles it has run. Each Engine owns its
+ * own (one per tree of a root-parallel search), so that engines in one process never share limits
+ * or aborts. It is passed down through the search to every point which counts nodes or checks for
+ * an abort.
+ *
+ * The counts, the abort flag and the deadlines are written by some threads and read by others (the
+ * searching threads, or the engine's caller), so they are atomic. They order nothing else, so relaxed
+ * loads and stores are enough. The rest is set before the search starts and is only read during it.
+ * The counts are bumped by every searching thread, so they have a cache line of their own, apart from
+ * the fields which every thread reads whenever it checks whether to stop.
+ *
+ * The search must stop at the hard deadline, which it checks wherever it checks for an abort, and so
+ * stops within moments of it. It should stop at the soft deadline unless its best move is still
+ * changing, which is checked between cycles (see run_cycles). The deadlines are kept as ticks of the
+ * steady clock, or NO_DEADLINE.
+ */
+struct SearchContext {
+
+    using Clock = std::chrono::steady_clock;
+    static constexpr Clock::rep NO_DEADLINE = -1;
+
+    alignas(64) std::atomic<int> nodes;
+    std::atomic<int> cycles;
+    alignas(64) std::atomic<bool> abort;
+    std::atomic<Clock::rep> soft_deadline;
+    std::atomic<Clock::rep> hard_deadline;
+    std::atomic<double> soft_seconds;
+
+    int node_limit;
+    bool lazy_children;
+    TranspositionTable * table;
+
+    std::chrono::steady_clock::time_point started;
+
+    explicit SearchContext(const int node_limit = -1, const bool lazy_children = false, TranspositionTable * table = nullptr) :
+        nodes(0),
+        cycles(0),
+        abort(false),
+        soft_deadline(NO_DEADLINE),
+        hard_deadline(NO_DEADLINE),
+        soft_seconds(-1),
+        node_limit(node_limit),
+        lazy_children(lazy_children),
+        table(table),
+        started(std::chrono::steady_clock::now())
+    {}
+
+    /**
+     * Clears the counts, the abort flag and the deadlines, and restarts the timer, ready for a new search.
+     */
+    void reset() {
+        nodes.store(0, std::memory_order_relaxed);
+        cycles.store(0, std::memory_order_relaxed);
+        abort.store(false, std::memory_order_relaxed);
+        set_deadlines(-1, -1);
+        started = Clock::now();
+    }
+
+    /**
+     * Sets the deadlines to the given numbers of seconds from now (or none, for a negative number).
+     * This may be done while the search is running.
+     */
+    void set_deadlines(const double soft, const double hard) {
+        const Clock::time_point now = Clock::now();
+        soft_seconds.store(soft, std::memory_order_relaxed);
+        soft_deadline.store(soft < 0 ? NO_DEADLINE : ticks_after(now, soft), std::memory_order_relaxed);
+        hard_deadline.store(hard < 0 ? NO_DEADLINE : ticks_after(now, hard), std::memory_order_relaxed);
+    }
+
+    /**
+     * Moves the soft deadline on by the given number of seconds, but not past the hard deadline.
+     * Returns false if it was at the hard deadline already, so could not be moved.
+     */
+    bool stretch_soft_deadline(const double seconds) {
+        const Clock::rep soft = soft_deadline.load(std::memory_order_relaxed);
+        const Clock::rep hard = hard_deadline.load(std::memory_order_relaxed);
+        if (soft == NO_DEADLINE || (hard != NO_DEADLINE && soft >= hard)) { return false; }
+        const Clock::rep stretched = ticks_after(Clock::time_point(Clock::duration(soft)), seconds);
+        soft_deadline.store(hard == NO_DEADLINE ? stretched : std::min(stretched, hard), std::memory_order_relaxed);
+        return true;
+    }
+
+    bool past_soft_deadline() const { return past(soft_deadline.load(std::memory_order_relaxed)); }
+
+    /**
+     * The soft time limit the deadlines were last set with, in seconds (negative for none).
+     */
+    double soft_limit() const { return soft_seconds.load(std::memory_order_relaxed); }
+
+    void register_new_node() { nodes.fetch_add(1, std::memory_order_relaxed); }
+    int node_count() const { return nodes.load(std::memory_order_relaxed); }
+
+    void register_cycle() { cycles.fetch_add(1, std::memory_order_relaxed); }
+    int cycle_count() const { return cycles.load(std::memory_order_relaxed); }
+
+    void abort_analysis() { abort.store(true, std::memory_order_relaxed); }
+
+    /**
+     * Whether the search should stop: it has been aborted, or has reached its node limit or its hard deadline.
+     */
+    bool should_stop() const {
+        return abort.load(std::memory_order_relaxed)
+            || (node_limit != -1 && node_count() >= node_limit)
+            || past(hard_deadline.load(std::memory_order_relaxed));
+    }
+
+    double elapsed_seconds() const {
+        auto elapsed = Clock::now() - started;
+        return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() / 1000000.0;
+    }
+
+private:
+    static Clock::rep ticks_after(const Clock::time_point from, const double seconds) {
+        return (from + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds)))
+            .time_since_epoch().count();
+    }
+
+    static bool past(const Clock::rep deadline) {
+        return deadline != NO_DEADLINE && Clock::now().time_since_epoch().count() >= deadline;
+    }
+};
+
+#endif //STASE_SEARCH_CONTEXT_H
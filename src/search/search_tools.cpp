@@ -1,14 +1,14 @@
 #include "search_tools.h"
-#include <pthread.h>
+#include "../utils/ptr_vec.h"
 #include "../game/gamestate.hpp"
 
 /**
- * Checks whether the engine abort flag has been set and gracefully exits if so.
+ * Checks whether the search has been aborted or has reached its node limit. If so, the caller should
+ * return straight away, unwinding the search through the nodes it has visited: each of those is left
+ * consistent, with its lock released, so the tree can be searched again later.
  */
-void check_abort() {
-    if (get_abort_flag() || (get_node_limit() != -1 && node_count() >= get_node_limit())) {
-        interrupt_execution(0);
-    }
+bool check_abort(const SearchContext & ctx) {
+    return ctx.should_stop();
 }
 
 /**
@@ -80,16 +80,31 @@ void update_terminal(SearchNode * node, Observer & obs) {
 /**
  * Checks that a subtree of the given depth rooted at the given root has visit counts
  * of at least the given threshold, ignoring terminal nodes and nodes with no candidates.
+ * Each node is locked while it is read, since other threads may be searching the tree.
  */
 bool check_vc_subtree(SearchNode * root, int threshold, int depth) {
-    if (depth == 0 || root->terminal || root->cand_set->empty()) {
+
+    SearchNode * children_arr[MAX_LEGAL_MOVES];
+    ptr_vec<SearchNode *> children(children_arr, MAX_LEGAL_MOVES);
+
+    lock(root);
+    // lazy nodes have not been visited, so fall through to fail the visit count check
+    const bool explored =
+        depth == 0 || root->terminal || (!root->is_lazy() && root->cand_set->empty());
+    const bool visited = root->visit_count >= threshold;
+    for (SearchNode * child : root->children) {
+        children.push(child);
+    }
+    unlock(root);
+
+    if (explored) {
         return true;
     }
-    if (root->visit_count < threshold) {
+    if (!visited) {
         return false;
     }
-    for (int i = 0; i < root->children.size(); ++i) {
-        if (!check_vc_subtree(root->children[i], threshold, depth - 1)) {
+    for (int i = 0; i < children.size(); ++i) {
+        if (!check_vc_subtree(children[i], threshold, depth - 1)) {
             return false;
         }
     }
@@ -97,15 +112,9 @@ bool check_vc_subtree(SearchNode * root, int threshold, int depth) {
 }
 
 /**
- * Determines whether or not a soft exit is warranted. This takes into account the number of nodes searched,
- * the number of children the root has, and the gap between the best and second best option. See __engine_params
- * in search_tools.h for specifics.
+ * The gap between the best child of the given node and the next best. The caller holds the node's lock.
  */
-bool soft_exit_criteria(SearchNode * root) {
-
-    if (node_count() < __engine_params::SOFT_EXIT_NODE_COUNT) { return false; }
-    if (!root->best_child) { return false; }
-    if (root->children.size() <= 1) { return true; }
+unsigned best_move_margin(const SearchNode * root) {
 
     Eval second_best;
     if (root->best_child == root->children[0]) {
@@ -125,26 +134,31 @@ bool soft_exit_criteria(SearchNode * root) {
         }
     }
 
-    if (millipawn_diff(root->best_child->score, second_best) < __engine_params::SOFT_EXIT_EVAL_MARGIN) {
-        return false;
-    }
-
-    return check_vc_subtree(root, __engine_params::SOFT_EXIT_EXPLORED_VC, __engine_params::SOFT_EXIT_EXPLORED_DEPTH);
+    return millipawn_diff(root->best_child->score, second_best);
 }
 
 /**
- * Interrupts the calling thread. Immediately exits with no cleanup.
+ * Determines whether or not a soft exit is warranted. This takes into account the number of nodes searched,
+ * the number of children the root has, and the gap between the best and second best option. See __engine_params
+ * in search_tools.h for specifics.
  */
-void interrupt_execution(int) {
-    pthread_exit(nullptr);
-}
+bool soft_exit_criteria(SearchNode * root, const SearchContext & ctx) {
 
-bool engine_abort = false;
-bool get_abort_flag() { return engine_abort; }
-void abort_analysis() { engine_abort = true; }
-void reset_abort_flag() { engine_abort = false; }
+    if (ctx.node_count() < __engine_params::SOFT_EXIT_NODE_COUNT) { return false; }
+
+    lock(root);
+    const bool no_best = !root->best_child;
+    const bool only_move = !no_best && root->children.size() <= 1;
+    const bool close = !no_best && !only_move && best_move_margin(root) < __engine_params::SOFT_EXIT_EVAL_MARGIN;
+    unlock(root);
+
+    if (no_best) { return false; }
+    if (only_move) { return true; }
+    if (close) { return false; }
+
+    return check_vc_subtree(root, __engine_params::SOFT_EXIT_EXPLORED_VC, __engine_params::SOFT_EXIT_EXPLORED_DEPTH);
+}
 
-int max_nodes = -1;
-int get_node_limit() { return max_nodes; }
-void set_node_limit(int limit) { max_nodes = limit; }
-void clear_node_limit() { max_nodes = -1; }
+thread_local int search_thread = 0;
+void set_search_thread_index(int i) { search_thread = i; }
+int search_thread_index() { return search_thread; }
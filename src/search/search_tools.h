@@ -2,6 +2,9 @@
 #define STASE_SEARCH_TOOLS_H
 
 #include "../../include/stase/search.h"
+#include "search_context.h"
+
+#include <thread>
 
 namespace __engine_params {
 
@@ -57,43 +60,122 @@ namespace __engine_params {
     const int SOFT_EXIT_EVAL_MARGIN = 2000;  // (millipawns)
     const int SOFT_EXIT_EXPLORED_DEPTH = 4;
     const int SOFT_EXIT_EXPLORED_VC = MEDIAL_THRESHOLD;
+
+    /**
+     * When several threads search one tree, each thread already on a line through a child counts against
+     * that child as a loss of VIRTUAL_LOSS, so that the others spread out over the nearly-best lines.
+     */
+    const int VIRTUAL_LOSS = 500;  // (millipawns)
+
+    /**
+     * A search on the opponent's time has no deadline, so it stops once it has added PONDER_NODE_LIMIT nodes
+     * (each of which holds a whole Gamestate), and waits there for the opponent's move.
+     */
+    const int PONDER_NODE_LIMIT = 100000;
 }
 
-SearchNode *new_node(const SearchNode *, Move);
-long board_hash(const Board &);
+SearchNode * new_children(SearchNode *, const ptr_vec<Move> &, bool lazy, SearchContext &);
+void link_child(SearchNode *, SearchNode *, Move);
+void materialise(SearchNode *, SearchContext &);
 bool uneven_visit_distribution(const SearchNode *);
 
 void update_score(SearchNode *);
-Eval trust_score(SearchNode *, bool is_white);
+
+/**
+ * A move from the root of a root-parallel search, with its score and visits merged across the trees
+ * which searched it (see merge_roots).
+ */
+struct MergedRootMove {
+    Move move;
+    Eval score;
+    int visit_count;
+};
+
+std::vector<MergedRootMove> merge_roots(const std::vector<SearchNode *> &);
+Move best_merged_move(const std::vector<MergedRootMove> &, bool white);
+SearchNode * copy_subtree(
+        const SearchNode *,
+        std::pmr::memory_resource *,
+        const TranspositionTable * from,
+        TranspositionTable * to,
+        const std::vector<Gamestate> * game_history);
+int earlier_occurrences(const Board &, const SearchNode * parent, const std::vector<Gamestate> * game_history, int max);
 std::vector<SearchNode *> retrieve_best_line(SearchNode *);
 std::vector<SearchNode *> retrieve_trust_line(SearchNode *);
 
+/**
+ * The node's score, penalised towards the other side if it has not been visited enough to be
+ * trusted. Inline, since it is worked out for every child each time a node is rescored.
+ */
+inline Eval trust_score(const Eval score, const int visit_count, bool is_white) {
+
+    if (is_mate(score)) {
+        return score;
+    }
+
+    int penalty = 0;
+    if (visit_count <= 1) { penalty = 5000; }
+    else if (visit_count == 2) { penalty = 1500; }
+    else if (visit_count < 4) { penalty = 400; }
+    else if (visit_count < 8) { penalty = 100; }
+
+    if (is_white) { return score - penalty; }
+    else { return score + penalty; }
+}
+
+inline Eval trust_score(const SearchNode * node, bool is_white) {
+    return trust_score(node->score, node->visit_count, is_white);
+}
+
 inline bool is_swing(const Eval a, const Eval b) {
     return millipawn_diff(a, b) > __engine_params::SWING_THRESHOLD;
 }
 
 void update_terminal(SearchNode *, Observer &);
-bool soft_exit_criteria(SearchNode * root);
-
-void check_abort();
+bool soft_exit_criteria(SearchNode * root, const SearchContext &);
+
+bool check_abort(const SearchContext &);
+
+/**
+ * Takes the node's lock. A search which is stopped still returns through every node it has locked,
+ * releasing each, so this need not check for an abort while it waits. While the lock is held, waiters
+ * only read it, so that they do not keep taking its cache line from each other (the root's is taken
+ * by every thread on every cycle).
+ */
+inline void lock(SearchNode * node) {
+    while (node->busy.test_and_set(std::memory_order_acquire)) {
+        while (node->busy.test(std::memory_order_relaxed)) {
+            std::this_thread::yield();
+        }
+    }
+}
 
-void abort_analysis();
-bool get_abort_flag();
-void reset_abort_flag();
+inline bool try_lock(SearchNode * node) {
+    return !node->busy.test_and_set(std::memory_order_acquire);
+}
 
-void set_node_limit(int nodes);
-int get_node_limit();
-void clear_node_limit();
+inline void unlock(SearchNode * node) {
+    node->busy.clear(std::memory_order_release);
+}
 
-void interrupt_execution(int);
+Move ensemble_search(
+        const std::vector<SearchNode *> & roots,
+        const std::vector<SearchContext *> & contexts,
+        int cycles,
+        const std::vector<Gamestate> * game_history,
+        const MetricWeights * metric_weights,
+        int threads);
+
+/**
+ * Which of the threads searching a tree the calling thread is, from 0. It picks out the thread's
+ * own blocks in the search arena.
+ */
+void set_search_thread_index(int);
+int search_thread_index();
 
 void print_line(std::vector<SearchNode *> & line);
 void record_tree_in_file(const std::string & filename, SearchNode * root);
 
-int node_count();
-void register_new_node();
-void reset_node_count();
-
 inline Move current_best_move(SearchNode * root) {
 
     if (!root) { return MOVE_SENTINEL; }
@@ -101,7 +183,7 @@ inline Move current_best_move(SearchNode * root) {
 
     update_score(root);
 
-    return root->best_trust_child->move;
+    return edge_move(root, root->best_trust_child);
 }
 
 
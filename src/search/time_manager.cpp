@@ -0,0 +1,36 @@
+#include "time_manager.h"
+
+#include <algorithm>
+
+/**
+ * A budget for a fixed time per move (or none, for a negative time), which is used in full.
+ */
+TimeBudget budget_for_move_time(const double seconds) {
+    return TimeBudget{seconds, seconds};
+}
+
+/**
+ * A budget for the next move on a clock with the given time remaining, increment per move, and number
+ * of moves to play before the next time control (or 0 if there is none). Both limits stay within the
+ * time remaining, less the overhead held back, unless that is less than MIN_MOVE_TIME.
+ */
+TimeBudget budget_for_clock(const double remaining_seconds, const double increment_seconds, const int moves_to_go) {
+
+    const double usable = std::max(0.0, remaining_seconds - __engine_params::MOVE_OVERHEAD);
+    const int moves = moves_to_go > 0
+        ? std::min(moves_to_go, __engine_params::MOVES_TO_GO)
+        : __engine_params::MOVES_TO_GO;
+
+    // the last move before a time control may run on further, since the clock is topped up after it, but
+    // still leaves a margin for the time taken to send the move
+    const double hard_share = moves == 1 ? __engine_params::LAST_MOVE_HARD_SHARE : __engine_params::HARD_LIMIT_SHARE;
+    const double hard_cap = usable * hard_share;
+    const double soft_cap = usable * __engine_params::HARD_LIMIT_SHARE;
+
+    const double soft = std::max(
+        __engine_params::MIN_MOVE_TIME,
+        std::min(soft_cap, usable / moves + increment_seconds * __engine_params::INCREMENT_SHARE));
+    const double hard = std::max(soft, std::min(hard_cap, soft * __engine_params::HARD_LIMIT_FACTOR));
+
+    return TimeBudget{soft, hard};
+}
@@ -0,0 +1,45 @@
+#ifndef STASE_TIME_MANAGER_H
+#define STASE_TIME_MANAGER_H
+
+namespace __engine_params {
+
+    /**
+     * A clock is budgeted as if MOVES_TO_GO moves were left to play on it, when it does not say how many
+     * are, after holding back MOVE_OVERHEAD seconds for the time spent outside the search. The soft limit
+     * takes an even share of what is left plus INCREMENT_SHARE of the increment; the hard limit is
+     * HARD_LIMIT_FACTOR times that. Neither is more than HARD_LIMIT_SHARE of what is left, except that the
+     * hard limit of the last move before a time control may reach LAST_MOVE_HARD_SHARE of it. Neither is
+     * less than MIN_MOVE_TIME, however little is left, so that a move is still searched for.
+     */
+    const int MOVES_TO_GO = 30;
+    const double MOVE_OVERHEAD = 0.02;  // (seconds)
+    const double INCREMENT_SHARE = 0.75;
+    const double HARD_LIMIT_FACTOR = 4.0;
+    const double HARD_LIMIT_SHARE = 0.4;
+    const double LAST_MOVE_HARD_SHARE = 0.8;
+    const double MIN_MOVE_TIME = 0.005;  // (seconds)
+
+    /**
+     * At the soft deadline, the search carries on if the best move at the root has changed within the
+     * last UNSTABLE_WINDOW of the soft limit: the deadline is then put back by STRETCH_FACTOR of the soft
+     * limit, up to the hard one.
+     */
+    const double UNSTABLE_WINDOW = 0.25;
+    const double STRETCH_FACTOR = 0.5;
+}
+
+/**
+ * The time a search may take, in seconds: it should stop at the soft limit unless its best move is still
+ * changing, and must stop at the hard limit. A negative limit is no limit.
+ */
+struct TimeBudget {
+    double soft_seconds;
+    double hard_seconds;
+
+    bool is_limited() const { return hard_seconds >= 0; }
+};
+
+TimeBudget budget_for_move_time(double seconds);
+TimeBudget budget_for_clock(double remaining_seconds, double increment_seconds, int moves_to_go);
+
+#endif //STASE_TIME_MANAGER_H
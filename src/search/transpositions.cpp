@@ -0,0 +1,89 @@
+#include <cstring>
+
+#include "transpositions.h"
+#include "../game/gamestate.hpp"
+
+TranspositionTable::TranspositionTable(std::pmr::memory_resource * mem) :
+    mem(mem)
+{}
+
+SearchNode * TranspositionTable::find(const Board & b) const {
+
+    const ZobristKey key = b.get_key();
+    const Stripe & stripe = stripe_for(key);
+
+    std::lock_guard<std::mutex> guard(stripe.m);
+    if (!stripe.slots) { return nullptr; }
+
+    for (size_t i = key & stripe.mask; stripe.slots[i]; i = (i + 1) & stripe.mask) {
+        SearchNode * node = stripe.slots[i];
+        if (node->board_hash == key
+                && node->gs->board.get_wholemoves() == b.get_wholemoves()
+                && node->gs->board.equivalent(b)) {
+            return node;
+        }
+    }
+    return nullptr;
+}
+
+void TranspositionTable::insert(SearchNode * node) {
+
+    Stripe & stripe = stripe_for(node->board_hash);
+    std::lock_guard<std::mutex> guard(stripe.m);
+
+    // kept at most half full, so that probes stay short
+    if (2 * (stripe.count + 1) > (int) (stripe.mask + 1)) {
+        grow(stripe);
+    }
+
+    size_t i = node->board_hash & stripe.mask;
+    while (stripe.slots[i]) {
+        i = (i + 1) & stripe.mask;
+    }
+    stripe.slots[i] = node;
+    ++stripe.count;
+}
+
+void TranspositionTable::clear() {
+    for (Stripe & stripe : stripes) {
+        std::lock_guard<std::mutex> guard(stripe.m);
+        stripe.slots = nullptr;
+        stripe.mask = 0;
+        stripe.count = 0;
+    }
+}
+
+int TranspositionTable::size() const {
+    int size = 0;
+    for (const Stripe & stripe : stripes) {
+        std::lock_guard<std::mutex> guard(stripe.m);
+        size += stripe.count;
+    }
+    return size;
+}
+
+/**
+ * Doubles the number of slots in the given stripe, whose lock the caller holds, and re-inserts every
+ * node in it. The old slots are left in the arena.
+ */
+void TranspositionTable::grow(Stripe & stripe) {
+
+    SearchNode ** old_slots = stripe.slots;
+    const size_t old_capacity = stripe.slots ? stripe.mask + 1 : 0;
+    const size_t capacity = stripe.slots ? 2 * old_capacity : FIRST_CAPACITY;
+
+    std::pmr::polymorphic_allocator<SearchNode *> alloc(mem);
+    stripe.slots = alloc.allocate(capacity);
+    std::memset(stripe.slots, 0, capacity * sizeof(SearchNode *));
+    stripe.mask = capacity - 1;
+
+    for (size_t j = 0; j < old_capacity; ++j) {
+        if (old_slots[j]) {
+            size_t i = old_slots[j]->board_hash & stripe.mask;
+            while (stripe.slots[i]) {
+                i = (i + 1) & stripe.mask;
+            }
+            stripe.slots[i] = old_slots[j];
+        }
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef STASE_TRANSPOSITIONS_H
+#define STASE_TRANSPOSITIONS_H
+
+#include <memory_resource>
+#include <mutex>
+
+#include "../../include/stase/search.h"
+
+/**
+ * The nodes of one search, indexed by the position they hold, so that a move leading to a position
+ * already in the tree can be linked to the node for it rather than building it again.
+ *
+ * Positions are told apart by move number as well as by Zobrist key, so nodes are only shared
+ * between paths of the same length. Every edge then goes one ply deeper, and linking a node can
+ * never close a cycle.
+ *
+ * The table is open addressed, and its slots are taken from the given resource, which should be
+ * the arena the nodes come from: a search's table is forgotten with clear() when its arena is reset,
+ * and owns no other memory.
+ *
+ * Several threads may be searching the tree, so the table is split into stripes by the high bits of
+ * the key, each a table of its own with its own lock. A lookup or insertion locks just the stripe
+ * the position falls in, and threads working on different positions rarely wait for each other.
+ */
+class TranspositionTable {
+
+public:
+    explicit TranspositionTable(std::pmr::memory_resource *);
+
+    TranspositionTable(const TranspositionTable &) = delete;
+    TranspositionTable & operator=(const TranspositionTable &) = delete;
+
+    /**
+     * @return the node holding the given position at the same move number, or nullptr if there is none
+     */
+    SearchNode * find(const Board &) const;
+
+    /**
+     * Adds a built node to the table. A position is only ever looked up by find, so adding a
+     * second node for one already present does no harm.
+     */
+    void insert(SearchNode *);
+
+    /**
+     * Forgets every node, without touching the slots: they belong to the arena, which is about to
+     * be reset.
+     */
+    void clear();
+
+    int size() const;
+
+private:
+    static constexpr int STRIPE_BITS = 6;
+    static constexpr int STRIPES = 1 << STRIPE_BITS;
+    static constexpr size_t FIRST_CAPACITY = 1 << 6;
+
+    struct Stripe {
+        mutable std::mutex m;
+        SearchNode ** slots = nullptr;
+        size_t mask = 0;
+        int count = 0;
+    };
+
+    std::pmr::memory_resource * mem;
+    Stripe stripes[STRIPES];
+
+    inline Stripe & stripe_for(const ZobristKey key) { return stripes[key >> (64 - STRIPE_BITS)]; }
+    inline const Stripe & stripe_for(const ZobristKey key) const { return stripes[key >> (64 - STRIPE_BITS)]; }
+
+    void grow(Stripe &);
+};
+
+#endif //STASE_TRANSPOSITIONS_H
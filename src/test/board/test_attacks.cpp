@@ -0,0 +1,74 @@
+#include "../test.h"
+#include "board.h"
+#include "../../board/board.hpp"
+#include "../../board/attacks.h"
+
+struct AttackTestCase {
+    const std::string fen;
+};
+
+const TestSet<AttackTestCase> attack_test_set{
+    "board-attacks",
+    {
+        AttackTestCase{starting_fen()},
+        AttackTestCase{"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"},
+        AttackTestCase{"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1"},
+        AttackTestCase{"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8"},
+        AttackTestCase{"8/8/8/8/8/8/8/8 w - - 0 1"},
+    }
+};
+
+namespace {
+    const Delta ROOK_DELTAS[4] = { {1, 0}, {-1, 0}, {0, 1}, {0, -1} };
+    const Delta BISHOP_DELTAS[4] = { {1, 1}, {-1, 1}, {1, -1}, {-1, -1} };
+}
+
+/**
+ * Walks out from the square one step at a time, as the old line search did.
+ */
+Square first_piece_walking(const Board & b, const Square s, const Delta d) {
+    int x = s.x + d.dx, y = s.y + d.dy;
+    while (val(x, y)) {
+        if (b.get(x, y) != EMPTY) { return mksq(x, y); }
+        x += d.dx;
+        y += d.dy;
+    }
+    return SQUARE_SENTINEL;
+}
+
+/**
+ * Compares the table lookups on every square against the slow walking implementation, using
+ * the occupancy of the position and also a few random occupancies derived from it.
+ */
+bool evaluate_attack_test_case(const AttackTestCase * tc) {
+
+    const Board b = board_utils::fen_to_board(tc->fen);
+    const Bitboard occs[4] = {
+        b.occupied(),
+        b.occupied() ^ 0x00FF00000000FF00ull,
+        b.occupied() * 0x9E3779B97F4A7C15ull,
+        b.occupied(WHITE),
+    };
+
+    for (const Bitboard occ : occs) {
+        for (int i = 0; i < 64; ++i) {
+            const Square s = index_sq(i);
+            if (rook_attacks(s, occ) != sliding_attacks_slow(s, occ, ROOK_DELTAS, 4)) { return false; }
+            if (bishop_attacks(s, occ) != sliding_attacks_slow(s, occ, BISHOP_DELTAS, 4)) { return false; }
+        }
+    }
+
+    for (int i = 0; i < 64; ++i) {
+        const Square s = index_sq(i);
+        for (int j = 0; j < 8; ++j) {
+            const Delta d = delta(XD[j], YD[j]);
+            if (!equal(first_piece_in_direction(s, d, b.occupied()), first_piece_walking(b, s, d))) { return false; }
+        }
+    }
+
+    return true;
+}
+
+bool test_attacks() {
+    return evaluate_test_set(&attack_test_set, &evaluate_attack_test_case);
+}
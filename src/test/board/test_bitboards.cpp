@@ -0,0 +1,78 @@
+#include "../test.h"
+#include "board.h"
+#include "../../board/board.hpp"
+
+struct BitboardTestCase {
+    const std::string fen;
+};
+
+const TestSet<BitboardTestCase> bitboard_test_set{
+    "board-bitboards",
+    {
+        BitboardTestCase{starting_fen()},
+        BitboardTestCase{"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"},
+        BitboardTestCase{"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1"},
+        BitboardTestCase{"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8"},
+        BitboardTestCase{"rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3"},
+        BitboardTestCase{"8/8/8/8/8/8/8/8 w - - 0 1"},
+    }
+};
+
+/**
+ * @return true if every bitboard held by the board agrees exactly with its squares array.
+ */
+bool bitboards_match_squares(const Board & b) {
+
+    Bitboard expected_pieces[NUM_PIECE_BBS]{};
+    Bitboard expected_colours[NUM_COLOUR_BBS]{};
+
+    for (int x = 0; x < 8; ++x) {
+        for (int y = 0; y < 8; ++y) {
+            Piece p = b.get(x, y);
+            if (p != EMPTY) {
+                expected_pieces[bb_index(p)] |= sq_bb(x, y);
+                expected_colours[bb_index(colour(p))] |= sq_bb(x, y);
+            }
+        }
+    }
+
+    for (int i = 0; i < NUM_PIECE_BBS; ++i) {
+        if (b.piece_bbs[i] != expected_pieces[i]) { return false; }
+    }
+    for (int i = 0; i < NUM_COLOUR_BBS; ++i) {
+        if (b.colour_bbs[i] != expected_colours[i]) { return false; }
+    }
+    return b.occupied() == (expected_colours[0] | expected_colours[1]);
+}
+
+/**
+ * Checks the bitboards after loading the position, then after every legal move (made both
+ * trustingly and untrustingly) and after each sneak/unsneak pair, one ply deep.
+ */
+bool evaluate_bitboard_test_case(const BitboardTestCase * tc) {
+
+    Board b = board_utils::fen_to_board(tc->fen);
+    if (!bitboards_match_squares(b)) { return false; }
+
+    for (const Move m : game_rules::legal_moves(b)) {
+
+        if (!bitboards_match_squares(b.successor(m))) { return false; }
+
+        Board hard = b.successor_hard(m);
+        if (!bitboards_match_squares(hard)) { return false; }
+        for (const Move reply : game_rules::legal_moves(hard)) {
+            if (!bitboards_match_squares(hard.successor_hard(reply))) { return false; }
+        }
+
+        Piece captured = b.sneak(m);
+        if (!bitboards_match_squares(b)) { return false; }
+        b.unsneak(m, captured);
+        if (!bitboards_match_squares(b)) { return false; }
+    }
+
+    return true;
+}
+
+bool test_bitboards() {
+    return evaluate_test_set(&bitboard_test_set, &evaluate_bitboard_test_case);
+}
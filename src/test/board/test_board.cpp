@@ -7,12 +7,22 @@ bool test_board(void) {
     passed = test_pieces() && passed;
     passed = test_set_get_square() && passed;
     // passed = test_read_write_fens() && passed;
+    passed = test_fen_round_trip() && passed;
     passed = test_in_check() && passed;
     passed = test_castling() && passed;
     passed = test_mutate() && passed;
     passed = test_mutate_hard() && passed;
     passed = test_move_scores() && passed;
+    passed = test_move_packing() && passed;
     passed = test_game_status() && passed;
+    passed = test_game_record() && passed;
+    passed = test_bitboards() && passed;
+    passed = test_attacks() && passed;
+    passed = test_zobrist() && passed;
+    passed = test_legal_moves() && passed;
+    passed = test_make_unmake() && passed;
+    passed = test_move_gen() && passed;
+    passed = test_san() && passed;
 
     return passed;
 }
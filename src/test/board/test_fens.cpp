@@ -34,3 +34,46 @@ bool test_read_write_fens() {
 
     return evaluate_test_set(&test_set, & evaluate_fen_test_case);
 }
+
+struct FenRoundTripTestCase {
+    const std::string fen;
+    // the FEN expected back, if it should differ from the one read
+    const std::string expected;
+};
+
+const TestSet<FenRoundTripTestCase> fen_round_trip_test_set{
+    "board-fen-round-trip",
+    {
+        FenRoundTripTestCase{starting_fen(), ""},
+        FenRoundTripTestCase{"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", ""},
+        FenRoundTripTestCase{"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", ""},
+        FenRoundTripTestCase{"rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3", ""},
+        FenRoundTripTestCase{"rnbqkbnr/pppp1ppp/8/8/3Pp3/8/PPP1PPPP/RNBQKBNR b Kq d3 0 2", ""},
+        FenRoundTripTestCase{"8/8/8/8/8/8/8/4K2k b - - 49 1234", ""},
+        // whitespace is forgiven, and missing move counters read as zero
+        FenRoundTripTestCase{"  4k3/8/8/8/8/8/8/4K3   w  -  -  3   20\r\n", "4k3/8/8/8/8/8/8/4K3 w - - 3 20"},
+        FenRoundTripTestCase{"4k3/8/8/8/8/8/8/4K3 w - -", "4k3/8/8/8/8/8/8/4K3 w - - 0 0"},
+    }
+};
+
+/**
+ * Checks that reading and then writing the FEN gives it back, and that the buffer writer agrees
+ * with board_to_fen.
+ */
+bool evaluate_fen_round_trip_test_case(const FenRoundTripTestCase * tc) {
+
+    const Board b = board_utils::fen_to_board(tc->fen);
+    const std::string & expected = tc->expected.empty() ? tc->fen : tc->expected;
+
+    char buf[MAX_FEN_LENGTH];
+    const size_t len = board_utils::write_fen(b, buf);
+
+    return std::string(buf, len) == expected
+        && board_utils::board_to_fen(b) == expected
+        && buf[len] == '\0'
+        && board_utils::fen_to_board(std::string_view(buf, len)).get_key() == b.get_key();
+}
+
+bool test_fen_round_trip() {
+    return evaluate_test_set(&fen_round_trip_test_set, &evaluate_fen_round_trip_test_case);
+}
@@ -1,5 +1,6 @@
 #include "board.h"
 #include "../test.h"
+#include "../../board/board.hpp"
 
 struct GameStatusTestCase {
     const std::vector<std::string> fen;
@@ -26,7 +27,11 @@ const TestSet<GameStatusTestCase> game_status_test_set{
                 DRAW_BY_STALEMATE
         },
         GameStatusTestCase{
-            { "8/8/3b4/8/3k4/6r1/3KR3/8 w - - 50 109" },
+            { "8/8/3b4/8/3k4/6r1/3KR3/8 w - - 99 109" },
+            ONGOING
+        },
+        GameStatusTestCase{
+            { "8/8/3b4/8/3k4/6r1/3KR3/8 w - - 100 109" },
             DRAW_BY_FIFTY_MOVES
         },
         GameStatusTestCase{
@@ -54,3 +59,55 @@ bool evaluate_game_status_test_case(const GameStatusTestCase * tc) {
 bool test_game_status() {
     return evaluate_test_set(&game_status_test_set, &evaluate_game_status_test_case);
 }
+
+struct GameRecordTestCase {
+    const std::string fen;
+    const std::vector<std::string> line;
+    const int expected_repetitions;
+    const GameStatus expected_status;
+};
+
+const TestSet<GameRecordTestCase> game_record_test_set{
+    "board-game-record",
+    {
+        GameRecordTestCase{starting_fen(), {}, 1, ONGOING},
+        GameRecordTestCase{starting_fen(), {"Nf3", "Nf6", "Ng1", "Ng8"}, 2, ONGOING},
+        GameRecordTestCase{starting_fen(), {"Nf3", "Nf6", "Ng1", "Ng8", "Nf3", "Nf6", "Ng1", "Ng8"}, 3, DRAW_BY_THREEFOLD},
+        GameRecordTestCase{"4k3/8/8/8/8/8/8/R3K3 w - - 0 1", {"Ra2", "Kd8", "Ra1", "Ke8", "Ra3", "Kd8", "Ra1"}, 2, ONGOING},
+        GameRecordTestCase{"4k3/8/8/8/8/8/8/R3K3 w - - 0 1", {"Ra2", "Kd8", "Ra1", "Ke8", "Ra3", "Kd8", "Ra1", "Ke8"}, 3, DRAW_BY_THREEFOLD},
+        // the positions before the pawn move don't count
+        GameRecordTestCase{starting_fen(), {"Nf3", "Nf6", "Ng1", "Ng8", "e3", "Nf6", "Nf3", "Ng8", "Ng1"}, 2, ONGOING},
+        GameRecordTestCase{starting_fen(), {"Nf3", "Nf6", "Ng1", "Ng8", "e3", "Nf6", "Nf3", "Ng8", "Ng1", "Nf6", "Nf3", "Ng8", "Ng1"}, 3, DRAW_BY_THREEFOLD},
+        GameRecordTestCase{"8/8/3b4/8/3k4/6r1/3KR3/8 w - - 98 109", {"Re1"}, 1, ONGOING},
+        GameRecordTestCase{"8/8/3b4/8/3k4/6r1/3KR3/8 w - - 99 109", {"Re1"}, 1, DRAW_BY_FIFTY_MOVES},
+        GameRecordTestCase{"rnbqkbnr/pppp1ppp/8/4p3/6P1/5P2/PPPPP2P/RNBQKBNR b KQkq - 0 2", {"Qh4"}, 1, BLACK_WON},
+    }
+};
+
+/**
+ * Plays the line into a GameRecord, checks the repetitions and status, and checks that popping
+ * every move goes back to the start.
+ */
+bool evaluate_game_record_test_case(const GameRecordTestCase * tc) {
+
+    Board b = board_utils::fen_to_board(tc->fen);
+    GameRecord record(b);
+
+    for (const std::string & san : tc->line) {
+        b = b.successor(stom(b, san));
+        record.push(b);
+    }
+
+    if (record.repetitions() != tc->expected_repetitions || record.status(b) != tc->expected_status) {
+        return false;
+    }
+
+    for (int i = 0; i < (int) tc->line.size() + 1; ++i) {
+        record.pop();
+    }
+    return record.size() == 1 && record.repetitions() == 1;
+}
+
+bool test_game_record() {
+    return evaluate_test_set(&game_record_test_set, &evaluate_game_record_test_case);
+}
@@ -38,6 +38,13 @@ const TestSet<CheckTestCase> in_check_test_set{
 
 bool evaluate_check_test_case(const CheckTestCase * tc) {
     Board b = board_utils::fen_to_board(tc->fen);
+    const Colour c = b.colour_to_move();
+    const Square king = b.king_square(c);
+
+    // the king square should be found, and the fast path should agree
+    if (b.get(king) != mkpiece(c, KING) || game_rules::in_check(b, c, king) != game_rules::in_check(b)) {
+        return false;
+    }
     return game_rules::in_check(b) == b.get_cas_ws();
 }
 
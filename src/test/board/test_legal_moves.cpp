@@ -0,0 +1,84 @@
+#include "../test.h"
+#include "board.h"
+#include "../../board/board.hpp"
+
+struct LegalMovesTestCase {
+    const std::string fen;
+};
+
+const TestSet<LegalMovesTestCase> legal_moves_test_set{
+    "board-legal-moves",
+    {
+        LegalMovesTestCase{starting_fen()},
+        LegalMovesTestCase{"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"},
+        // en-passant which would expose the king along the rank
+        LegalMovesTestCase{"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1"},
+        LegalMovesTestCase{"8/8/8/K2pP2r/8/8/8/7k w - d6 0 2"},
+        LegalMovesTestCase{"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1"},
+        LegalMovesTestCase{"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8"},
+        // checks: double, slider, knight and pawn
+        LegalMovesTestCase{"4k3/8/8/8/1b6/8/3N4/r3K3 w - - 0 1"},
+        LegalMovesTestCase{"4k3/8/8/8/8/5n2/8/R3K2R w KQ - 0 1"},
+        LegalMovesTestCase{"4k3/8/8/8/8/8/3p4/4K3 w - - 0 1"},
+        LegalMovesTestCase{"4k3/8/8/2Pp4/1K6/8/8/8 w - d6 0 1"},
+        // pinned pieces
+        LegalMovesTestCase{"4k3/4r3/8/8/4B3/8/4N3/4K3 w - - 0 1"},
+        LegalMovesTestCase{"4k3/8/8/7b/8/8/4R3/3K4 w - - 0 1"},
+        LegalMovesTestCase{"8/8/8/8/8/8/8/8 w - - 0 1"},
+    }
+};
+
+/**
+ * The obvious way to generate legal moves: make each pseudo-legal move and see whether it
+ * leaves the mover in check.
+ */
+std::vector<Move> reference_legal_moves(const Board & b) {
+
+    std::vector<Move> moves;
+    Bitboard own_pieces = b.occupied(b.colour_to_move());
+
+    while (own_pieces) {
+        Move piece_moves_arr[32];
+        ptr_vec<Move> piece_moves(piece_moves_arr, 32);
+        game_rules::piecemoves_ignore_check(b, pop_lsb(own_pieces), piece_moves);
+        for (int j = 0; j < piece_moves.size(); ++j) {
+            Board local = b;
+            local.mutate_hard(piece_moves[j]);
+            if (!game_rules::in_check(local, b.colour_to_move())) {
+                moves.push_back(piece_moves[j]);
+            }
+        }
+    }
+    return moves;
+}
+
+/**
+ * @return true if the generator agrees exactly (including order) with the reference, in this
+ * position and in every position reached after one and two plies.
+ */
+bool legal_moves_match(const Board & b, int depth) {
+
+    Move moves_arr[MAX_LEGAL_MOVES];
+    ptr_vec<Move> moves(moves_arr, MAX_LEGAL_MOVES);
+    game_rules::legal_moves(b, moves);
+    std::vector<Move> expected = reference_legal_moves(b);
+
+    if (moves.size() != expected.size()) { return false; }
+    for (int i = 0; i < moves.size(); ++i) {
+        if (!equal_exactly(moves[i], expected[i])) { return false; }
+    }
+
+    if (depth == 0) { return true; }
+    for (int i = 0; i < moves.size(); ++i) {
+        if (!legal_moves_match(b.successor(moves[i]), depth - 1)) { return false; }
+    }
+    return true;
+}
+
+bool evaluate_legal_moves_test_case(const LegalMovesTestCase * tc) {
+    return legal_moves_match(board_utils::fen_to_board(tc->fen), 2);
+}
+
+bool test_legal_moves() {
+    return evaluate_test_set(&legal_moves_test_set, &evaluate_legal_moves_test_case);
+}
@@ -0,0 +1,70 @@
+#include "../test.h"
+#include "board.h"
+#include "../../board/board.hpp"
+
+struct MakeUnmakeTestCase {
+    const std::string fen;
+};
+
+const TestSet<MakeUnmakeTestCase> make_unmake_test_set{
+    "board-make-unmake",
+    {
+        MakeUnmakeTestCase{starting_fen()},
+        MakeUnmakeTestCase{"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"},
+        // en-passant, on both sides of the board
+        MakeUnmakeTestCase{"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1"},
+        MakeUnmakeTestCase{"4k3/8/8/2Pp4/1K6/8/8/8 w - d6 0 1"},
+        MakeUnmakeTestCase{"4k3/8/8/8/3pP3/8/8/4K3 b - e3 0 1"},
+        // promotions, with and without capture
+        MakeUnmakeTestCase{"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1"},
+        MakeUnmakeTestCase{"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8"},
+        // castling on both wings, for both sides
+        MakeUnmakeTestCase{"r3k2r/8/8/8/8/8/8/R3K2R b KQkq - 0 1"},
+    }
+};
+
+bool same_board(const Board & a, const Board & b) {
+    for (int x = 0; x < 8; ++x) {
+        for (int y = 0; y < 8; ++y) {
+            if (a.get(x, y) != b.get(x, y)) { return false; }
+        }
+    }
+    for (const Piece p : {W_PAWN, W_KNIGHT, W_BISHOP, W_ROOK, W_QUEEN, W_KING,
+                          B_PAWN, B_KNIGHT, B_BISHOP, B_ROOK, B_QUEEN, B_KING}) {
+        if (a.pieces(p) != b.pieces(p)) { return false; }
+    }
+    return a.get_conf_word() == b.get_conf_word()
+        && a.get_key() == b.get_key()
+        && a.occupied(WHITE) == b.occupied(WHITE)
+        && a.occupied(BLACK) == b.occupied(BLACK);
+}
+
+/**
+ * @return true if making each legal move gives the same board as successor_hard, and unmaking
+ * it restores the original, in this position and every position reached to the given depth.
+ */
+bool make_unmake_matches(Board & b, const int depth) {
+
+    if (depth == 0) { return true; }
+
+    const Board original = b;
+    BoardUndo undo;
+
+    for (const Move m : game_rules::legal_moves(b)) {
+        b.make_move(m, undo);
+        if (!same_board(b, original.successor_hard(m))) { return false; }
+        if (!make_unmake_matches(b, depth - 1)) { return false; }
+        b.unmake_move(m, undo);
+        if (!same_board(b, original)) { return false; }
+    }
+    return true;
+}
+
+bool evaluate_make_unmake_test_case(const MakeUnmakeTestCase * tc) {
+    Board b = board_utils::fen_to_board(tc->fen);
+    return make_unmake_matches(b, 2);
+}
+
+bool test_make_unmake() {
+    return evaluate_test_set(&make_unmake_test_set, &evaluate_make_unmake_test_case);
+}
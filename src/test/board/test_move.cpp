@@ -36,3 +36,49 @@ bool test_move_scores() {
     return evaluate_test_set(&set, &evaluate_move_score_test_case);
 
 }
+
+struct MovePackingTestCase {
+    Square from;
+    Square to;
+};
+
+/**
+ * Checks that the squares survive being packed, and are not disturbed by the flags (or vice versa).
+ */
+bool evaluate_move_packing_test_case(const MovePackingTestCase * tc) {
+    Move m{tc->from, tc->to, 0};
+    if (!equal(m.from(), tc->from) || !equal(m.to(), tc->to)) {
+        return false;
+    }
+    m.set_prom_piece(KNIGHT);
+    m.set_cap_piece(B_QUEEN);
+    m.set_score(15);
+    if (!equal(m.from(), tc->from) || !equal(m.to(), tc->to)) {
+        return false;
+    }
+    m.set_from(tc->to);
+    m.set_to(tc->from);
+    return equal(m.from(), tc->to) && equal(m.to(), tc->from)
+        && m.get_cap_piece() == B_QUEEN && m.get_score() == 15;
+}
+
+bool test_move_packing() {
+
+    std::vector<MovePackingTestCase> cases;
+
+    for (int i = 0; i < 64; ++i) {
+        for (int j = 0; j < 64; ++j) {
+            cases.push_back(MovePackingTestCase{index_sq(i), index_sq(j)});
+        }
+        cases.push_back(MovePackingTestCase{index_sq(i), SQUARE_SENTINEL});
+    }
+    cases.push_back(MovePackingTestCase{SQUARE_SENTINEL, SQUARE_SENTINEL});
+
+    TestSet<MovePackingTestCase> set{
+        "board-move-packing",
+        cases
+    };
+
+    return evaluate_test_set(&set, &evaluate_move_packing_test_case);
+
+}
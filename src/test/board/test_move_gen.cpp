@@ -0,0 +1,93 @@
+#include "../test.h"
+#include "board.h"
+#include "../../board/board.hpp"
+#include "../../board/move_gen.h"
+
+struct MoveGenTestCase {
+    const std::string fen;
+};
+
+const TestSet<MoveGenTestCase> move_gen_test_set{
+    "board-move-gen",
+    {
+        MoveGenTestCase{starting_fen()},
+        MoveGenTestCase{"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"},
+        MoveGenTestCase{"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1"},
+        MoveGenTestCase{"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1"},
+        MoveGenTestCase{"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8"},
+        MoveGenTestCase{"4k3/8/8/2Pp4/1K6/8/8/8 w - d6 0 1"},
+        // double check
+        MoveGenTestCase{"4k3/8/8/8/1b6/8/3N4/r3K3 w - - 0 1"},
+        // mate and stalemate
+        MoveGenTestCase{"rnb1kbnr/pppp1ppp/8/4p3/6Pq/5P2/PPPPP2P/RNBQKBNR w KQkq - 1 3"},
+        MoveGenTestCase{"7k/5Q2/6K1/8/8/8/8/8 b - - 0 1"},
+        // no king at all
+        MoveGenTestCase{"8/8/8/8/3Q4/8/8/8 w - - 0 1"},
+    }
+};
+
+/**
+ * The stages, judged from the flags alone.
+ */
+GenStage stage_of(const Move m) {
+    if (m.is_cap()) { return GEN_CAPTURES; }
+    if (m.is_prom()) { return GEN_PROMOTIONS; }
+    if (m.is_cas()) { return GEN_CASTLING; }
+    return GEN_QUIETS;
+}
+
+int victim_value(const Move m) {
+    switch (type(m.get_cap_piece())) {
+        case PAWN: return 1;
+        case KNIGHT: case BISHOP: return 3;
+        case ROOK: return 5;
+        case QUEEN: return 9;
+        default: return 0;
+    }
+}
+
+/**
+ * Checks that the staged generator gives exactly the legal moves, each in the right stage and
+ * with the stages in order, and the captures by falling victim value. Also checks that
+ * has_any_legal_move agrees.
+ */
+bool evaluate_move_gen_test_case(const MoveGenTestCase * tc) {
+
+    const Board b = board_utils::fen_to_board(tc->fen);
+    std::vector<Move> legal = game_rules::legal_moves(b);
+
+    if (game_rules::has_any_legal_move(b) == legal.empty()) { return false; }
+
+    MoveGen gen(b);
+    Move m;
+    GenStage last_stage = GEN_CAPTURES;
+    int last_victim = 100;
+    int count = 0;
+
+    while (gen.next(m)) {
+        if (gen.stage() != stage_of(m) || gen.stage() < last_stage) { return false; }
+        if (gen.stage() == GEN_CAPTURES) {
+            if (victim_value(m) > last_victim) { return false; }
+            last_victim = victim_value(m);
+        }
+        last_stage = gen.stage();
+
+        // each move should be legal, and given only once
+        bool found = false;
+        for (Move & l : legal) {
+            if (!is_sentinel(l) && equal_exactly(l, m)) {
+                l = MOVE_SENTINEL;
+                found = true;
+                break;
+            }
+        }
+        if (!found) { return false; }
+        ++count;
+    }
+
+    return count == (int) legal.size() && gen.stage() == GEN_DONE;
+}
+
+bool test_move_gen() {
+    return evaluate_test_set(&move_gen_test_set, &evaluate_move_gen_test_case);
+}
@@ -0,0 +1,103 @@
+#include "../test.h"
+#include "board.h"
+#include "../../board/board.hpp"
+
+struct SanTestCase {
+    const std::string fen;
+    const std::string from;
+    const std::string to;
+    const std::string expected;
+};
+
+const TestSet<SanTestCase> san_test_set{
+    "board-san",
+    {
+        SanTestCase{starting_fen(), "g1", "f3", "Nf3"},
+        SanTestCase{starting_fen(), "e2", "e4", "e4"},
+        // two knights, by file, by rank, and totally
+        SanTestCase{"4k3/8/8/8/8/8/8/1N2KN2 w - - 0 1", "b1", "d2", "Nbd2"},
+        SanTestCase{"4k3/8/8/8/8/1N6/8/1N2K3 w - - 0 1", "b1", "d2", "N1d2"},
+        SanTestCase{"4k3/8/8/8/8/5Q1Q/8/4K2Q w - - 0 1", "h3", "f1", "Qh3f1"},
+        // the other knight is pinned, so there's nothing to disambiguate
+        SanTestCase{"4k3/4r3/8/8/8/8/4N3/1N2K3 w - - 0 1", "b1", "c3", "Nc3"},
+        // a rook behind the other isn't a rival
+        SanTestCase{"4k3/8/8/8/8/8/8/R2RK3 w - - 0 1", "d1", "d7", "Rd7"},
+        // pawn captures, including en passant
+        SanTestCase{"4k3/8/8/8/8/2p1p3/3P4/4K3 b - - 0 1", "c3", "d2", "cxd2"},
+        SanTestCase{"4k3/8/8/2PpP3/8/8/8/4K3 w - d6 0 1", "e5", "d6", "exd6"},
+        SanTestCase{"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", "e1", "g1", "O-O"},
+    }
+};
+
+struct SanRoundTripTestCase {
+    const std::string fen;
+};
+
+/**
+ * Positions whose every line of two plies is converted to SAN and back.
+ */
+const TestSet<SanRoundTripTestCase> san_round_trip_test_set{
+    "board-san-round-trip",
+    {
+        SanRoundTripTestCase{starting_fen()},
+        SanRoundTripTestCase{"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"},
+        SanRoundTripTestCase{"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1"},
+        SanRoundTripTestCase{"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1"},
+        SanRoundTripTestCase{"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8"},
+    }
+};
+
+/**
+ * Checks that every legal move's SAN reads back as that move, and that the batched conversions
+ * agree with converting each move on its own.
+ */
+bool san_round_trips(const Board & b) {
+
+    const std::vector<Move> legal = game_rules::legal_moves(b);
+    std::vector<std::string> sans;
+    mtos(b, legal, sans);
+
+    if (sans.size() != legal.size()) { return false; }
+
+    for (int i = 0; i < (int) legal.size(); ++i) {
+        if (sans[i] != mtos(b, legal[i]) || !equal_exactly(stom(b, sans[i]), legal[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool evaluate_san_test_case(const SanTestCase * tc) {
+
+    const Board b = board_utils::fen_to_board(tc->fen);
+
+    for (const Move m : game_rules::legal_moves(b)) {
+        if (equal(m.from(), stosq(tc->from)) && equal(m.to(), stosq(tc->to))) {
+            return mtos(b, m) == tc->expected && san_round_trips(b);
+        }
+    }
+    return false;
+}
+
+bool evaluate_san_round_trip_test_case(const SanRoundTripTestCase * tc) {
+
+    const Board b = board_utils::fen_to_board(tc->fen);
+    if (!san_round_trips(b)) { return false; }
+
+    for (const Move m : game_rules::legal_moves(b)) {
+        const Board child = b.successor(m);
+        if (!san_round_trips(child)) { return false; }
+
+        for (const Move reply : game_rules::legal_moves(child)) {
+            const std::vector<Move> line{m, reply};
+            if (mtos_line(b, line) != mtos(b, m) + " " + mtos(child, reply)) { return false; }
+        }
+    }
+    return true;
+}
+
+bool test_san() {
+    bool passed = evaluate_test_set(&san_test_set, &evaluate_san_test_case);
+    passed = evaluate_test_set(&san_round_trip_test_set, &evaluate_san_round_trip_test_case) && passed;
+    return passed;
+}
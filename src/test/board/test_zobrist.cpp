@@ -0,0 +1,87 @@
+#include "../test.h"
+#include "board.h"
+#include "../../board/board.hpp"
+
+struct ZobristTestCase {
+    const std::string fen;
+    const std::vector<std::string> line_1;
+    const std::vector<std::string> line_2;
+    const bool same_position;
+};
+
+const TestSet<ZobristTestCase> zobrist_test_set{
+    "board-zobrist",
+    {
+        // transposition
+        ZobristTestCase{starting_fen(), {"Nf3", "Nf6", "Nc3"}, {"Nc3", "Nf6", "Nf3"}, true},
+        // knights out and back: same pieces, same side to move
+        ZobristTestCase{starting_fen(), {"Nf3", "Nf6", "Ng1", "Ng8"}, {}, true},
+        // same pieces, different side to move
+        ZobristTestCase{"4k3/8/8/8/8/8/8/R3K3 w - - 0 1", {"Ra2", "Kd8", "Ra1", "Ke8"}, {"Ra3", "Kd8", "Ra2", "Ke8", "Ra1"}, false},
+        // king out and back loses castling rights
+        ZobristTestCase{"r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1", {"Kf1", "Kf8", "Ke1", "Ke8"}, {}, false},
+        // rook out and back loses one castling right
+        ZobristTestCase{"r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1", {"Rb1", "Rb8", "Ra1", "Ra8"}, {}, false},
+        // double pawn push leaves an en-passant file behind
+        ZobristTestCase{"4k3/8/8/8/8/8/4P3/4K3 w - - 0 1", {"e4"}, {"e3", "Kd8", "Kd1", "Kd7", "Ke1", "Ke8", "e4"}, false},
+        ZobristTestCase{"4k3/8/8/8/8/8/4P3/4K3 w - - 0 1", {"e4", "Kd8", "Kd1", "Ke8", "Ke1"}, {"e3", "Kd8", "e4", "Kd7", "Kd1", "Ke8", "Ke1"}, true},
+        // castling
+        ZobristTestCase{"r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1", {"O-O", "O-O-O"}, {"O-O-O", "O-O"}, false},
+        ZobristTestCase{"r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1", {"O-O", "O-O-O", "Kg2"}, {"O-O", "O-O-O", "Rab1"}, false},
+        // promotion
+        ZobristTestCase{"4k3/1P6/8/8/8/8/8/4K3 w - - 0 1", {"b8=Q", "Kf7", "Kd1"}, {"Kd1", "Kf7", "b8=Q"}, true},
+        ZobristTestCase{"4k3/1P6/8/8/8/8/8/4K3 w - - 0 1", {"b8=Q", "Kf7", "Kd1"}, {"Kd1", "Kf7", "b8=N"}, false},
+    }
+};
+
+/**
+ * Checks that the incremental key agrees with one computed from scratch after every legal move
+ * from the position, made both trustingly and untrustingly, and after sneak/unsneak.
+ */
+bool keys_stay_in_sync(Board & b) {
+
+    if (b.get_key() != b.compute_key()) { return false; }
+
+    for (const Move m : game_rules::legal_moves(b)) {
+        Board succ = b.successor(m);
+        if (succ.get_key() != succ.compute_key()) { return false; }
+
+        Board hard = b.successor_hard(m);
+        if (hard.get_key() != hard.compute_key() || hard.get_key() != succ.get_key()) { return false; }
+
+        ZobristKey before = b.get_key();
+        Piece captured = b.sneak(m);
+        b.unsneak(m, captured);
+        if (b.get_key() != before) { return false; }
+    }
+    return true;
+}
+
+/**
+ * Plays the given SAN moves from the position.
+ */
+Board play_line(Board b, const std::vector<std::string> & line) {
+    for (const std::string & m : line) {
+        b = b.successor(stom(b, m));
+    }
+    return b;
+}
+
+bool evaluate_zobrist_test_case(const ZobristTestCase * tc) {
+
+    const Board start = board_utils::fen_to_board(tc->fen);
+    Board b_1 = play_line(start, tc->line_1);
+    Board b_2 = play_line(start, tc->line_2);
+
+    if (!keys_stay_in_sync(b_1) || !keys_stay_in_sync(b_2)) { return false; }
+
+    // positions reached via FEN should agree with those reached by playing moves
+    if (board_utils::fen_to_board(board_utils::board_to_fen(b_1)).get_key() != b_1.get_key()) { return false; }
+
+    return (b_1.get_key() == b_2.get_key()) == tc->same_position
+        && b_1.equivalent(b_2) == tc->same_position;
+}
+
+bool test_zobrist() {
+    return evaluate_test_set(&zobrist_test_set, &evaluate_zobrist_test_case);
+}
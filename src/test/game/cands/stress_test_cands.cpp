@@ -55,7 +55,8 @@ bool stress_test_cands(std::vector<Gamestate> & states) {
         Gamestate & gs = states[i];
         gs.clear_all_frames();
 
-        std::vector<Move> moves = cands(gs, new CandSet)->critical;
+        CandSet cand_set;
+        const std::pmr::vector<Move> & moves = cands(gs, &cand_set)->critical;
         std::vector<Move> legals = game_rules::legal_moves(gs.board);
 
         if (moves.size() > MAX_TOTAL_CANDS) {
@@ -67,8 +68,8 @@ bool stress_test_cands(std::vector<Gamestate> & states) {
 
         for (int j = 0; j < moves.size(); ++j) {
 
-            if (!val(moves[j].from) || !val(moves[j].to)) {
-                cout << "\n[" << i << "] FAILED(invalid): Received " << sqtos(moves[j].from) << " to " << sqtos(moves[j].to) << "\n";
+            if (!val(moves[j].from()) || !val(moves[j].to())) {
+                cout << "\n[" << i << "] FAILED(invalid): Received " << sqtos(moves[j].from()) << " to " << sqtos(moves[j].to()) << "\n";
                 cout << board_utils::board_to_fen(gs.board) << "\n";
                 board_utils::print(gs.board);
                 return false;
@@ -83,7 +84,7 @@ bool stress_test_cands(std::vector<Gamestate> & states) {
             }
 
             if (!is_legal) {
-                cout << "\n[" << i << "] FAILED(illegal): Received " << sqtos(moves[j].from) << " to " << sqtos(moves[j].to) << "\n";
+                cout << "\n[" << i << "] FAILED(illegal): Received " << sqtos(moves[j].from()) << " to " << sqtos(moves[j].to()) << "\n";
                 cout << board_utils::board_to_fen(gs.board) << "\n";
                 board_utils::print(gs.board);
                 return false;
@@ -11,7 +11,7 @@ bool __test_cand_sorting() {
     }
 
     CandSet c;
-    c.critical = moves;
+    c.critical.assign(moves.begin(), moves.end());
     c.order_list(CRITICAL);
 
     for (int i = 0; i < 10; ++i) {
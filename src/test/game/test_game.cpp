@@ -7,6 +7,8 @@ bool test_game() {
     // top level
     passed = test_pin_cache() && passed;
     passed = test_cands_sorting() && passed;
+    passed = test_gs_make_unmake() && passed;
+    passed = test_gs_copy_move() && passed;
 
     // cands
     passed = test_unsafe_piece_hook() && passed;
@@ -0,0 +1,123 @@
+#include "../test.h"
+#include "../../game/gamestate.hpp"
+
+const TestSet<StringTestCase> gs_make_unmake_test_set{
+    "game-gs-make-unmake",
+    {
+        StringTestCase{"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", {}},
+        StringTestCase{"3rr1k1/p1p2ppp/1qP1pn2/1P2N3/3PP3/3Q1P2/6PP/RR4K1 w - - 3 23", {}},
+        StringTestCase{"1k1r1r2/1pp2q2/p7/2P1R2p/3nQ3/5N2/PP1B1PPP/R5K1 w - - 0 23", {}},
+        StringTestCase{"4k3/8/8/2Pp4/1K6/8/8/8 w - d6 0 1", {}},
+        StringTestCase{"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", {}},
+    }
+};
+
+/**
+ * Compares everything the gamestate derives from its board: kings, pins, discoveries and king
+ * nets. The control counts are read through the cache, so stale entries would show up, but they
+ * are only comparable when the cache was filled in the same position: control is cached across
+ * moves on the understanding that distant squares are unaffected, which is not exact.
+ */
+bool same_gamestate(const Gamestate & a, const Gamestate & b, const bool compare_control) {
+
+    if (!equal(a.w_king, b.w_king) || !equal(a.b_king, b.b_king)) { return false; }
+    if (a.w_king_net.flight_squares() != b.w_king_net.flight_squares()
+            || a.b_king_net.flight_squares() != b.b_king_net.flight_squares()) { return false; }
+
+    for (int x = 0; x < 8; ++x) {
+        for (int y = 0; y < 8; ++y) {
+            const Square s = mksq(x, y);
+            if (a.board.get(s) != b.board.get(s)) { return false; }
+            if (compare_control
+                    && a.control_cache.get_control_count(s) != b.control_cache.get_control_count(s)) {
+                return false;
+            }
+            if (a.board.get(s) == EMPTY || type(a.board.get(s)) == KING) { continue; }
+            if (!equal(a.delta_of_kpinned_piece(s), b.delta_of_kpinned_piece(s))) { return false; }
+            if (a.can_discover_check(s) != b.can_discover_check(s)) { return false; }
+        }
+    }
+    return a.board.get_key() == b.board.get_key();
+}
+
+/**
+ * Fills the control cache for every square, so that later moves have something to invalidate.
+ */
+void fill_control_cache(const Gamestate & gs) {
+    for (int x = 0; x < 8; ++x) {
+        for (int y = 0; y < 8; ++y) {
+            gs.control_cache.get_control_count(mksq(x, y));
+        }
+    }
+}
+
+/**
+ * @return true if making each legal move gives the same gamestate as one constructed from
+ * scratch, and unmaking it restores the original, to the given depth.
+ */
+bool gs_make_unmake_matches(Gamestate & gs, const Gamestate & reference, const int depth) {
+
+    if (depth == 0) { return true; }
+
+    GamestateUndo undo;
+    for (const Move m : game_rules::legal_moves(gs.board)) {
+        gs.make_move(m, undo);
+        fill_control_cache(gs);
+        const Gamestate succ(board_utils::board_to_fen(gs.board));
+        if (!same_gamestate(gs, succ, false)) { return false; }
+        if (!gs_make_unmake_matches(gs, succ, depth - 1)) { return false; }
+        gs.unmake_move(m, undo);
+        if (!same_gamestate(gs, reference, false)) { return false; }
+    }
+    return true;
+}
+
+bool evaluate_gs_make_unmake_test_case(const StringTestCase * tc) {
+
+    Gamestate gs(tc->fen);
+    const Gamestate reference(tc->fen);
+    fill_control_cache(gs);
+
+    if (!gs_make_unmake_matches(gs, reference, 2)) { return false; }
+
+    // every cached value in the starting position was exact, so it must still be
+    return same_gamestate(gs, reference, true);
+}
+
+bool test_gs_make_unmake() {
+    return evaluate_test_set(&gs_make_unmake_test_set, &evaluate_gs_make_unmake_test_case);
+}
+
+const TestSet<StringTestCase> gs_copy_move_test_set{
+    "game-gs-copy-move",
+    {
+        StringTestCase{"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", {}},
+        StringTestCase{"1k1r1r2/1pp2q2/p7/2P1R2p/3nQ3/5N2/PP1B1PPP/R5K1 w - - 0 23", {}},
+        StringTestCase{"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", {}},
+    }
+};
+
+/**
+ * Copies and moves a gamestate with a filled control cache: the result must match the original,
+ * and its cache must refer to the new gamestate rather than the one it came from.
+ */
+bool evaluate_gs_copy_move_test_case(const StringTestCase * tc) {
+
+    Gamestate gs(tc->fen);
+    const Gamestate reference(tc->fen);
+    fill_control_cache(gs);
+
+    const Gamestate copied(gs);
+    if (copied.control_cache.gs != &copied || !same_gamestate(copied, reference, true)) { return false; }
+
+    const Gamestate moved(std::move(gs));
+    if (moved.control_cache.gs != &moved || !same_gamestate(moved, reference, true)) { return false; }
+
+    Gamestate assigned(Board::starting_pos());
+    assigned = copied;
+    return assigned.control_cache.gs == &assigned && same_gamestate(assigned, reference, true);
+}
+
+bool test_gs_copy_move() {
+    return evaluate_test_set(&gs_copy_move_test_set, &evaluate_gs_copy_move_test_case);
+}
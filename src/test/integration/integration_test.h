@@ -55,5 +55,6 @@ inline bool evaluate_integration_test(const IntegrationTest * test) {
 }
 
 bool test_piece_mates();
+bool test_uci();
 
 #endif //STASE_INTEGRATION_TEST_H
@@ -5,6 +5,7 @@ bool integration_test_main() {
     bool passed = true;
 
     passed = test_piece_mates() && passed;
+    passed = test_uci() && passed;
 
     return passed;
 }
@@ -0,0 +1,108 @@
+#include <chrono>
+#include <sstream>
+#include <thread>
+
+#include "integration_test.h"
+#include "../../uci/uci_session.h"
+#include "../../utils/utils.h"
+
+/**
+ * A script of UCI commands, each sent after a pause to let any search run, and the position the last best move
+ * must be legal in.
+ */
+struct UciTestCase {
+    const std::vector<std::string> commands;
+    const double pause_seconds;
+    const std::string final_fen;
+};
+
+const TestSet<UciTestCase> uci_test_set{
+    "integration-uci",
+    {
+        UciTestCase{
+            {"uci", "isready", "position startpos moves e2e4", "go movetime 100", "quit"},
+            0.2,
+            "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1"
+        },
+        // the second position follows on from the first, so the tree is kept
+        UciTestCase{
+            {"position startpos", "go nodes 2000", "position startpos moves e2e4 e7e5",
+             "go wtime 2000 btime 2000 winc 20 binc 20", "isready", "quit"},
+            0.3,
+            "rnbqkbnr/pppp1ppp/8/4p3/4P3/8/PPPP1PPP/RNBQKBNR w KQkq e6 0 2"
+        },
+        UciTestCase{
+            {"position fen r1bqkb1r/pppp1ppp/2n2n2/4p3/4P3/2N2N2/PPPP1PPP/R1BQKB1R w KQkq - 4 4",
+             "go ponder wtime 1000 btime 1000", "ponderhit", "quit"},
+            0.2,
+            "r1bqkb1r/pppp1ppp/2n2n2/4p3/4P3/2N2N2/PPPP1PPP/R1BQKB1R w KQkq - 4 4"
+        },
+        UciTestCase{
+            {"ucinewgame", "setoption name Threads value 2", "position startpos moves d2d4", "go infinite", "stop"},
+            0.2,
+            "rnbqkbnr/pppppppp/8/8/3P4/8/PPP1PPPP/RNBQKBNR b KQkq d3 0 1"
+        },
+    }
+};
+
+int count_starting_with(const std::vector<std::string> & lines, const std::string & prefix) {
+    int count = 0;
+    for (const std::string & line : lines) {
+        if (line.rfind(prefix, 0) == 0) { ++count; }
+    }
+    return count;
+}
+
+/**
+ * Runs the script, then checks that each uci and isready was answered, that each go sent info and then a best
+ * move, and that the last best move is legal in the final position.
+ */
+bool evaluate_uci_test_case(const UciTestCase * test) {
+
+    std::istringstream in;
+    std::ostringstream out;
+    {
+        UciSession session(in, out);
+        for (const std::string & command : test->commands) {
+            session.handle(command);
+            std::this_thread::sleep_for(std::chrono::duration<double>(test->pause_seconds));
+        }
+    }
+
+    std::vector<std::string> lines;
+    split(lines, out.str(), '\n');
+
+    if (count_starting_with(lines, "uciok") != count_starting_with(test->commands, "uci")
+            - count_starting_with(test->commands, "ucinewgame")) {
+        std::cout << "uci was not answered\n";
+        return false;
+    }
+    if (count_starting_with(lines, "readyok") != count_starting_with(test->commands, "isready")) {
+        std::cout << "isready was not answered\n";
+        return false;
+    }
+    if (count_starting_with(lines, "bestmove") != count_starting_with(test->commands, "go")
+            || count_starting_with(lines, "info depth") == 0) {
+        std::cout << "search was not reported:\n" << out.str();
+        return false;
+    }
+
+    std::string best;
+    for (const std::string & line : lines) {
+        if (line.rfind("bestmove", 0) == 0) { best = line; }
+    }
+    std::istringstream words(best);
+    std::string word, move;
+    words >> word >> move;
+
+    const Board board = board_utils::fen_to_board(test->final_fen);
+    if (is_sentinel(legal_move_for_uci(board, move))) {
+        std::cout << "illegal best move: " << best << "\n";
+        return false;
+    }
+    return true;
+}
+
+bool test_uci() {
+    return evaluate_test_set(&uci_test_set, &evaluate_uci_test_case);
+}
@@ -0,0 +1,54 @@
+#include <chrono>
+#include <thread>
+
+#include "../test.h"
+#include "test_search_helpers.h"
+#include "search.h"
+#include "../../search/search_tools.h"
+
+const TestSet<std::string> cancellation_test_set{"search-cancellation", search_test_positions()};
+
+/**
+ * Kills a search part way through, twice over on the same tree. Each time the tree must be left
+ * consistent, with no node locked, and the second search must carry on from the first. Killing the
+ * engine again once it has stopped must do nothing, and an engine destroyed while it is still
+ * searching must stop its search first.
+ */
+bool evaluate_cancellation_test_case(const std::string * fen) {
+
+    Engine engine =
+        EngineBuilder::for_position(*fen)
+            .with_threads(2)
+            .build();
+
+    int first_nodes = 0;
+    engine.run();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    engine.kill();
+    bool passed = check_parallel_subtree(engine.get_root(), first_nodes) && first_nodes > 1;
+
+    int second_nodes = 0;
+    engine.run();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    engine.kill();
+    passed = check_parallel_subtree(engine.get_root(), second_nodes) && second_nodes > first_nodes && passed;
+
+    const Move best = engine.get_best_move();
+    const bool legal = is_legal_move(engine.get_root()->gs->board, best);
+
+    engine.kill();
+    passed = engine.has_finished() && passed;
+
+    {
+        Engine abandoned = EngineBuilder::for_position(*fen).build();
+        abandoned.run();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+
+    engine.cleanup();
+    return passed && legal;
+}
+
+bool test_cancellation() {
+    return evaluate_test_set(&cancellation_test_set, &evaluate_cancellation_test_case);
+}
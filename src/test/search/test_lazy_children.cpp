@@ -0,0 +1,81 @@
+#include <cstdlib>
+
+#include "../test.h"
+#include "test_search_helpers.h"
+#include "search.h"
+
+const TestSet<std::string> lazy_children_test_set{
+    "search-lazy-children",
+    {
+        "8/8/4k3/8/8/3K4/4P3/8 w - - 0 1",
+        "6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1",
+        "8/5pk1/6p1/8/8/6P1/5PK1/8 w - - 0 1",
+        "4k3/8/8/8/8/8/4P3/4K3 w - - 0 1",
+        "8/8/4k3/8/8/3K4/4P3/8 b - - 0 1",
+        "4k3/4p3/8/8/8/8/8/4K3 b - - 0 1",
+    }
+};
+
+// how far (in millipawns) a lazy edge's static estimate may be from heur of the position it leads to,
+// and a root's backed-up score from level, short of mate
+const int ESTIMATE_TOLERANCE = 5000;
+const int ROOT_SCORE_BOUND = 20000;
+
+/**
+ * Checks every node below the given one: lazy nodes must be bare edges hanging off a built
+ * parent, scored on the same scale as heur, and built nodes must hold the position their move
+ * leads to. Counts the lazy edges.
+ */
+bool check_lazy_subtree(const SearchNode * node, int & lazy_edges) {
+
+    for (const SearchNode * child : node->children) {
+        if (child->is_lazy()) {
+            if (child->parent != node || child->cand_set || !child->children.empty() || child->visit_count != 0) {
+                return false;
+            }
+            const Gamestate reached(*node->gs, child->move);
+            if (std::abs(child->score - heur(reached)) > ESTIMATE_TOLERANCE) {
+                std::cout << "lazy estimate " << child->score << " vs heur " << heur(reached) << "\n";
+                return false;
+            }
+            ++lazy_edges;
+            continue;
+        }
+        const Board expected = node->gs->board.successor_hard(edge_move(node, child));
+        if (child->gs->board.get_key() != expected.get_key() || child->board_hash != expected.get_key()) {
+            return false;
+        }
+        // a node shared by transposition is checked once, under the parent it was created under
+        if (child->parent == node && !check_lazy_subtree(child, lazy_edges)) { return false; }
+    }
+    return true;
+}
+
+/**
+ * Searches with lazy children and checks the shape of the resulting tree, which must have some
+ * lazy edges left in it for the test to mean anything, and that the score backed up to the root
+ * is a reasonable one.
+ */
+bool evaluate_lazy_children_test_case(const std::string * fen) {
+
+    Engine engine =
+        EngineBuilder::for_position(*fen)
+            .with_node_limit(25000)
+            .with_timeout(5)
+            .with_lazy_children(true)
+            .build();
+    engine.blocking_run();
+
+    int lazy_edges = 0;
+    const Eval root_score = engine.get_root()->score;
+    const bool passed =
+        check_lazy_subtree(engine.get_root(), lazy_edges)
+        && lazy_edges > 0
+        && (is_mate(root_score) || std::abs(root_score - zero()) <= ROOT_SCORE_BOUND);
+    engine.cleanup();
+    return passed;
+}
+
+bool test_lazy_children() {
+    return evaluate_test_set(&lazy_children_test_set, &evaluate_lazy_children_test_case);
+}
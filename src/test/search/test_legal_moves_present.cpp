@@ -20,7 +20,7 @@ public:
                 for (const Move expected_legal: expected_legals) {
                     bool present = false;
                     for (const SearchNode *j: node->children) {
-                        if (equal_exactly(expected_legal, j->move)) {
+                        if (equal_exactly(expected_legal, edge_move(node, j))) {
                             present = true;
                             break;
                         }
@@ -0,0 +1,53 @@
+#include "../test.h"
+#include "test_search_helpers.h"
+#include "search.h"
+#include "../../search/search_tools.h"
+
+const TestSet<std::string> parallel_search_test_set{"search-parallel", search_test_positions()};
+
+/**
+ * Checks every node below the given one once the threads have finished: each child must hold the
+ * position its edge move leads to, and no node may be left locked or with a thread counted on it.
+ * Counts the built nodes.
+ */
+bool check_parallel_subtree(SearchNode * node, int & nodes) {
+
+    if (!try_lock(node) || node->in_flight != 0) { return false; }
+    unlock(node);
+    if (node->is_lazy()) { return true; }
+    ++nodes;
+
+    for (SearchNode * child : node->children) {
+        if (!child->is_lazy()) {
+            const Board expected = node->gs->board.successor_hard(edge_move(node, child));
+            if (!child->gs->board.equivalent(expected)) { return false; }
+        }
+        if (child->parent == node && !check_parallel_subtree(child, nodes)) { return false; }
+    }
+    return true;
+}
+
+/**
+ * Searches with four threads, which must between them build a consistent tree and find a legal move.
+ */
+bool evaluate_parallel_search_test_case(const std::string * fen) {
+
+    Engine engine =
+        EngineBuilder::for_position(*fen)
+            .with_cycle_limit(40)
+            .with_threads(4)
+            .build();
+    const Move best = engine.blocking_run();
+
+    int nodes = 0;
+    bool passed = check_parallel_subtree(engine.get_root(), nodes) && nodes > 1;
+
+    const bool legal = is_legal_move(engine.get_root()->gs->board, best);
+
+    engine.cleanup();
+    return passed && legal;
+}
+
+bool test_parallel_search() {
+    return evaluate_test_set(&parallel_search_test_set, &evaluate_parallel_search_test_case);
+}
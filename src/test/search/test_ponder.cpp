@@ -0,0 +1,54 @@
+#include "../test.h"
+#include "test_search_helpers.h"
+#include "../../search/engine_client.h"
+
+const TestSet<std::string> ponder_test_set{
+    "search-ponder",
+    {
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "r1bqkb1r/pppp1ppp/2n2n2/4p3/4P3/2N2N2/PPPP1PPP/R1BQKB1R w KQkq - 4 4",
+        "rnbqkb1r/pp2pppp/3p1n2/8/3NP3/2N5/PPP2PPP/R1BQKB1R b KQkq - 2 5",
+    }
+};
+
+/**
+ * Plays a move with pondering on, then replies to it with the expected reply (a ponder hit) in one game and
+ * with some other move (a miss) in another. Either way the next move must be legal in the position reached,
+ * and turning pondering off must stop it.
+ */
+bool evaluate_ponder_test_case(const std::string * fen) {
+
+    bool passed = true;
+
+    for (const bool hit : {true, false}) {
+        EngineClient client(*fen);
+        client.set_ponder(true);
+        Board board = board_utils::fen_to_board(*fen);
+
+        const Move ours = legal_move_for_uci(board, client.get_computer_move(0.1));
+        if (is_sentinel(ours)) { return false; }
+        board = board.successor_hard(ours);
+
+        const Move expected = legal_move_for_uci(board, move2uci(client.get_ponder_move()));
+        if (is_sentinel(expected)) { return false; }
+
+        Move reply = expected;
+        if (!hit) {
+            for (const Move m : game_rules::legal_moves(board)) {
+                if (move2uci(m) != move2uci(expected)) { reply = m; }
+            }
+        }
+        board = board.successor_hard(reply);
+        client.register_opponent_move(move2uci(reply));
+        passed = is_sentinel(client.get_ponder_move()) && passed;
+
+        const Move next = legal_move_for_uci(board, client.get_computer_move(0.1));
+        client.set_ponder(false);
+        passed = !is_sentinel(next) && is_sentinel(client.get_ponder_move()) && passed;
+    }
+    return passed;
+}
+
+bool test_ponder() {
+    return evaluate_test_set(&ponder_test_set, &evaluate_ponder_test_case);
+}
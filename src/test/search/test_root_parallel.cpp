@@ -0,0 +1,73 @@
+#include "../test.h"
+#include "test_search_helpers.h"
+#include "search.h"
+
+const TestSet<std::string> root_parallel_test_set{"search-root-parallel", search_test_positions()};
+
+/**
+ * Checks the trees of a root-parallel search and their merged root moves: the merged moves must be
+ * distinct and legal, some of them must have come from the other trees, each must have the visits of
+ * every tree which searched it, and the move chosen must be one of them. Each tree must still be its
+ * own, with no children taken from another, and no two children of its root for the same move.
+ */
+bool check_merged_roots(const Engine & engine, const Move best) {
+
+    const std::vector<SearchNode *> roots = engine.get_roots();
+    const std::vector<MergedRootMove> merged = merge_roots(roots);
+
+    bool passed = true, from_others = false, chosen = false;
+    for (int i = 0; i < merged.size(); ++i) {
+        const Move m = merged[i].move;
+        for (int j = 0; j < i; ++j) {
+            passed = passed && !equal_exactly(m, merged[j].move);
+        }
+        passed = passed && is_legal_move(roots[0]->gs->board, m);
+        chosen = chosen || equal_exactly(m, best);
+
+        int visits = 0;
+        bool in_first = false;
+        for (const SearchNode * root : roots) {
+            for (const SearchNode * child : root->children) {
+                if (equal_exactly(edge_move(root, child), m)) {
+                    visits += child->visit_count;
+                    in_first = in_first || root == roots[0];
+                }
+            }
+        }
+        passed = passed && visits == merged[i].visit_count;
+        from_others = from_others || !in_first;
+    }
+
+    for (const SearchNode * root : roots) {
+        for (int i = 0; i < root->children.size(); ++i) {
+            passed = passed && root->children[i]->parent == root;
+            for (int j = 0; j < i; ++j) {
+                passed = passed && !equal_exactly(
+                    edge_move(root, root->children[i]), edge_move(root, root->children[j]));
+            }
+        }
+    }
+    return passed && from_others && chosen;
+}
+
+/**
+ * Searches three trees, twice over with the same engine, and checks the merged roots after each run.
+ */
+bool evaluate_root_parallel_test_case(const std::string * fen) {
+
+    Engine engine =
+        EngineBuilder::for_position(*fen)
+            .with_cycle_limit(15)
+            .with_root_parallel(3)
+            .build();
+
+    const bool first = check_merged_roots(engine, engine.blocking_run());
+    const bool second = check_merged_roots(engine, engine.blocking_run());
+
+    engine.cleanup();
+    return first && second;
+}
+
+bool test_root_parallel() {
+    return evaluate_test_set(&root_parallel_test_set, &evaluate_root_parallel_test_case);
+}
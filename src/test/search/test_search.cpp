@@ -15,6 +15,15 @@ bool test_search() {
     passed = test_past_crashes() && passed;
     passed = test_parent_pointer() && passed;
     passed = test_checkmate() && passed;
+    passed = test_lazy_children() && passed;
+    passed = test_transpositions() && passed;
+    passed = test_parallel_search() && passed;
+    passed = test_root_parallel() && passed;
+    passed = test_search_context() && passed;
+    passed = test_cancellation() && passed;
+    passed = test_subtree_reuse() && passed;
+    passed = test_ponder() && passed;
+    passed = test_time_manager() && passed;
 
     return passed;
 
@@ -0,0 +1,41 @@
+#include "../test.h"
+#include "test_search_helpers.h"
+#include "search.h"
+#include "../../search/search_tools.h"
+
+const TestSet<std::string> search_context_test_set{"search-context", search_test_positions()};
+
+/**
+ * Searches with two engines at once, one with a node limit and one without. The first must stop at
+ * its own limit, regardless of the nodes the other builds, and must leave the other running until it
+ * is killed.
+ */
+bool evaluate_search_context_test_case(const std::string * fen) {
+
+    Engine limited =
+        EngineBuilder::for_position(*fen)
+            .with_node_limit(3000)
+            .build();
+    Engine unlimited =
+        EngineBuilder::for_position(*fen)
+            .build();
+
+    limited.run();
+    unlimited.run();
+    limited.await();
+
+    const int nodes = limited.get_context().node_count();
+    bool passed = nodes >= 3000 && nodes < 6000 && !unlimited.has_finished();
+
+    unlimited.kill();
+    const Move best = unlimited.get_best_move();
+    const bool legal = is_legal_move(unlimited.get_root()->gs->board, best);
+
+    limited.cleanup();
+    unlimited.cleanup();
+    return passed && legal;
+}
+
+bool test_search_context() {
+    return evaluate_test_set(&search_context_test_set, &evaluate_search_context_test_case);
+}
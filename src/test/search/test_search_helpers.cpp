@@ -11,7 +11,7 @@ bool entire_line_present(SearchNode * root, std::vector<std::string> & move_strs
         SearchNode * next;
 
         for (SearchNode * child : current->children) {
-            std::string child_move_str = mtos(current->gs->board, child->move);
+            std::string child_move_str = mtos(current->gs->board, edge_move(current, child));
             if (std::strcmp(move_str.c_str(), child_move_str.c_str()) == 0) {
                 present = true;
                 next = child;
@@ -48,7 +48,6 @@ bool evaluate_search_line_test_case(const SearchLineTestCase * tc) {
             .with_game_phase(tc->phase)
             .with_node_limit(tc->nodes_allowed == 0 ? 25000 : tc->nodes_allowed)
             .with_timeout(5)
-            .with_cleanup(false)
             .build();
     engine.blocking_run();
 
@@ -61,3 +60,28 @@ bool evaluate_search_line_test_case(const SearchLineTestCase * tc) {
     engine.cleanup();
     return true;
 }
+
+/**
+ * The positions which the tests of the search machinery (threads, contexts, cancellation, reuse) are run
+ * on: the start, a symmetrical opening and a middlegame with both kings still able to castle, followed by
+ * any more given by the test.
+ */
+std::vector<std::string> search_test_positions(const std::vector<std::string> & more) {
+    std::vector<std::string> positions{
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "r1bqkb1r/pppp1ppp/2n2n2/4p3/4P3/2N2N2/PPPP1PPP/R1BQKB1R w KQkq - 4 4",
+        "r3k2r/1bpq1p1p/1pnp2pb/p3p1N1/2B1P3/2NP3P/PPP2PP1/R2Q1RK1 b kq - 1 11",
+    };
+    positions.insert(positions.end(), more.begin(), more.end());
+    return positions;
+}
+
+/**
+ * Whether the given move (including its promotion piece) is one of the legal moves on the given board.
+ */
+bool is_legal_move(const Board & board, const Move move) {
+    for (const Move m : game_rules::legal_moves(board)) {
+        if (equal_exactly(m, move)) { return true; }
+    }
+    return false;
+}
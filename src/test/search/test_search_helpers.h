@@ -23,6 +23,9 @@ struct SearchLineTestCase {
 };
 
 bool evaluate_search_line_test_case(const SearchLineTestCase *);
+bool check_parallel_subtree(SearchNode *, int & nodes);
+bool is_legal_move(const Board &, Move);
+std::vector<std::string> search_test_positions(const std::vector<std::string> & more = {});
 
 class TestObserver : public Observer {
 
@@ -0,0 +1,82 @@
+#include "../test.h"
+#include "test_search_helpers.h"
+#include "search.h"
+#include "../../search/search_tools.h"
+
+const TestSet<std::string> subtree_reuse_test_set{"search-subtree-reuse", search_test_positions()};
+
+/**
+ * Searches a position, then moves the engine on to its most visited grandchild. The grandchild's
+ * subtree must be kept, with its score and visit count, as a consistent tree which can be searched further,
+ * and the last search forgotten, so that stopping it straight after is harmless. Moving on by a move never
+ * searched must start again from the right position.
+ */
+bool evaluate_subtree_reuse_test_case(const std::string * fen) {
+
+    Engine engine =
+        EngineBuilder::for_position(*fen)
+            .with_cycle_limit(30)
+            .with_node_limit(5000)
+            .build();
+    engine.blocking_run();
+
+    // the most visited grandchild, which has the most to carry over
+    const SearchNode * grandchild = nullptr;
+    std::vector<Move> moves;
+    for (const SearchNode * child : engine.get_root()->children) {
+        for (const SearchNode * g : child->children) {
+            if (!g->is_lazy() && (!grandchild || g->visit_count > grandchild->visit_count)) {
+                grandchild = g;
+                moves = {edge_move(engine.get_root(), child), edge_move(child, g)};
+            }
+        }
+    }
+    if (!grandchild) { return false; }
+    const Eval score = grandchild->score;
+    const unsigned short visits = grandchild->visit_count;
+    const Board expected = grandchild->gs->board;
+
+    const bool kept = engine.advance(moves);
+    SearchNode * root = engine.get_root();
+
+    // the last search went with the old tree, so there is nothing left to stop
+    engine.stop();
+    engine.limit_time(budget_for_move_time(0));
+
+    int nodes = 0;
+    bool passed = kept
+        && engine.has_finished()
+        && engine.live_node_count() == 0
+        && root->parent == nullptr
+        && root->score == score
+        && root->visit_count == visits
+        && root->gs->board.equivalent(expected)
+        && check_parallel_subtree(root, nodes);
+
+    engine.blocking_run();
+    passed = engine.get_root()->visit_count > visits && passed;
+
+    // a move never searched leaves nothing to keep
+    Move unsearched = MOVE_SENTINEL;
+    for (const Move m : game_rules::legal_moves(engine.get_root()->gs->board)) {
+        bool searched = false;
+        for (const SearchNode * child : engine.get_root()->children) {
+            searched = searched || equal_exactly(edge_move(engine.get_root(), child), m);
+        }
+        if (!searched) { unsearched = m; }
+    }
+    if (!is_sentinel(unsearched)) {
+        const Board after = engine.get_root()->gs->board.successor_hard(unsearched);
+        passed = !engine.advance({unsearched})
+            && engine.get_root()->gs->board.equivalent(after)
+            && engine.get_root()->children.empty()
+            && passed;
+    }
+
+    engine.cleanup();
+    return passed;
+}
+
+bool test_subtree_reuse() {
+    return evaluate_test_set(&subtree_reuse_test_set, &evaluate_subtree_reuse_test_case);
+}
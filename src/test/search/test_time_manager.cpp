@@ -0,0 +1,79 @@
+#include <algorithm>
+
+#include "../test.h"
+#include "test_search_helpers.h"
+#include "../../search/time_manager.h"
+
+struct ClockTestCase {
+    const double remaining_seconds;
+    const double increment_seconds;
+    const int moves_to_go;
+};
+
+const TestSet<ClockTestCase> time_manager_test_set{
+    "search-time-manager",
+    {
+        ClockTestCase{0.3, 0, 0},
+        ClockTestCase{1.0, 0.05, 0},
+        ClockTestCase{0.2, 0, 1},
+        ClockTestCase{2.0, 0.1, 40},
+        // less left than the overhead held back, but a move must still be found
+        ClockTestCase{0.01, 0, 0},
+        ClockTestCase{0, 0, 0},
+    }
+};
+
+/**
+ * How late a search may stop after its hard deadline, in seconds. This is measured by the search's own
+ * clock, which starts when its deadlines are set, so building the engine does not count towards it.
+ */
+const double STOP_TOLERANCE = 0.02;
+
+/**
+ * The budget for a clock must leave a margin of it (or be MIN_MOVE_TIME, if it cannot), even on the last move
+ * before a time control, with the soft limit no later than the hard one, and a search on that clock must find a move and stop by the hard limit (to within
+ * STOP_TOLERANCE). So must a search with a fixed time per move of the same soft limit, which must also use
+ * all of it, and even a search with no time must give a move.
+ */
+bool evaluate_time_manager_test_case(const ClockTestCase * clock) {
+
+    const TimeBudget budget = budget_for_clock(clock->remaining_seconds, clock->increment_seconds, clock->moves_to_go);
+    bool passed = budget.soft_seconds > 0
+        && budget.soft_seconds <= budget.hard_seconds
+        && budget.soft_seconds <= std::max(
+            clock->remaining_seconds * __engine_params::HARD_LIMIT_SHARE, __engine_params::MIN_MOVE_TIME)
+        && budget.hard_seconds <= std::max(
+            clock->remaining_seconds * __engine_params::LAST_MOVE_HARD_SHARE, __engine_params::MIN_MOVE_TIME);
+
+    const std::string fen = "r1bqkb1r/pppp1ppp/2n2n2/4p3/4P3/2N2N2/PPPP1PPP/R1BQKB1R w KQkq - 4 4";
+
+    Engine on_clock =
+        EngineBuilder::for_position(fen)
+            .with_clock(clock->remaining_seconds, clock->increment_seconds, clock->moves_to_go)
+            .build();
+    passed = !is_sentinel(on_clock.blocking_run()) && passed;
+    passed = on_clock.get_actual_seconds() <= budget.hard_seconds + STOP_TOLERANCE && passed;
+
+    Engine fixed =
+        EngineBuilder::for_position(fen)
+            .with_timeout(budget.soft_seconds)
+            .build();
+    passed = !is_sentinel(fixed.blocking_run()) && passed;
+    const double took = fixed.get_actual_seconds();
+    passed = took >= budget.soft_seconds
+        && took <= budget.soft_seconds + STOP_TOLERANCE
+        && passed;
+
+    // a search with no time at all stops before it expands the root, so falls back to a legal move
+    Engine instant =
+        EngineBuilder::for_position(fen)
+            .with_timeout(0)
+            .build();
+    passed = !is_sentinel(instant.blocking_run()) && passed;
+
+    return passed;
+}
+
+bool test_time_manager() {
+    return evaluate_test_set(&time_manager_test_set, &evaluate_time_manager_test_case);
+}
@@ -0,0 +1,72 @@
+#include "../test.h"
+#include "test_search_helpers.h"
+#include "search.h"
+#include "../../search/search_tools.h"
+
+const TestSet<std::string> transpositions_test_set{
+    "search-transpositions",
+    {
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "r1bqkb1r/pppp1ppp/2n2n2/4p3/4P3/2N2N2/PPPP1PPP/R1BQKB1R w KQkq - 4 4",
+        "r1bqk2r/pppp1ppp/2n2n2/2b1p3/2B1P3/3P1N2/PPP2PPP/RNBQK2R w KQkq - 1 5",
+    }
+};
+
+/**
+ * Checks every node below the given one: each child must hold the position its edge move leads
+ * to, each of a node's other parents must have it among their children, and each score must
+ * already agree with the node's children, however many parents they have. A node with more than
+ * one parent must have been reached by an irreversible move, so that repetitions below it do not
+ * depend on the path. Counts the nodes with more than one parent.
+ */
+bool check_dag(SearchNode * node, int & shared) {
+
+    for (SearchNode * child : node->children) {
+        if (child->is_lazy()) { continue; }
+
+        const Board expected = node->gs->board.successor_hard(edge_move(node, child));
+        if (!child->gs->board.equivalent(expected)) { return false; }
+
+        if (child->parent != node) { continue; }
+
+        for (const ParentLink * link = child->other_parents; link; link = link->next) {
+            bool found = false;
+            for (const SearchNode * c : link->parent->children) {
+                if (c == child) { found = true; }
+            }
+            if (!found || link->parent == node) { return false; }
+        }
+        if (child->other_parents) {
+            if (child->gs->board.get_halfmoves() != 0) { return false; }
+            ++shared;
+        }
+
+        if (!check_dag(child, shared)) { return false; }
+    }
+
+    const Eval score = node->score;
+    update_score(node);
+    return node->score == score;
+}
+
+/**
+ * Searches with the transposition table and checks the shape of the resulting graph, which must
+ * have some nodes shared in it for the test to mean anything.
+ */
+bool evaluate_transpositions_test_case(const std::string * fen) {
+
+    Engine engine =
+        EngineBuilder::for_position(*fen)
+            .with_cycle_limit(40)
+            .build();
+    engine.blocking_run();
+
+    int shared = 0;
+    const bool passed = check_dag(engine.get_root(), shared) && shared > 0;
+    engine.cleanup();
+    return passed;
+}
+
+bool test_transpositions() {
+    return evaluate_test_set(&transpositions_test_set, &evaluate_transpositions_test_case);
+}
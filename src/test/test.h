@@ -122,16 +122,28 @@ bool integration_test_main();
 bool test_pieces();
 bool test_set_get_square();
 bool test_read_write_fens();
+bool test_fen_round_trip();
 bool test_in_check();
 bool test_castling();
 bool test_mutate_hard();
 bool test_mutate();
 bool test_move_scores();
+bool test_move_packing();
 bool test_game_status();
+bool test_game_record();
+bool test_bitboards();
+bool test_attacks();
+bool test_zobrist();
+bool test_legal_moves();
+bool test_make_unmake();
+bool test_move_gen();
+bool test_san();
 
 // top level game tests
 bool test_pin_cache();
 bool test_cands_sorting();
+bool test_gs_make_unmake();
+bool test_gs_copy_move();
 
 // cands
 bool test_unsafe_piece_hook();
@@ -174,6 +186,15 @@ bool test_past_blunders();
 bool test_past_crashes();
 bool test_parent_pointer();
 bool test_checkmate();
+bool test_lazy_children();
+bool test_transpositions();
+bool test_parallel_search();
+bool test_root_parallel();
+bool test_search_context();
+bool test_cancellation();
+bool test_subtree_reuse();
+bool test_ponder();
+bool test_time_manager();
 
 bool stress_test_main();
 
@@ -19,7 +19,7 @@ bool evaluate_responder_test_case(const Responder * resp, const ResponderTestCas
     // convert the output to a vector of strings
     std::vector<std::string> strings;
     for (int i = 0; i < m; ++i) {
-        strings.push_back(sqtos(moves[i].from) + sqtos(moves[i].to));
+        strings.push_back(sqtos(moves[i].from()) + sqtos(moves[i].to()));
     }
 
     // check that they match
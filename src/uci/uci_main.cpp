@@ -0,0 +1,9 @@
+#include <iostream>
+
+#include "uci_session.h"
+
+int main() {
+    UciSession session(std::cin, std::cout);
+    session.run();
+    return 0;
+}
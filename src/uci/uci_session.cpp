@@ -0,0 +1,366 @@
+#include <algorithm>
+#include <cstdlib>
+
+#include "uci_session.h"
+#include "../search/engine.h"
+#include "../search/search_tools.h"
+#include "../utils/utils.h"
+#include "../game/gamestate.hpp"
+
+/**
+ * An evaluation as a UCI score, from the point of view of the side to move: in centipawns, or as mate
+ * in a number of moves (negative if the side to move is getting mated).
+ */
+std::string uci_score(const Eval e, const bool white_to_move) {
+    if (is_mate(e)) {
+        const bool white_mates = black_is_mated(e);
+        const int moves = white_mates ? WHITE_GIVES_MATE - e : e - BLACK_GIVES_MATE;
+        return "mate " + std::to_string(white_mates == white_to_move ? moves : -moves);
+    }
+    const int cp = (e - zero()) / 10;
+    return "cp " + std::to_string(white_to_move ? cp : -cp);
+}
+
+UciSession::UciSession(std::istream & in, std::ostream & out) :
+        in(in),
+        out(out),
+        threads(1),
+        start_fen(starting_fen()),
+        searching(false),
+        reporter(0),
+        pondering(false),
+        infinite(false),
+        ponder_budget(budget_for_move_time(-1))
+{
+    game_history.emplace_back(start_fen);
+}
+
+UciSession::~UciSession() {
+    stop();
+}
+
+/**
+ * Handles commands until quit, or the end of the input, then stops any search still running.
+ */
+void UciSession::run() {
+    std::string command;
+    while (std::getline(in, command)) {
+        if (!handle(command)) { break; }
+    }
+    stop();
+}
+
+/**
+ * Handles one command. Commands which are not recognised are ignored, as the protocol asks.
+ * Returns false if the session should end.
+ */
+bool UciSession::handle(const std::string & command) {
+
+    std::istringstream args(command);
+    std::string token;
+    args >> token;
+
+    if (token == "uci") {
+        identify();
+    } else if (token == "isready") {
+        send("readyok");
+    } else if (token == "ucinewgame") {
+        new_game();
+    } else if (token == "setoption") {
+        set_option(args);
+    } else if (token == "position") {
+        set_position(args);
+    } else if (token == "go") {
+        go(args);
+    } else if (token == "stop") {
+        stop();
+    } else if (token == "ponderhit") {
+        ponder_hit();
+    } else if (token == "quit") {
+        stop();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Sends a line of output. Both the session and its reporter send, so the lines are kept whole.
+ */
+void UciSession::send(const std::string & line) {
+    std::lock_guard<std::mutex> guard(out_mutex);
+    out << line << std::endl;
+}
+
+void UciSession::identify() {
+    send("id name STaSe");
+    send("id author the STaSe developers");
+    send("option name Threads type spin default 1 min 1 max 64");
+    send("option name Ponder type check default false");
+    send("uciok");
+}
+
+/**
+ * Sets an option, given as "name <name> value <value>". Changing the threads starts a new engine at the
+ * next search. Ponder only tells the engine that it may be asked to ponder, so needs nothing.
+ */
+void UciSession::set_option(std::istringstream & args) {
+
+    std::string word, name, value;
+    bool in_value = false;
+    args >> word;  // "name"
+    while (args >> word) {
+        if (!in_value && word == "value") {
+            in_value = true;
+        } else {
+            std::string & part = in_value ? value : name;
+            part += (part.empty() ? "" : " ") + word;
+        }
+    }
+
+    if (name == "Threads") {
+        stop();
+        threads = std::clamp(std::atoi(value.c_str()), 1, 64);
+        engine.reset();
+    }
+}
+
+void UciSession::new_game() {
+    stop();
+    engine.reset();
+}
+
+/**
+ * Sets the position, given as "startpos" or "fen <fen>", then optionally "moves" and the moves played
+ * from it. The engine keeps its tree if the position follows on from the last one by further moves, and
+ * moves it on by those; otherwise a new engine is made at the next search. A move which is not legal
+ * ends the list.
+ */
+void UciSession::set_position(std::istringstream & args) {
+
+    stop();
+
+    std::string token, fen;
+    args >> token;
+    if (token == "startpos") {
+        fen = starting_fen();
+        args >> token;
+    } else if (token == "fen") {
+        while (args >> token && token != "moves") {
+            fen += (fen.empty() ? "" : " ") + token;
+        }
+    } else {
+        return;
+    }
+
+    std::vector<Move> played;
+    std::vector<Gamestate> history;
+    history.emplace_back(fen);
+    if (token == "moves") {
+        std::string uci;
+        while (args >> uci) {
+            const Move m = legal_move_for_uci(history.back().board, uci);
+            if (is_sentinel(m)) { break; }
+            played.push_back(m);
+            Gamestate next(history.back(), m);
+            history.push_back(next);
+        }
+    }
+
+    const bool follows_on = engine
+        && fen == start_fen
+        && played.size() >= moves.size()
+        && std::equal(moves.begin(), moves.end(), played.begin(), &equal_exactly);
+    const std::vector<Move> further(played.begin() + (follows_on ? moves.size() : 0), played.end());
+
+    // the engine reads the history it was given, so it is updated in place
+    start_fen = fen;
+    moves = played;
+    game_history = history;
+
+    if (!follows_on) {
+        engine.reset();
+    } else if (!further.empty()) {
+        engine->advance(further);
+    }
+}
+
+/**
+ * The engine for the current position, made if there is none.
+ */
+Engine & UciSession::engine_for_position() {
+    if (!engine) {
+        engine =
+            EngineBuilder::for_position(board_utils::board_to_fen(game_history.back().board))
+                .with_game_history(&game_history)
+                .with_threads(threads)
+                .build_unique();
+    }
+    return *engine;
+}
+
+/**
+ * Starts a search of the current position. The time is budgeted from movetime if given, or else from
+ * the side to move's clock (see time_manager.h); with neither, or with infinite, the search runs until
+ * stopped. A ponder search runs until ponderhit, which gives it the budget from then on, or stop.
+ */
+void UciSession::go(std::istringstream & args) {
+
+    stop();
+
+    double wtime = -1, btime = -1, winc = 0, binc = 0, movetime = -1;
+    int movestogo = 0, nodes = -1;
+    bool go_infinite = false, go_ponder = false;
+
+    std::string token;
+    while (args >> token) {
+        if (token == "wtime") { args >> wtime; }
+        else if (token == "btime") { args >> btime; }
+        else if (token == "winc") { args >> winc; }
+        else if (token == "binc") { args >> binc; }
+        else if (token == "movestogo") { args >> movestogo; }
+        else if (token == "movetime") { args >> movetime; }
+        else if (token == "nodes") { args >> nodes; }
+        else if (token == "infinite") { go_infinite = true; }
+        else if (token == "ponder") { go_ponder = true; }
+    }
+
+    const bool white = game_history.back().board.get_white();
+    const double remaining = white ? wtime : btime;
+    const double increment = white ? winc : binc;
+
+    TimeBudget budget = budget_for_move_time(-1);
+    if (movetime >= 0) {
+        budget = budget_for_move_time(movetime / 1000);
+    } else if (remaining >= 0) {
+        budget = budget_for_clock(remaining / 1000, increment / 1000, movestogo);
+    }
+    if (go_infinite) {
+        budget = budget_for_move_time(-1);
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(ponder_mutex);
+        pondering = go_ponder;
+        infinite = go_infinite;
+        ponder_budget = budget;
+    }
+
+    Engine & e = engine_for_position();
+    e.set_node_limit(nodes);
+    e.set_time_budget(go_ponder ? budget_for_move_time(-1) : budget);
+    e.run();
+
+    searching = true;
+    pthread_create(&reporter, nullptr, &UciSession::report, this);
+}
+
+/**
+ * The opponent has played the move pondered on, so the search carries on as an ordinary one, within
+ * the budget it was given by go.
+ */
+void UciSession::ponder_hit() {
+    if (!searching) { return; }
+    std::lock_guard<std::mutex> guard(ponder_mutex);
+    if (!pondering) { return; }
+    engine->limit_time(ponder_budget);
+    pondering = false;
+    ponder_cv.notify_all();
+}
+
+/**
+ * Stops the search, if there is one, and waits for its best move to be sent.
+ */
+void UciSession::stop() {
+    if (!searching) { return; }
+    {
+        std::lock_guard<std::mutex> guard(ponder_mutex);
+        pondering = false;
+        infinite = false;
+    }
+    ponder_cv.notify_all();
+    engine->stop();
+    pthread_join(reporter, nullptr);
+    searching = false;
+}
+
+/**
+ * A line of info on the search, from the live tree: the principal variation (the trust line, as far
+ * as it has been built) and its length as the depth, the root's score, and the nodes and time so far.
+ * Each node is locked only while its best child is read, so the search carries on meanwhile.
+ */
+std::string UciSession::info() const {
+
+    SearchNode * root = engine->get_root();
+    const double secs = engine->get_context().elapsed_seconds();
+    const int nodes = engine->live_node_count();
+
+    lock(root);
+    const Eval score = root->score;
+    unlock(root);
+
+    std::vector<Move> pv;
+    SearchNode * node = root;
+    while (pv.size() < __engine_params::MAX_PV_LENGTH && !node->is_lazy()) {
+        lock(node);
+        SearchNode * next = node->best_trust_child;
+        const Move m = next ? edge_move(node, next) : MOVE_SENTINEL;
+        unlock(node);
+        if (!next) { break; }
+        pv.push_back(m);
+        node = next;
+    }
+
+    std::ostringstream line;
+    line << "info depth " << pv.size()
+         << " nodes " << nodes
+         << " nps " << (secs > 0 ? (long) (nodes / secs) : 0)
+         << " time " << (long) (secs * 1000)
+         << " score " << uci_score(score, root->gs->board.get_white());
+    if (!pv.empty()) {
+        line << " pv";
+        for (const Move m : pv) {
+            line << " " << move2uci(m);
+        }
+    }
+    return line.str();
+}
+
+/**
+ * The best move found, and the reply expected to it (the next move of the trust line) to ponder on, if
+ * there is one. Only called once the search has stopped.
+ */
+std::string UciSession::best_move() {
+
+    const Move best = engine->get_best_move();
+    if (is_sentinel(best)) { return "bestmove 0000"; }
+
+    std::string line = "bestmove " + move2uci(best);
+    const std::vector<SearchNode *> trust_line = retrieve_trust_line(engine->get_root());
+    if (trust_line.size() >= 3 && equal_exactly(edge_move(trust_line[0], trust_line[1]), best)) {
+        line += " ponder " + move2uci(edge_move(trust_line[1], trust_line[2]));
+    }
+    return line;
+}
+
+/**
+ * Reports on a search: sends info every INFO_INTERVAL until it stops, and once more then, and finally the best
+ * move. While pondering, or searching infinitely, the best move waits for ponderhit or stop.
+ */
+void * UciSession::report(void * args) {
+
+    UciSession * session = (UciSession *) args;
+    Engine & engine = *session->engine;
+
+    while (!engine.wait_for(__engine_params::INFO_INTERVAL)) {
+        session->send(session->info());
+    }
+    engine.await();
+    session->send(session->info());
+
+    {
+        std::unique_lock<std::mutex> guard(session->ponder_mutex);
+        session->ponder_cv.wait(guard, [session] { return !session->pondering && !session->infinite; });
+    }
+    session->send(session->best_move());
+    return nullptr;
+}
@@ -0,0 +1,87 @@
+#ifndef STASE_UCI_SESSION_H
+#define STASE_UCI_SESSION_H
+
+#include <condition_variable>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <pthread.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../../include/stase/game.h"
+#include "../search/time_manager.h"
+
+class Engine;
+
+namespace __engine_params {
+
+    /**
+     * While searching under UCI, a line of info about the search is sent every INFO_INTERVAL seconds, and once
+     * more when it ends. Each gives at most MAX_PV_LENGTH moves of the principal variation.
+     */
+    const double INFO_INTERVAL = 0.5;
+    const int MAX_PV_LENGTH = 32;
+}
+
+/**
+ * A session of the Universal Chess Interface: reads commands from the given input, one per line, and writes
+ * the responses to the given output, until it reads quit or the input ends. It speaks enough of the protocol
+ * to play under a tournament manager: uci, isready, ucinewgame, setoption (Threads and Ponder), position,
+ * go (with wtime, btime, winc, binc, movestogo, movetime, nodes, infinite and ponder), stop and ponderhit.
+ *
+ * A search runs in the background while further commands are read. Another thread reports on it: it sends
+ * info from the live tree as it goes, and the best move once it stops. The engine and its tree are kept from
+ * one search to the next, for as long as each position follows on from the last by moves played.
+ */
+class UciSession {
+
+    std::istream & in;
+    std::ostream & out;
+    std::mutex out_mutex;
+
+    int threads;
+
+    std::string start_fen;
+    std::vector<Move> moves;
+    std::vector<Gamestate> game_history;
+    std::unique_ptr<Engine> engine;
+
+    bool searching;
+    pthread_t reporter;
+
+    // while pondering, the best move must wait for ponderhit (or stop), which then gives the search this budget;
+    // an infinite search must likewise wait for stop
+    std::mutex ponder_mutex;
+    std::condition_variable ponder_cv;
+    bool pondering;
+    bool infinite;
+    TimeBudget ponder_budget;
+
+public:
+    UciSession(std::istream & in, std::ostream & out);
+    ~UciSession();
+
+    void run();
+    bool handle(const std::string & command);
+
+private:
+    void send(const std::string & line);
+
+    void identify();
+    void set_option(std::istringstream & args);
+    void new_game();
+    void set_position(std::istringstream & args);
+    void go(std::istringstream & args);
+    void ponder_hit();
+    void stop();
+
+    Engine & engine_for_position();
+    std::string info() const;
+    std::string best_move();
+
+    static void * report(void * session);
+};
+
+#endif //STASE_UCI_SESSION_H
@@ -21,6 +21,17 @@ Move uci2move(const std::string & s) {
     return m;
 }
 
+/**
+ * The legal move in the given position with the given UCI (eg e1g1), or MOVE_SENTINEL if there is none.
+ * Unlike uci2move, the move has its capture and castling flags set, so it can be played.
+ */
+Move legal_move_for_uci(const Board & b, const std::string & s) {
+    for (const Move m : game_rules::legal_moves(b)) {
+        if (move2uci(m) == s) { return m; }
+    }
+    return MOVE_SENTINEL;
+}
+
 /**
  * Converts a move to UCI format (eg e2e4) including a promotion char if needed (eg f2f1n).
  */
@@ -32,5 +43,5 @@ std::string move2uci(const Move m) {
         prom = ptoc(m.get_prom_piece(BLACK));
     }
 
-    return sqtos(m.from) + sqtos(m.to) + prom;
+    return sqtos(m.from()) + sqtos(m.to()) + prom;
 }
@@ -48,6 +48,7 @@ constexpr int signum(const T a, const T b) {
 
 Move uci2move(const std::string &);
 std::string move2uci(const Move);
+Move legal_move_for_uci(const Board &, const std::string &);
 
 void print_stack_trace_and_abort(int sig);
 